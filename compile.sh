@@ -23,7 +23,10 @@ $CC $CFLAGS -Wall -I ior-1/src -c src/io500-main.c || exit 1
 $CC $CFLAGS -Wall -I ior-1/src -c src/io500-functions.c || exit 1
 $CC $CFLAGS -Wall -I ior-1/src -c src/io500-utils.c || exit 1
 $CC $CFLAGS -Wall -I ior-1/src -c src/io500-options.c || exit 1
+$CC $CFLAGS -Wall -I ior-1/src -c src/io500-phases.c || exit 1
+$CC $CFLAGS -Wall -I ior-1/src -c src/io500-json.c || exit 1
+$CC $CFLAGS -Wall -I ior-1/src -c src/io500-score.c || exit 1
 $CC $CFLAGS -Wall -I ior-1/src -I libcircle/libcircle/ -c src/io500-find.c || exit 1
-$CC $CFLAGS -o io500 ior-1/*.o *.o libcircle/.libs/libcircle.a -lm  || exit 1
+$CC $CFLAGS -o io500 ior-1/*.o *.o libcircle/.libs/libcircle.a -lm -lpthread  || exit 1
 
 echo "[OK]"
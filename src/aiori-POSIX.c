@@ -506,11 +506,14 @@ static void POSIX_Close(void *fd, IOR_param_t * param)
  */
 static void POSIX_Delete(char *testFileName, IOR_param_t * param)
 {
-        char errmsg[256];
-        sprintf(errmsg, "[RANK %03d]: unlink() of file \"%s\" failed\n",
-                rank, testFileName);
-        if (unlink(testFileName) != 0)
+        char errmsg[MAXPATHLEN + 64];
+
+        if (unlink(testFileName) != 0) {
+                snprintf(errmsg, sizeof(errmsg),
+                         "[RANK %03d]: unlink() of file \"%s\" failed\n",
+                         rank, testFileName);
                 EWARN(errmsg);
+        }
 }
 
 /*
@@ -12,8 +12,21 @@
 *
 \******************************************************************************/
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE                                     /* statx */
+#endif
+
 #include "aiori.h"
 
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stddef.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
 #if defined(HAVE_SYS_STATVFS_H)
 #include <sys/statvfs.h>
 #endif
@@ -106,6 +119,365 @@ static int aiori_stat (const char *path, struct stat *buf, IOR_param_t * param)
         return stat (path, buf);
 }
 
+/**
+ * Stat with a mask of the attributes the caller is interested in.
+ *
+ * @param[in]  dirfd Directory path is relative to, AT_FDCWD for the cwd
+ * @param[in]  path  Path to run stat on
+ * @param[in]  mask  IOR_STATX_* attributes and flags
+ * @param[out] buf   Only the requested attributes are valid
+ *
+ * Where statx is available only the requested attributes are fetched, so
+ * file systems can avoid e.g. asking the data servers for the size, and
+ * IOR_STATX_DONT_SYNC allows them to answer from cached attributes.
+ * Elsewhere it falls back on fstatat.
+ */
+int aiori_posix_statx (int dirfd, const char *path, int mask, struct stat *buf)
+{
+        int flags = (mask & IOR_STATX_NOFOLLOW) ? AT_SYMLINK_NOFOLLOW : 0;
+#if defined(STATX_TYPE)
+        unsigned int want = 0;
+        struct statx stx;
+
+        if (mask & IOR_STATX_TYPE)
+                want |= STATX_TYPE;
+        if (mask & IOR_STATX_MODE)
+                want |= STATX_TYPE | STATX_MODE;
+        if (mask & IOR_STATX_SIZE)
+                want |= STATX_SIZE;
+        if (mask & IOR_STATX_MTIME)
+                want |= STATX_MTIME;
+        if (mask & IOR_STATX_CTIME)
+                want |= STATX_CTIME;
+        if ((mask & IOR_STATX_ALL) == IOR_STATX_ALL)
+                want = STATX_BASIC_STATS;
+        if (mask & IOR_STATX_DONT_SYNC)
+                flags |= AT_STATX_DONT_SYNC;
+
+        if (statx (dirfd, path, flags, want, &stx) != 0) {
+                return -1;
+        }
+
+        memset (buf, 0, sizeof (*buf));
+        buf->st_mode = stx.stx_mode;
+        buf->st_ino = stx.stx_ino;
+        buf->st_nlink = stx.stx_nlink;
+        buf->st_uid = stx.stx_uid;
+        buf->st_gid = stx.stx_gid;
+        buf->st_size = stx.stx_size;
+        buf->st_blocks = stx.stx_blocks;
+        buf->st_blksize = stx.stx_blksize;
+        buf->st_mtim.tv_sec = stx.stx_mtime.tv_sec;
+        buf->st_mtim.tv_nsec = stx.stx_mtime.tv_nsec;
+        buf->st_ctim.tv_sec = stx.stx_ctime.tv_sec;
+        buf->st_ctim.tv_nsec = stx.stx_ctime.tv_nsec;
+        buf->st_atim.tv_sec = stx.stx_atime.tv_sec;
+        buf->st_atim.tv_nsec = stx.stx_atime.tv_nsec;
+
+        return 0;
+#else
+        return fstatat (dirfd, path, buf, flags);
+#endif
+}
+
+static int aiori_statx (const char *path, int mask, struct stat *buf, IOR_param_t * param)
+{
+        return aiori_posix_statx (AT_FDCWD, path, mask, buf);
+}
+
+#define AIORI_READDIR_BUFFER_SIZE (32 * 1024)
+
+static int aiori_dot_entry (const char *name)
+{
+        return name[0] == '.' && (name[1] == '\0' ||
+                                  (name[1] == '.' && name[2] == '\0'));
+}
+
+#if defined(SYS_getdents64)
+/* the record layout returned by the getdents64 system call */
+struct aiori_linux_dirent64 {
+        uint64_t d_ino;
+        int64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[];
+};
+#endif
+
+/**
+ * Default readdir implementation.
+ *
+ * @param[in]  path     Directory to list
+ * @param[in]  bufsize  Size of the buffer handed to the kernel, 0 for default
+ * @param[in]  callback Function called for every entry
+ * @param[in]  arg      Argument passed through to the callback
+ * @param[out] bytes    Number of bytes returned by the kernel (may be NULL)
+ *
+ * On Linux the directory is read with getdents64 into a buffer of bufsize
+ * bytes, so the number of system calls per directory can be controlled.
+ * Elsewhere it falls back on readdir and bufsize is ignored.
+ */
+static int aiori_readdir (const char *path, size_t bufsize,
+                          ior_aiori_dirent_cb_t callback, void *arg,
+                          uint64_t *bytes, IOR_param_t * param)
+{
+        ior_aiori_dirent_t entry;
+        uint64_t total = 0;
+        int stop = 0;
+#if defined(SYS_getdents64)
+        char *buf;
+        long nread;
+        int fd;
+
+        if (0 == bufsize) {
+                bufsize = AIORI_READDIR_BUFFER_SIZE;
+        }
+        buf = malloc (bufsize);
+        if (NULL == buf) {
+                errno = ENOMEM;
+                return -1;
+        }
+        fd = open (path, O_RDONLY | O_DIRECTORY);
+        if (-1 == fd) {
+                free (buf);
+                return -1;
+        }
+
+        while (!stop && (nread = syscall (SYS_getdents64, fd, buf, bufsize)) > 0) {
+                total += nread;
+                for (long pos = 0; pos < nread && !stop; ) {
+                        struct aiori_linux_dirent64 *d = (struct aiori_linux_dirent64 *) (buf + pos);
+
+                        pos += d->d_reclen;
+                        if (aiori_dot_entry (d->d_name)) {
+                                continue;
+                        }
+                        entry.name = d->d_name;
+                        entry.type = d->d_type;
+                        entry.ino = d->d_ino;
+                        stop = callback (&entry, arg);
+                }
+        }
+
+        free (buf);
+        close (fd);
+        if (nread < 0) {
+                return -1;
+        }
+#else
+        struct dirent *d;
+        DIR *dir;
+
+        dir = opendir (path);
+        if (NULL == dir) {
+                return -1;
+        }
+        while (!stop && (d = readdir (dir)) != NULL) {
+                total += offsetof (struct dirent, d_name) + strlen (d->d_name) + 1;
+                if (aiori_dot_entry (d->d_name)) {
+                        continue;
+                }
+                entry.name = d->d_name;
+#if defined(_DIRENT_HAVE_D_TYPE) || defined(DT_UNKNOWN)
+                entry.type = d->d_type;
+#else
+                entry.type = 0;
+#endif
+                entry.ino = d->d_ino;
+                stop = callback (&entry, arg);
+        }
+        closedir (dir);
+#endif
+        if (NULL != bytes) {
+                *bytes = total;
+        }
+
+        return 0;
+}
+
+/* an open directory of the default implementation */
+typedef struct aiori_posix_dir {
+        int fd;
+#if defined(SYS_getdents64)
+        char *buf;
+        size_t bufsize;
+        uint64_t next;          /* position after the last buffer */
+#else
+        DIR *dir;
+#endif
+} aiori_posix_dir_t;
+
+static void *aiori_opendir (const char *path, IOR_param_t * param)
+{
+        aiori_posix_dir_t *dir = calloc (1, sizeof (*dir));
+
+        if (NULL == dir) {
+                errno = ENOMEM;
+                return NULL;
+        }
+#if defined(SYS_getdents64)
+        dir->fd = open (path, O_RDONLY | O_DIRECTORY);
+        if (-1 == dir->fd) {
+                free (dir);
+                return NULL;
+        }
+#else
+        dir->dir = opendir (path);
+        if (NULL == dir->dir) {
+                free (dir);
+                return NULL;
+        }
+        dir->fd = dirfd (dir->dir);
+#endif
+        return dir;
+}
+
+/**
+ * Default iterate implementation.
+ *
+ * @param[in]     dir      Directory opened with opendir
+ * @param[in,out] cookie   Position to start at, 0 for the beginning
+ * @param[in]     bufsize  Bytes of entries to return before handing back
+ * @param[in]     callback Function called for every entry
+ * @param[in]     position Optional, called with the continuation cookie
+ * @param[in]     arg      Argument passed through to the callbacks
+ *
+ * Returns 1 once bufsize bytes of entries have been passed to the callback
+ * and more may follow; *cookie is then the position to continue at, which
+ * is also valid for another process opening the same directory. Returns 0 at
+ * the end of the directory or when the callback stopped, -1 on error.
+ *
+ * With getdents64 the position callback runs as soon as the last buffer has
+ * been read, before its entries are passed on, so the caller can hand off
+ * the rest of the directory first. The readdir fallback only knows the
+ * position after the entries and calls it just before returning 1.
+ */
+static int aiori_iterate (void *dir_handle, uint64_t *cookie, size_t bufsize,
+                          ior_aiori_dirent_cb_t callback,
+                          ior_aiori_pos_cb_t position, void *arg,
+                          IOR_param_t * param)
+{
+        aiori_posix_dir_t *dir = (aiori_posix_dir_t *) dir_handle;
+        ior_aiori_dirent_t entry;
+
+        if (0 == bufsize) {
+                bufsize = AIORI_READDIR_BUFFER_SIZE;
+        }
+#if defined(SYS_getdents64)
+        if (dir->bufsize < bufsize) {
+                free (dir->buf);
+                dir->buf = malloc (bufsize);
+                dir->bufsize = bufsize;
+                if (NULL == dir->buf) {
+                        dir->bufsize = 0;
+                        errno = ENOMEM;
+                        return -1;
+                }
+        }
+        if (*cookie != dir->next &&
+            lseek (dir->fd, (off_t) *cookie, SEEK_SET) == -1) {
+                return -1;
+        }
+        while (1) {
+                long nread = syscall (SYS_getdents64, dir->fd, dir->buf, bufsize);
+                struct aiori_linux_dirent64 *d = NULL;
+                long pos;
+                int full;
+
+                if (nread <= 0) {
+                        return nread < 0 ? -1 : 0;
+                }
+                /* the position after this buffer is the d_off of its last record */
+                for (pos = 0; pos < nread; pos += d->d_reclen) {
+                        d = (struct aiori_linux_dirent64 *) (dir->buf + pos);
+                }
+                *cookie = dir->next = (uint64_t) d->d_off;
+                /* a short buffer does not mean the end on every file system */
+                full = nread > (long) (bufsize - sizeof (struct aiori_linux_dirent64) - NAME_MAX - 8);
+                if (full && NULL != position) {
+                        position (*cookie, arg);
+                }
+                for (pos = 0; pos < nread; ) {
+                        d = (struct aiori_linux_dirent64 *) (dir->buf + pos);
+                        pos += d->d_reclen;
+                        if (aiori_dot_entry (d->d_name)) {
+                                continue;
+                        }
+                        entry.name = d->d_name;
+                        entry.type = d->d_type;
+                        entry.ino = d->d_ino;
+                        if (callback (&entry, arg)) {
+                                return 0;
+                        }
+                }
+                if (full) {
+                        return 1;
+                }
+        }
+#else
+        struct dirent *d;
+        size_t total = 0;
+
+        if (0 != *cookie) {
+                seekdir (dir->dir, (long) *cookie);
+        }
+        while ((d = readdir (dir->dir)) != NULL) {
+                total += offsetof (struct dirent, d_name) + strlen (d->d_name) + 1;
+                if (aiori_dot_entry (d->d_name)) {
+                        continue;
+                }
+                entry.name = d->d_name;
+#if defined(_DIRENT_HAVE_D_TYPE) || defined(DT_UNKNOWN)
+                entry.type = d->d_type;
+#else
+                entry.type = 0;
+#endif
+                entry.ino = d->d_ino;
+                if (callback (&entry, arg)) {
+                        return 0;
+                }
+                if (total >= bufsize) {
+                        long pos = telldir (dir->dir);
+
+                        if (pos != -1) {
+                                *cookie = (uint64_t) pos;
+                                if (NULL != position) {
+                                        position (*cookie, arg);
+                                }
+                                return 1;
+                        }
+                }
+        }
+        return 0;
+#endif
+}
+
+static int aiori_statat (void *dir, const char *name, int mask,
+                         struct stat *buf, IOR_param_t * param)
+{
+        return aiori_posix_statx (((aiori_posix_dir_t *) dir)->fd, name, mask, buf);
+}
+
+static int aiori_unlinkat (void *dir, const char *name, int flags,
+                           IOR_param_t * param)
+{
+        return unlinkat (((aiori_posix_dir_t *) dir)->fd, name,
+                         (flags & IOR_UNLINK_DIR) ? AT_REMOVEDIR : 0);
+}
+
+static void aiori_closedir (void *dir_handle, IOR_param_t * param)
+{
+        aiori_posix_dir_t *dir = (aiori_posix_dir_t *) dir_handle;
+
+#if defined(SYS_getdents64)
+        free (dir->buf);
+        close (dir->fd);
+#else
+        closedir (dir->dir);
+#endif
+        free (dir);
+}
+
 const ior_aiori_t *aiori_select (const char *api)
 {
         for (ior_aiori_t **tmp = available_aiori ; *tmp != NULL; ++tmp) {
@@ -125,6 +497,19 @@ const ior_aiori_t *aiori_select (const char *api)
                         if (NULL == (*tmp)->stat) {
                                 (*tmp)->stat = aiori_stat;
                         }
+                        if (NULL == (*tmp)->statx) {
+                                (*tmp)->statx = aiori_statx;
+                        }
+                        if (NULL == (*tmp)->readdir) {
+                                (*tmp)->readdir = aiori_readdir;
+                        }
+                        if (NULL == (*tmp)->opendir) {
+                                (*tmp)->opendir = aiori_opendir;
+                                (*tmp)->iterate = aiori_iterate;
+                                (*tmp)->statat = aiori_statat;
+                                (*tmp)->unlinkat = aiori_unlinkat;
+                                (*tmp)->closedir = aiori_closedir;
+                        }
                         return *tmp;
                 }
         }
@@ -52,6 +52,17 @@
 #define IOR_IWOTH         0x0400  /* write permission: other */
 #define IOR_IXOTH         0x0800 /* execute permission: other */
 
+/* -- attribute masks for the statx operation -- */
+#define IOR_STATX_TYPE      0x0001  /* file type */
+#define IOR_STATX_MODE      0x0002  /* file type and permissions */
+#define IOR_STATX_SIZE      0x0004  /* size in bytes */
+#define IOR_STATX_MTIME     0x0008  /* modification time */
+#define IOR_STATX_CTIME     0x0010  /* status change time */
+#define IOR_STATX_ALL       0x00ff  /* everything stat returns */
+/* -- flags for the statx operation -- */
+#define IOR_STATX_DONT_SYNC 0x0100  /* cached attributes are good enough */
+#define IOR_STATX_NOFOLLOW  0x0200  /* do not follow a final symlink */
+
 typedef struct ior_aiori_statfs {
         uint64_t f_bsize;
         uint64_t f_blocks;
@@ -61,6 +72,24 @@ typedef struct ior_aiori_statfs {
         uint64_t f_ffree;
 } ior_aiori_statfs_t;
 
+/* a directory entry as passed to the callback of the readdir operation */
+typedef struct ior_aiori_dirent {
+        const char *name;
+        unsigned char type;     /* DT_* value, 0 (DT_UNKNOWN) if not known */
+        uint64_t ino;
+} ior_aiori_dirent_t;
+
+/* called for every entry except "." and "..", a non-zero return value stops
+ * the listing */
+typedef int (*ior_aiori_dirent_cb_t) (const ior_aiori_dirent_t *entry, void *arg);
+
+/* called by iterate with the position the listing continues at, before the
+ * entries up to that position are passed to the dirent callback */
+typedef void (*ior_aiori_pos_cb_t) (uint64_t cookie, void *arg);
+
+/* -- flags for the unlinkat operation -- */
+#define IOR_UNLINK_DIR      0x1     /* remove an empty directory */
+
 typedef struct ior_aiori {
         char *name;
         void *(*create)(char *, IOR_param_t *);
@@ -77,6 +106,23 @@ typedef struct ior_aiori {
         int (*rmdir) (const char *path, IOR_param_t * param);
         int (*access) (const char *path, int mode, IOR_param_t * param);
         int (*stat) (const char *path, struct stat *buf, IOR_param_t * param);
+        int (*statx) (const char *path, int mask, struct stat *buf,
+                      IOR_param_t * param);
+        int (*readdir) (const char *path, size_t bufsize,
+                        ior_aiori_dirent_cb_t callback, void *arg,
+                        uint64_t *bytes, IOR_param_t * param);
+        /* directory handles, names are resolved relative to the open
+         * directory and listings can be continued at a position */
+        void *(*opendir) (const char *path, IOR_param_t * param);
+        int (*iterate) (void *dir, uint64_t *cookie, size_t bufsize,
+                        ior_aiori_dirent_cb_t callback,
+                        ior_aiori_pos_cb_t position, void *arg,
+                        IOR_param_t * param);
+        int (*statat) (void *dir, const char *name, int mask,
+                       struct stat *buf, IOR_param_t * param);
+        int (*unlinkat) (void *dir, const char *name, int flags,
+                         IOR_param_t * param);
+        void (*closedir) (void *dir, IOR_param_t * param);
 } ior_aiori_t;
 
 extern ior_aiori_t hdf5_aiori;
@@ -92,6 +138,8 @@ const ior_aiori_t *aiori_select (const char *api);
 int aiori_count (void);
 const char *aiori_default (void);
 
+int aiori_posix_statx (int dirfd, const char *path, int mask, struct stat *buf);
+
 IOR_offset_t MPIIO_GetFileSize(IOR_param_t * test, MPI_Comm testComm,
                                char *testFileName);
 
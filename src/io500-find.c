@@ -6,6 +6,13 @@
 #include <dirent.h>
 #include <limits.h>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <fnmatch.h>
+#include <pthread.h>
+#include <time.h>
+#include <regex.h>
 
 #include <aiori.h>
 #include <libcircle.h>
@@ -19,93 +26,172 @@
 
 // parallel recursive find
 
-static struct stat compare_time_newer;
-static off_t glob_expected_size;
-static char * glob_compare_str;
-
 static int glob_verbosity = 0;
+static int glob_stat_flags; // IOR_STATX_DONT_SYNC if cached attributes suffice
 static int glob_delete;
-static int glob_stonewall_timer;
-static double glob_endtime;
 
 static io500_find_results_t * res = NULL;
 
-io500_find_results_t* io500_find(io500_options_t * opt){
+static int find_dist_cmp(const void * a, const void * b){
+  double x = *(const double *) a;
+  double y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+// gather a per-rank value on rank 0 and compute its distribution
+static void find_dist(double value, io500_find_dist_t * dist){
+  int size;
+  MPI_Comm_size(MPI_COMM_WORLD, & size);
+  double * values = NULL;
   if(rank == 0){
-    fprintf(opt->output, "[Running] find: %s\n", CurrentTimeString());
+    values = malloc(sizeof(double) * size);
   }
-
-  glob_expected_size = 3900; // TODO make that adjustable
-  glob_verbosity = opt->verbosity;
-  char fname[4096];
-  {
-    sprintf(fname, "%s/IO500_TIMESTAMP", opt->workdir);
-    if(lstat(fname, & compare_time_newer) != 0) {
-      printf("Timestamp file: %s\n", fname);
-      io500_error("Could not read timestamp file!");
-    }
+  MPI_Gather(& value, 1, MPI_DOUBLE, values, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  if(rank == 0){
+    qsort(values, size, sizeof(double), find_dist_cmp);
+    dist->min = values[0];
+    dist->median = size % 2 ? values[size / 2] : (values[size / 2 - 1] + values[size / 2]) / 2;
+    dist->max = values[size - 1];
+    free(values);
   }
-
-  sprintf(fname, "%s/mdtest_easy", opt->workdir);
-
-  //ior_aiori_t * backend = aiori_select(opt->backend_name);
-  double start = GetTimeStamp();
-  io500_find_results_t * res = io500_parallel_find_or_delete(out_logfile, fname, "01", 0, opt->stonewall_timer_reads ? opt->stonewall_timer : 0 );
-  double end = GetTimeStamp();
-  res->runtime = end - start;
-
-  double runtime = res->runtime;
-  long long found = res->found_files;
-  long long total_files = res->total_files;
-  MPI_Reduce(& runtime, & res->runtime, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
-  MPI_Reduce(& found, & res->found_files, 1, MPI_LONG_LONG_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-  MPI_Reduce(& total_files, & res->total_files, 1, MPI_LONG_LONG_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-
-  res->rate = res->total_files / res->runtime;
-
-  return res;
 }
 
-
-io500_find_results_t* io500_find_hard(io500_options_t * opt){
+static io500_find_results_t* io500_find_dir(io500_options_t * opt, const char * subdir){
   if(rank == 0){
     fprintf(opt->output, "[Running] find: %s\n", CurrentTimeString());
   }
 
-  glob_expected_size = 3900; // TODO make that adjustable
   glob_verbosity = opt->verbosity;
+  glob_stat_flags = opt->find_dont_sync ? IOR_STATX_DONT_SYNC : 0;
 
   char fname[4096];
-  {
-    sprintf(fname, "%s/IO500_TIMESTAMP", opt->workdir);
-    if(lstat(fname, & compare_time_newer) != 0) {
-      printf("Timestamp file: %s\n", fname);
-      io500_error("Could not read timestamp file!");
-    }
+  char expression[8192];
+  if(opt->find_expression){
+    snprintf(expression, sizeof(expression), "%s", opt->find_expression);
+  }else{
+    snprintf(expression, sizeof(expression), "-type f -name *01* -size 3900c -cnewer %s/IO500_TIMESTAMP", opt->workdir);
   }
-  sprintf(fname, "%s/mdtest_hard", opt->workdir);
+  sprintf(fname, "%s/%s", opt->workdir, subdir);
 
-  //ior_aiori_t * backend = aiori_select(opt->backend_name);
   double start = GetTimeStamp();
-  io500_find_results_t * res = io500_parallel_find_or_delete(out_logfile, fname, "01", 0, opt->stonewall_timer_reads ? opt->stonewall_timer : 0 );
+  io500_find_results_t * res = io500_parallel_find_or_delete(out_logfile, opt->backend_name_metadata, fname, expression, 0, opt->stonewall_timer_reads ? opt->stonewall_timer : 0, opt->find_threads);
   double end = GetTimeStamp();
   res->runtime = end - start;
 
   double runtime = res->runtime;
   long long found = res->found_files;
   long long total_files = res->total_files;
+  long long errors = res->errors;
   MPI_Reduce(& runtime, & res->runtime, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
   MPI_Reduce(& found, & res->found_files, 1, MPI_LONG_LONG_INT, MPI_SUM, 0, MPI_COMM_WORLD);
   MPI_Reduce(& total_files, & res->total_files, 1, MPI_LONG_LONG_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(& errors, & res->errors, 1, MPI_LONG_LONG_INT, MPI_SUM, 0, MPI_COMM_WORLD);
 
   res->rate = res->total_files / res->runtime;
 
+  find_dist(res->dirs_read, & res->dist_dirs);
+  find_dist(res->entries_scanned, & res->dist_entries);
+  find_dist(res->stats_issued, & res->dist_stats);
+  find_dist(res->items_received, & res->dist_received);
+  find_dist(res->bytes_received, & res->dist_bytes);
+  find_dist(res->idle_time, & res->dist_idle);
+
   return res;
 }
 
+io500_find_results_t* io500_find(io500_options_t * opt){
+  return io500_find_dir(opt, "mdtest_easy");
+}
+
+io500_find_results_t* io500_find_hard(io500_options_t * opt){
+  return io500_find_dir(opt, "mdtest_hard");
+}
+
 // globals
+#define FIND_DIR_BUFFER (64 * 1024) // bytes of entries read before the rest of a directory is handed off
+#define FIND_POOL_OUT (1024 * 1024) // bytes of items the workers of a rank produce before the main thread hands them to libcircle
+
 static char start_dir[8192]; // absolute path of start directory
-static char item_buf[8192]; // buffer to construct type / path combos for queue items
+static char start_item[8192]; // the first queue item
+
+// state of a find worker, each thread of a rank owns one so the engine
+// itself does not share anything but the read-only settings
+typedef struct {
+  io500_find_results_t res;
+  CIRCLE_handle * handle; // enqueue directly when the rank runs without worker threads
+  char item_buf[8192]; // buffer to construct type / path combos for queue items
+
+  uint64_t items_out; // work items produced
+  uint64_t bytes_out;
+
+  // directories read when deleting, removed bottom-up once all files are gone
+  char * dirs;
+  size_t dirs_len;
+  size_t dirs_size;
+
+  // arena that collects the candidates of one directory needing a stat
+  // (or an unlink when deleting); enqueued as "B<dir>//<name>/<name>/..."
+  char batch_buf[CIRCLE_MAX_STRING_LEN];
+  int batch_start_len; // length of the "B<dir>//" header
+  int batch_len;
+  int batch_names;
+
+  struct stat buf;
+} find_worker_t;
+
+static int glob_threads;
+static find_worker_t * workers;
+
+// work items this rank took from libcircle and the time spent on them
+static uint64_t find_items_in;
+static uint64_t find_bytes_in;
+static double find_busy_time;
+
+// all metadata operations go through the backend selected for the metadata phases
+static const ior_aiori_t * find_backend;
+static IOR_param_t find_param;
+
+// with multiple threads per rank the main thread moves items between libcircle,
+// which balances the work between the ranks, and the worker threads
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_work = PTHREAD_COND_INITIALIZER;   // workers wait for items
+static pthread_cond_t pool_event = PTHREAD_COND_INITIALIZER;  // main thread waits for new items or finished workers
+static pthread_cond_t pool_space = PTHREAD_COND_INITIALIZER;  // workers wait for room in pool_out
+#define FIND_POOL_WAIT_NS 1000000 // main thread with queued items and no idle worker
+static char (* pool_in)[CIRCLE_MAX_STRING_LEN]; // ring of glob_threads items for the workers
+static int pool_in_head;
+static int pool_in_count;
+static int pool_busy;   // workers processing an item
+static int pool_stop;
+static char * pool_out; // items produced by the workers, separated by '\0'
+static size_t pool_out_len;
+
+static double find_now(){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, & ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void find_enqueue(find_worker_t * w, char * item){
+  size_t len = strlen(item) + 1;
+  w->items_out++;
+  w->bytes_out += len;
+  if(w->handle != NULL){
+    w->handle->enqueue(item);
+    return;
+  }
+  pthread_mutex_lock(& pool_lock);
+  while(pool_out_len + len > FIND_POOL_OUT){
+    pthread_cond_signal(& pool_event);
+    pthread_cond_wait(& pool_space, & pool_lock);
+  }
+  if(pool_out_len == 0){
+    pthread_cond_signal(& pool_event);
+  }
+  memcpy(pool_out + pool_out_len, item, len);
+  pool_out_len += len;
+  pthread_mutex_unlock(& pool_lock);
+}
 
 static char  find_file_type(unsigned char c) {
     switch (c) {
@@ -128,114 +214,541 @@ static char  find_file_type(unsigned char c) {
     }
 }
 
-static void find_do_lstat(char *path) {
-  static struct stat buf;
-  // filename comparison has been done already
-  if(glob_verbosity >= 2){
-    fprintf(out_logfile, "STAT: %s\n", path);
+// find predicates, compiled from an expression in the syntax of find(1):
+//   [!] -name GLOB | -regex RE | -type [fdlbcFs] | -size [+-]N[c|k|M|G]
+//   [!] -newer FILE | -cnewer FILE
+// All predicates must hold. They are reordered so that the ones working on
+// the name alone run first and a stat is only issued when they all pass.
+// -newer and -cnewer accept entries whose mtime/ctime is not older than the
+// one of FILE; a size without unit is in bytes.
+typedef enum {
+  FIND_PRED_NAME,
+  FIND_PRED_REGEX,
+  FIND_PRED_TYPE,
+  FIND_PRED_SIZE,
+  FIND_PRED_NEWER,
+  FIND_PRED_CNEWER
+} find_pred_kind_t;
+
+typedef struct {
+  find_pred_kind_t kind;
+  const char * option;
+  int negate;
+  int cmp;          // -size: -1 less than, 0 equal to, 1 greater than
+  char type;        // -type as returned by find_file_type()
+  off_t size;
+  time_t time;
+  char * pattern;
+  regex_t regex;
+} find_pred_t;
+
+#define FIND_MAX_PREDICATES 16
+
+typedef struct {
+  int count;
+  int type_count;     // predicates before this index do not need a stat
+  int stat_mask;      // IOR_STATX_* fields needed by the remaining predicates
+  int match_dirs;     // directories are candidates only with -type d, otherwise just traversed
+  find_pred_t pred[FIND_MAX_PREDICATES];
+} find_program_t;
+
+static find_program_t prog;
+
+static int find_pred_cost(find_pred_kind_t kind){
+  switch(kind){
+    case FIND_PRED_NAME: return 0;
+    case FIND_PRED_REGEX: return 1;
+    case FIND_PRED_TYPE: return 2;
+    default: return 3;
   }
+}
 
-  if (lstat(path+1, & buf) == 0) {
-    // compare values
-    if(buf.st_size != glob_expected_size){
-      if(glob_verbosity >= 2){
-        fprintf(out_logfile, "Size does not match: %s has %zu bytes\n", path, (size_t) buf.st_size);
+static void find_compile(const char * expression){
+  memset(& prog, 0, sizeof(prog));
+  if(expression == NULL){
+    return;
+  }
+  char * copy = strdup(expression);
+  char * saveptr = NULL;
+  int negate = 0;
+  for(char * tok = strtok_r(copy, " \t", & saveptr); tok != NULL; tok = strtok_r(NULL, " \t", & saveptr)){
+    if(strcmp(tok, "!") == 0 || strcmp(tok, "-not") == 0){
+      negate = ! negate;
+      continue;
+    }
+    char * arg = strtok_r(NULL, " \t", & saveptr);
+    if(arg == NULL){
+      printf("Find expression: %s\n", expression);
+      io500_error("Missing argument in find expression");
+    }
+    if(prog.count == FIND_MAX_PREDICATES){
+      io500_error("Too many predicates in find expression");
+    }
+    find_pred_t * p = & prog.pred[prog.count++];
+    p->negate = negate;
+    negate = 0;
+    if(strcmp(tok, "-name") == 0){
+      p->kind = FIND_PRED_NAME;
+      p->option = "-name";
+      p->pattern = strdup(arg);
+    }else if(strcmp(tok, "-regex") == 0){
+      p->kind = FIND_PRED_REGEX;
+      p->option = "-regex";
+      if(regcomp(& p->regex, arg, REG_EXTENDED | REG_NOSUB) != 0){
+        printf("Regular expression: %s\n", arg);
+        io500_error("Invalid regular expression in find expression");
       }
-      return;
+    }else if(strcmp(tok, "-type") == 0){
+      p->kind = FIND_PRED_TYPE;
+      p->option = "-type";
+      p->type = arg[0];
+      if(strchr("fdlbcFs", p->type) == NULL || arg[1] != 0){
+        io500_error("Invalid file type in find expression");
+      }
+      if(p->type == 'd' && ! p->negate){
+        prog.match_dirs = 1;
+      }
+    }else if(strcmp(tok, "-size") == 0){
+      p->kind = FIND_PRED_SIZE;
+      p->option = "-size";
+      p->cmp = (*arg == '+') - (*arg == '-');
+      char * unit;
+      p->size = strtoll(arg + (p->cmp != 0), & unit, 10);
+      switch(*unit){
+        case 0:
+        case 'c': break;
+        case 'k': p->size *= 1024; break;
+        case 'M': p->size *= 1024 * 1024; break;
+        case 'G': p->size *= 1024 * 1024 * 1024ll; break;
+        default:
+          io500_error("Invalid size in find expression");
+      }
+      prog.stat_mask |= IOR_STATX_SIZE;
+    }else if(strcmp(tok, "-newer") == 0 || strcmp(tok, "-cnewer") == 0){
+      struct stat buf;
+      int ctime = tok[1] == 'c';
+      p->kind = ctime ? FIND_PRED_CNEWER : FIND_PRED_NEWER;
+      p->option = ctime ? "-cnewer" : "-newer";
+      int ret = 0;
+      if(io500_rank == 0){
+        ret = find_backend->statx(arg, IOR_STATX_MTIME | IOR_STATX_CTIME | IOR_STATX_NOFOLLOW, & buf, & find_param);
+      }
+      if(io500_bcast_probe(ret, & buf, sizeof(buf)) != 0) {
+        printf("Timestamp file: %s\n", arg);
+        io500_error("Could not read timestamp file!");
+      }
+      p->time = ctime ? buf.st_ctime : buf.st_mtime;
+      prog.stat_mask |= ctime ? IOR_STATX_CTIME : IOR_STATX_MTIME;
+    }else{
+      printf("Find expression: %s\n", expression);
+      io500_error("Unknown predicate in find expression");
+    }
+  }
+  free(copy);
+  // cheapest first, the sort is stable to keep the order of the user otherwise
+  for(int i=1; i < prog.count; i++){
+    find_pred_t tmp = prog.pred[i];
+    int j = i;
+    for(; j > 0 && find_pred_cost(prog.pred[j-1].kind) > find_pred_cost(tmp.kind); j--){
+      prog.pred[j] = prog.pred[j-1];
+    }
+    prog.pred[j] = tmp;
+  }
+  for(prog.type_count = 0; prog.type_count < prog.count && find_pred_cost(prog.pred[prog.type_count].kind) <= 2; prog.type_count++);
+}
+
+static void find_free_program(){
+  for(int i=0; i < prog.count; i++){
+    free(prog.pred[i].pattern);
+    if(prog.pred[i].kind == FIND_PRED_REGEX){
+      regfree(& prog.pred[i].regex);
+    }
+  }
+  memset(& prog, 0, sizeof(prog));
+}
+
+static char find_mode_type(mode_t mode){
+  if(S_ISDIR(mode)) return 'd';
+  if(S_ISLNK(mode)) return 'l';
+  if(S_ISBLK(mode)) return 'b';
+  if(S_ISCHR(mode)) return 'c';
+  if(S_ISFIFO(mode)) return 'F';
+  if(S_ISSOCK(mode)) return 's';
+  return 'f';
+}
+
+// evaluate the predicates from first on: returns 1 if the entry matches,
+// 0 if it does not and -1 if a stat (buf) is needed to decide
+static int find_eval(int first, const char *dir, const char *name, char typ, struct stat *buf){
+  for(int i=first; i < prog.count; i++){
+    find_pred_t * p = & prog.pred[i];
+    int match;
+    if(buf == NULL && i >= prog.type_count){
+      return -1;
     }
-    if( buf.st_ctime < compare_time_newer.st_ctime ){
+    switch(p->kind){
+      case FIND_PRED_NAME:
+        match = fnmatch(p->pattern, name, 0) == 0; break;
+      case FIND_PRED_REGEX:
+        match = regexec(& p->regex, name, 0, NULL, 0) == 0; break;
+      case FIND_PRED_TYPE:
+        match = typ == p->type; break;
+      case FIND_PRED_SIZE:
+        match = p->cmp == 0 ? buf->st_size == p->size : (p->cmp > 0 ? buf->st_size > p->size : buf->st_size < p->size); break;
+      case FIND_PRED_NEWER:
+        match = buf->st_mtime >= p->time; break;
+      case FIND_PRED_CNEWER:
+        match = buf->st_ctime >= p->time; break;
+      default:
+        match = 0;
+    }
+    if(match == p->negate){
       if(glob_verbosity >= 2){
-        fprintf(out_logfile, "Timestamp too small: %s\n", path);
+        fprintf(out_logfile, "Predicate %s%s rejects %s/%s\n", p->negate ? "! " : "", p->option, dir, name);
       }
-      return;
+      return 0;
     }
+  }
+  return 1;
+}
 
-    if(glob_verbosity >= 2){
-      fprintf(out_logfile, "Found acceptable file: %s\n", path);
-    }
-    res->found_files++;
-  } else {
-    res->errors++;
+static void find_found(find_worker_t * w, const char *dir, const char *name){
+  if(glob_verbosity >= 2){
+    fprintf(out_logfile, "Found acceptable file: %s/%s\n", dir, name);
+  }
+  w->res.found_files++;
+}
+
+// stat a candidate file relative to the handle of its directory, the name
+// and type predicates have been evaluated already
+static int find_do_lstat(find_worker_t * w, void *dh, const char *dir, const char *name) {
+  if(glob_verbosity >= 2){
+    fprintf(out_logfile, "STAT: %s/%s\n", dir, name);
+  }
+
+  // request only the fields the predicates look at
+  w->res.stats_issued++;
+  if (find_backend->statat(dh, name, prog.stat_mask | IOR_STATX_NOFOLLOW | glob_stat_flags, & w->buf, & find_param) != 0) {
+    w->res.errors++;
     if(glob_verbosity >= 1){
-      fprintf(out_logfile, "Error stating file: %s\n", path);
+      fprintf(out_logfile, "Error stating file: %s/%s\n", dir, name);
     }
+    return 0;
   }
+  return find_eval(prog.type_count, dir, name, 0, & w->buf);
 }
 
-static void find_do_readdir(char *path, CIRCLE_handle *handle) {
-    int path_len = strlen(path+1);
-    DIR *d = opendir(path+1);
-    if (!d) {
-        fprintf (stderr, "Cannot open '%s': %s\n", path+1, strerror (errno));
-        return;
+static void find_batch_begin(find_worker_t * w, const char *dir, int dir_len) {
+  w->batch_start_len = 0;
+  w->batch_len = 0;
+  w->batch_names = 0;
+  if (dir_len + 3 < CIRCLE_MAX_STRING_LEN){
+    w->batch_start_len = sprintf(w->batch_buf, "B%s//", dir);
+    w->batch_len = w->batch_start_len;
+  }
+}
+
+static void find_batch_flush(find_worker_t * w) {
+  if (w->batch_names == 0){
+    return;
+  }
+  w->batch_buf[w->batch_len - 1] = 0; // strip the last separator
+  find_enqueue(w, w->batch_buf);
+  w->batch_len = w->batch_start_len;
+  w->batch_names = 0;
+}
+
+// a candidate in a batch: stat it if the predicates still need it, then
+// count it or unlink it when deleting
+static void find_do_file(find_worker_t * w, void *dh, const char *dir, const char *name) {
+  if(prog.count > prog.type_count && ! find_do_lstat(w, dh, dir, name)){
+    return;
+  }
+  if(! glob_delete){
+    find_found(w, dir, name);
+  }else{
+    if (find_backend->unlinkat(dh, name, 0, & find_param) == 0){
+      w->res.deleted_files++;
+    }else{
+      w->res.errors++;
+      if(glob_verbosity >= 1){
+        fprintf(out_logfile, "Error deleting file: %s/%s\n", dir, name);
+      }
     }
-    int fd = dirfd(d);
-    while (1) {
-        struct dirent *entry;
-        entry = readdir(d);
-        if (glob_stonewall_timer && GetTimeStamp() >= glob_endtime ){
-          break;
-        }
-        if (entry==0) {
-            break;
-        }
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
-        }
-        char typ = find_file_type(entry->d_type);
-        if (typ == 'u'){
-          // sometimes the filetype is not provided by readdir.
+  }
+}
+
+// queue a file of the directory for a stat or unlink in a batch
+static void find_batch_add(find_worker_t * w, void *dh, const char *dir, const char *name) {
+  int len = strlen(name);
+  if (w->batch_len + len + 1 >= CIRCLE_MAX_STRING_LEN){
+    find_batch_flush(w);
+  }
+  if (w->batch_start_len == 0 || w->batch_len + len + 1 >= CIRCLE_MAX_STRING_LEN){
+    // the path is too long to share the directory in a batch
+    find_do_file(w, dh, dir, name);
+    return;
+  }
+  memcpy(w->batch_buf + w->batch_len, name, len);
+  w->batch_buf[w->batch_len + len] = '/';
+  w->batch_len += len + 1;
+  w->batch_names++;
+}
 
-          static struct stat buf;
-          if (fstatat(fd, entry->d_name, & buf, 0 )) {
-            res->errors++;
+// process a batch with a single open of the directory, so all stats
+// are resolved relative to its handle instead of walking the full path
+static void find_do_batch(find_worker_t * w, char *item) {
+  char * names = strstr(item, "//");
+  if (names == NULL){
+    return;
+  }
+  *names = 0;
+  names += 2;
+  void * dh = find_backend->opendir(item, & find_param);
+  if (dh == NULL) {
+    fprintf (stderr, "Cannot open '%s': %s\n", item, strerror (errno));
+    w->res.errors++;
+    return;
+  }
+  while (names != NULL){
+    char * end = strchr(names, '/');
+    if (end != NULL){
+      *end = 0;
+      end++;
+    }
+    find_do_file(w, dh, item, names);
+    names = end;
+  }
+  find_backend->closedir(dh, & find_param);
+}
+
+// evaluate one directory entry: directories are enqueued, predicates that
+// work without a stat are checked right away and the remaining candidates
+// are collected in the batch
+static void find_do_entry(find_worker_t * w, const char *dir, void *dh, const char *name, unsigned char d_type) {
+        struct stat * bufp = NULL;
+        char typ = find_file_type(d_type);
+        if (typ == 'u'){
+          // sometimes the filetype is not provided by readdir, fetch the
+          // fields for the predicates with the same stat
+          w->res.stats_issued++;
+          if (find_backend->statat(dh, name, IOR_STATX_TYPE | prog.stat_mask | IOR_STATX_NOFOLLOW | glob_stat_flags, & w->buf, & find_param)) {
+            w->res.errors++;
             if(glob_verbosity >= 1){
-              fprintf(out_logfile, "Error stating file: %s\n", path);
-            }
-            continue;
-          }
-          typ = S_ISDIR(buf.st_mode) ? 'd' : 'f';
-
-          if(! glob_delete && typ == 'f'){ // since we have done the stat already, it would be a waste to do it again
-            res->total_files++;
-            // compare values
-            if(glob_compare_str != NULL && strstr(entry->d_name, glob_compare_str) == NULL){
-              continue;
-            }else if(buf.st_size != glob_expected_size){
-              if(glob_verbosity >= 2){
-                fprintf(out_logfile, "Size does not match: %s/%s has %zu bytes\n", path + 1, entry->d_name, (size_t) buf.st_size);
-              }
-              continue;
-            }else if( buf.st_ctime < compare_time_newer.st_ctime ){
-              if(glob_verbosity >= 2){
-                fprintf(out_logfile, "Timestamp too small: %s/%s\n", path + 1, entry->d_name);
-              }
-              continue;
-            }else{
-              if(glob_verbosity >= 2){
-                fprintf(out_logfile, "Found acceptable file: %s/%s\n", path + 1, entry->d_name);
-              }
-              res->found_files++;
-              continue;
+              fprintf(out_logfile, "Error stating file: %s/%s\n", dir, name);
             }
+            return;
           }
+          typ = find_mode_type(w->buf.st_mode);
+          bufp = & w->buf;
         }
 
-        if (typ == 'f'){
-          res->total_files++;
-          // compare file name
-          if( glob_compare_str != NULL && strstr(entry->d_name, glob_compare_str) == NULL){
-            continue;
+        if (typ == 'd'){
+          char tmp[8192];
+          snprintf(tmp, sizeof(tmp), "d%s/%s", dir, name);
+          find_enqueue(w, tmp);
+          if (! prog.match_dirs || glob_delete){
+            return;
           }
+        }else{
+          w->res.total_files++;
+        }
+        int match = find_eval(0, dir, name, typ, bufp);
+        if (match == 0){
+          return;
+        }
+        if (match == 1 && ! glob_delete){
+          find_found(w, dir, name);
+          return;
+        }
+        find_batch_add(w, dh, dir, name);
+}
+
+static void find_remember_dir(find_worker_t * w, const char * dir){
+  size_t len = strlen(dir) + 1;
+  if (w->dirs_len + len > w->dirs_size){
+    w->dirs_size = w->dirs_size * 2 + len + 4096;
+    w->dirs = realloc(w->dirs, w->dirs_size);
+    if (w->dirs == NULL){
+      io500_error("Out of memory while tracking directories to remove");
+    }
+  }
+  memcpy(w->dirs + w->dirs_len, dir, len);
+  w->dirs_len += len;
+}
+
+static int find_path_depth(const char * path){
+  int depth = 0;
+  for(; *path; path++){
+    depth += *path == '/';
+  }
+  return depth;
+}
+
+typedef struct {
+  int depth;
+  char * path;
+} find_dir_t;
+
+static int find_dir_cmp(const void * a, const void * b){
+  const find_dir_t * x = (const find_dir_t *) a;
+  const find_dir_t * y = (const find_dir_t *) b;
+  if (x->depth != y->depth){
+    return y->depth - x->depth;
+  }
+  return strcmp(x->path, y->path);
+}
+
+// remove the directories read during the delete walk from the deepest level
+// up. Every rank removes the directories it has read; a barrier after each
+// level ensures that all children of the next level are gone. Siblings are
+// sorted next to each other, so they are removed relative to one open
+// handle of their parent.
+static void find_remove_dirs(){
+  size_t count = 0;
+  for(int i=0; i < glob_threads; i++){
+    for(size_t pos = 0; pos < workers[i].dirs_len; pos += strlen(workers[i].dirs + pos) + 1){
+      count++;
+    }
+  }
+  find_dir_t * dirs = malloc(sizeof(find_dir_t) * (count + 1));
+  int max_depth = find_path_depth(start_dir);
+  count = 0;
+  for(int i=0; i < glob_threads; i++){
+    for(size_t pos = 0; pos < workers[i].dirs_len; pos += strlen(workers[i].dirs + pos) + 1){
+      dirs[count].path = workers[i].dirs + pos;
+      dirs[count].depth = find_path_depth(dirs[count].path);
+      if (dirs[count].depth > max_depth){
+        max_depth = dirs[count].depth;
+      }
+      count++;
+    }
+  }
+  qsort(dirs, count, sizeof(find_dir_t), find_dir_cmp);
+  MPI_Allreduce(MPI_IN_PLACE, & max_depth, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+
+  size_t pos = 0;
+  for(int depth = max_depth; depth > find_path_depth(start_dir); depth--){
+    void * dh = NULL;
+    char parent[8192] = "";
+    for(; pos < count && dirs[pos].depth == depth; pos++){
+      char * name = strrchr(dirs[pos].path, '/');
+      *name = 0;
+      if (dh == NULL || strcmp(parent, dirs[pos].path) != 0){
+        if (dh != NULL){
+          find_backend->closedir(dh, & find_param);
         }
-        char *tmp=(char*) malloc(path_len+strlen(entry->d_name)+3);
-        *tmp = typ;
-        strcpy(tmp+1, path+1);
-        *(tmp+path_len+1)='/';
-        strcpy(tmp + path_len+2, entry->d_name);
-        handle->enqueue(tmp);
+        snprintf(parent, sizeof(parent), "%s", dirs[pos].path);
+        dh = find_backend->opendir(parent, & find_param);
+      }
+      if (dh != NULL && find_backend->unlinkat(dh, name + 1, IOR_UNLINK_DIR, & find_param) == 0){
+        res->deleted_dirs++;
+      }else{
+        res->errors++;
+        if(glob_verbosity >= 1){
+          fprintf(out_logfile, "Error removing directory: %s/%s\n", dirs[pos].path, name + 1);
+        }
+      }
+    }
+    if (dh != NULL){
+      find_backend->closedir(dh, & find_param);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+  }
+  free(dirs);
+}
+
+typedef struct {
+  find_worker_t * w;
+  const char * dir;
+  void * dh;
+} find_scan_t;
+
+static int find_scan_entry(const ior_aiori_dirent_t *entry, void *arg){
+  find_scan_t * scan = (find_scan_t *) arg;
+  if (DeadlineReached()){
+    return 1;
+  }
+  scan->w->res.entries_scanned++;
+  find_do_entry(scan->w, scan->dir, scan->dh, entry->name, entry->type);
+  return 0;
+}
+
+// the buffer is full, hand off the rest of the directory before its entries
+// are processed
+static void find_scan_resume(uint64_t cookie, void *arg){
+  find_scan_t * scan = (find_scan_t *) arg;
+  char resume[8192];
+  snprintf(resume, sizeof(resume), "r%llx%s", (unsigned long long) cookie, scan->dir);
+  find_enqueue(scan->w, resume);
+}
+
+// read the directory starting at the position cookie (0 for the beginning).
+// Once FIND_DIR_BUFFER bytes of entries have been read, the rest of the
+// directory is enqueued as a resume item before this rank processes them, so
+// other ranks continue reading a huge directory concurrently. The readdir
+// fallback of the backend only reports the position after the entries.
+static void find_do_readdir(find_worker_t * w, char *dir, uint64_t cookie) {
+    find_scan_t scan = {w, dir, NULL};
+    scan.dh = find_backend->opendir(dir, & find_param);
+    if (scan.dh == NULL) {
+        fprintf (stderr, "Cannot open '%s': %s\n", dir, strerror (errno));
+        return;
+    }
+    find_batch_begin(w, dir, strlen(dir));
+    if (cookie == 0){
+      w->res.dirs_read++;
+    }
+    if (glob_delete && cookie == 0 && strcmp(dir, start_dir) != 0){
+      find_remember_dir(w, dir);
+    }
+    int ret = find_backend->iterate(scan.dh, & cookie, FIND_DIR_BUFFER, find_scan_entry, find_scan_resume, & scan, & find_param);
+    if (ret < 0){
+      fprintf (stderr, "Cannot read '%s': %s\n", dir, strerror (errno));
+      w->res.errors++;
     }
-    closedir(d);
+    find_batch_flush(w);
+    find_backend->closedir(scan.dh, & find_param);
+}
+
+static void find_process_item(find_worker_t * w){
+    char * item = w->item_buf;
+    if (*item == 'd') {
+      find_do_readdir(w, item + 1, 0);
+    }else if (*item == 'r') {
+      // resume reading a directory: r<hex cookie><path>
+      char * dir;
+      uint64_t cookie = strtoull(item + 1, & dir, 16);
+      find_do_readdir(w, dir, cookie);
+    }else if (*item == 'B') {
+      find_do_batch(w, item + 1);
+    }
+}
+
+static void * find_worker_thread(void * arg){
+  find_worker_t * w = (find_worker_t *) arg;
+  pthread_mutex_lock(& pool_lock);
+  while(1){
+    while(pool_in_count == 0 && ! pool_stop){
+      pthread_cond_wait(& pool_work, & pool_lock);
+    }
+    if(pool_in_count == 0){
+      break;
+    }
+    strcpy(w->item_buf, pool_in[pool_in_head]);
+    pool_in_head = (pool_in_head + 1) % glob_threads;
+    pool_in_count--;
+    pool_busy++;
+    pthread_mutex_unlock(& pool_lock);
+
+    find_process_item(w);
+
+    pthread_mutex_lock(& pool_lock);
+    pool_busy--;
+    pthread_cond_signal(& pool_event);
+  }
+  pthread_mutex_unlock(& pool_lock);
+  return NULL;
 }
 
 // create work callback
@@ -243,48 +756,124 @@ static void find_do_readdir(char *path, CIRCLE_handle *handle) {
 // use to seed rank 0 with the initial dir to start
 // searching from
 static void find_create_work(CIRCLE_handle *handle) {
-    handle->enqueue(item_buf);
+    handle->enqueue(start_item);
 }
 
 // process work callback
 static void find_process_work(CIRCLE_handle *handle)
 {
-    // dequeue the next item
-    handle->dequeue(item_buf);
-    if (*item_buf == 'd') {
-      find_do_readdir(item_buf, handle);
-    }else{
-      if(! glob_delete){
-        find_do_lstat(item_buf);
-      }else{
-        unlink(& item_buf[1]); // strip type
+    double start = find_now();
+    if (glob_threads == 1){
+      // dequeue the next item
+      workers[0].handle = handle;
+      handle->dequeue(workers[0].item_buf);
+      find_items_in++;
+      find_bytes_in += strlen(workers[0].item_buf) + 1;
+      find_process_item(& workers[0]);
+      find_busy_time += find_now() - start;
+      return;
+    }
+    pthread_mutex_lock(& pool_lock);
+    while(1){
+      // hand out items to the idle workers
+      while(pool_in_count + pool_busy < glob_threads && handle->local_queue_size() > 0){
+        char * item = pool_in[(pool_in_head + pool_in_count) % glob_threads];
+        handle->dequeue(item);
+        find_items_in++;
+        find_bytes_in += strlen(item) + 1;
+        pool_in_count++;
+        pthread_cond_signal(& pool_work);
+      }
+      if (pool_out_len > 0){
+        for(size_t pos = 0; pos < pool_out_len; pos += strlen(pool_out + pos) + 1){
+          handle->enqueue(pool_out + pos);
+        }
+        pool_out_len = 0;
+        pthread_cond_broadcast(& pool_space);
+      }
+      // return to libcircle to let it balance the work, but not while the
+      // workers are busy and this rank would look idle to it
+      if (pool_in_count == 0 && pool_busy == 0){
+        break;
       }
+      if (handle->local_queue_size() > 0){
+        // all workers are busy: wait shortly for one of them instead of
+        // coming straight back, libcircle still answers the steal requests
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, & until); // the clock of pool_event
+        until.tv_nsec += FIND_POOL_WAIT_NS;
+        if (until.tv_nsec >= 1000000000){
+          until.tv_sec++;
+          until.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(& pool_event, & pool_lock, & until);
+        break;
+      }
+      pthread_cond_wait(& pool_event, & pool_lock);
     }
+    pthread_mutex_unlock(& pool_lock);
+    find_busy_time += find_now() - start;
 }
 
 // arguments :
-// first argument is data directory to store the lstat files
-// second argument is directory to start lstating from
-io500_find_results_t * io500_parallel_find_or_delete(FILE * logfile, char * workdir, char * const filename_pattern, int delete, int stonewall_timer_s) {
+// api is the AIORI backend for all metadata operations
+// workdir is the directory to start from
+// expression selects the files to count or delete, NULL selects all files
+// delete removes the selected files and then all directories below workdir
+// threads is the number of worker threads per rank
+io500_find_results_t * io500_parallel_find_or_delete(FILE * logfile, const char * api, char * workdir, const char * expression, int delete, int stonewall_timer_s, int threads) {
   out_logfile = logfile;
 
-  char * err = realpath(workdir, start_dir);
-  glob_compare_str = filename_pattern;
+  find_backend = aiori_select(api);
+  if (find_backend == NULL){
+    io500_error("Unknown backend for the metadata phases");
+  }
+  memset(& find_param, 0, sizeof(find_param));
+  strncpy(find_param.api, api, MAX_STR - 1);
+
+  // rank 0 resolves and checks the start directory for everyone
+  int ok = 0;
+  if(io500_rank == 0){
+    DIR * sd = NULL;
+    ok = realpath(workdir, start_dir) != NULL && (sd = opendir(start_dir)) != NULL;
+    if (! ok){
+      fprintf (stderr, "Cannot open directory '%s': %s\n", workdir, strerror (errno));
+    }
+    if (sd){
+      closedir(sd);
+    }
+  }
+  if (! io500_bcast_probe(ok, start_dir, sizeof(start_dir))){
+    exit (EXIT_FAILURE);
+  }
+  find_compile(expression);
 
   res = malloc(sizeof(io500_find_results_t));
   memset(res, 0, sizeof(*res));
 
   glob_delete = delete;
-  glob_stonewall_timer = stonewall_timer_s;
-  glob_endtime = GetTimeStamp() + glob_stonewall_timer;
-
-  DIR * sd=opendir(start_dir);
-  if (err == NULL || ! sd) {
-      fprintf (stderr, "Cannot open directory '%s': %s\n", start_dir, strerror (errno));
-      exit (EXIT_FAILURE);
+  glob_threads = threads > 1 ? threads : 1;
+
+  memset(start_item, 0, sizeof(start_item));
+  sprintf(start_item, "%c%s", 'd', start_dir);
+
+  workers = calloc(glob_threads, sizeof(find_worker_t));
+  pthread_t * tids = NULL;
+  if (glob_threads > 1){
+    pool_in = malloc(glob_threads * sizeof(* pool_in));
+    pool_out = malloc(FIND_POOL_OUT);
+    pool_in_head = 0;
+    pool_in_count = 0;
+    pool_busy = 0;
+    pool_stop = 0;
+    pool_out_len = 0;
+    tids = malloc(glob_threads * sizeof(pthread_t));
+    for(int i=0; i < glob_threads; i++){
+      if(pthread_create(& tids[i], NULL, find_worker_thread, & workers[i]) != 0){
+        io500_error("Could not start the find worker threads");
+      }
+    }
   }
-  memset(item_buf, 0, sizeof(item_buf));
-  sprintf(item_buf, "%c%s", 'd', start_dir);
 
 	// initialise MPI and the libcircle stuff
   int argc = 1;
@@ -300,11 +889,54 @@ io500_find_results_t * io500_parallel_find_or_delete(FILE * logfile, char * work
 	// set the process work callback
 	CIRCLE_cb_process(& find_process_work);
 
+  find_items_in = 0;
+  find_bytes_in = 0;
+  find_busy_time = 0;
+  double loop_start = find_now();
+  StartDeadline(stonewall_timer_s);
+
 	// enter the processing loop
 	CIRCLE_begin();
+  StopDeadline();
+  res->idle_time = find_now() - loop_start - find_busy_time;
 
 	// wait for all processing to finish and then clean up
 	CIRCLE_finalize();
 
+  if (glob_threads > 1){
+    pthread_mutex_lock(& pool_lock);
+    pool_stop = 1;
+    pthread_cond_broadcast(& pool_work);
+    pthread_mutex_unlock(& pool_lock);
+    for(int i=0; i < glob_threads; i++){
+      pthread_join(tids[i], NULL);
+    }
+    free(tids);
+    free(pool_in);
+    free(pool_out);
+  }
+  for(int i=0; i < glob_threads; i++){
+    res->errors += workers[i].res.errors;
+    res->found_files += workers[i].res.found_files;
+    res->total_files += workers[i].res.total_files;
+    res->deleted_files += workers[i].res.deleted_files;
+    res->dirs_read += workers[i].res.dirs_read;
+    res->entries_scanned += workers[i].res.entries_scanned;
+    res->stats_issued += workers[i].res.stats_issued;
+    res->items_received -= workers[i].items_out;
+    res->bytes_received -= workers[i].bytes_out;
+  }
+  // the start item is created by rank 0 outside of the workers
+  res->items_received += find_items_in - (rank == 0);
+  res->bytes_received += find_bytes_in - (rank == 0 ? strlen(start_item) + 1 : 0);
+  if (glob_delete){
+    find_remove_dirs();
+  }
+  for(int i=0; i < glob_threads; i++){
+    free(workers[i].dirs);
+  }
+  free(workers);
+
+  find_free_program();
 	return res;
 }
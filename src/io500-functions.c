@@ -6,221 +6,257 @@
 #include <fcntl.h>
 
 #include <utilities.h>
+#include <parse_options.h>
 
 #include "io500-functions.h"
 #include "io500-utils.h"
 #include "io500-options.h"
 
-#define IOR_HARD_OPTIONS "ior -C -Q 1 -g -G 27 -k -e -t 47008 -b 47008"
-#define IOR_EASY_OPTIONS "ior -k"
-#define MDTEST_EASY_OPTIONS "mdtest -F"
-#define MDTEST_HARD_OPTIONS "mdtest -w 3900 -e 3900 -t -F"
+// the phases fill the parameters of IOR and mdtest directly, the options of
+// the configuration file are parsed on top and override them
+
+// parameters shared by the IOR phases, the equivalent of "ior -k -o FILE"
+static void io500_ior_init(IOR_param_t * params, char * file, io500_options_t * options){
+  init_IOR_Param_t(params);
+  GetPlatformName(params->platform);
+  strcpy(params->api, options->backend_name_bandwidth);
+  params->verbose = options->verbosity;
+  params->keepFile = TRUE;
+  snprintf(params->testFileName, sizeof(params->testFileName), "%s/%s", options->workdir, file);
+}
+
+// "ior -C -Q 1 -g -G 27 -k -e -t 47008 -b 47008 -s SEGMENTS"
+static void io500_ior_hard_init(IOR_param_t * params, io500_options_t * options){
+  io500_ior_init(params, "ior_hard/file", options);
+  params->reorderTasks = TRUE;
+  params->taskPerNodeOffset = 1;
+  params->intraTestBarriers = TRUE;
+  params->setTimeStampSignature = 27;
+  params->incompressibleSeed = 27;
+  params->fsync = TRUE;
+  params->transferSize = 47008;
+  params->blockSize = 47008;
+  params->segmentCount = options->iorhard_max_segments;
+}
 
-static IOR_test_t * io500_run_ior_really(char * args, char * suffix, int testID, io500_options_t * options){
+static void io500_ior_stonewall(IOR_param_t * params, io500_options_t * options){
+  params->deadlineForStonewalling = options->stonewall_timer;
+  params->stoneWallingWearOut = 1;
+}
+
+static IOR_test_t * io500_run_ior_really(IOR_param_t * params, const char * extra, char * suffix, int testID, io500_options_t * options){
   int argc_count;
   char ** args_array;
   FILE * out;
 
-  if(io500_rank == 0){
+  if(options->rank == 0){
     printf("\n[Starting] %s: %s", suffix, CurrentTimeString());
     fprintf(options->output, "\n[Starting] %s: %s", suffix, CurrentTimeString());
     fflush(options->output);
   }
 
-  args_array = io500_str_to_arr_prep_exec(args, & argc_count);
+  args_array = io500_str_to_argv("ior", extra, & argc_count);
+  if(ParseOptions(argc_count, args_array, params) != NULL){
+    io500_error("The IOR options cannot contain a script (-f)");
+  }
+  free(args_array[0]);
+  free(args_array);
+
   out = io500_prepare_out(suffix, testID, options);
-  IOR_test_t * res = ior_run(argc_count, args_array, MPI_COMM_WORLD, out);
+  IOR_test_t * res = ior_run_params(params, options->comm, out);
   fclose(out);
-  free(args_array);
   return res;
 }
 
 IOR_test_t * io500_io_hard_create(io500_options_t * options){
-  //generic array holding the arguments to the subtests
-  char args[10000];
-  int pos;
-  pos = sprintf(args, IOR_HARD_OPTIONS" -w");
-  pos += sprintf(& args[pos], " -a %s", options->backend_name_bandwidth);
-  for(int i=0; i < options->verbosity; i++){
-    pos += sprintf(& args[pos], " -v");
-  }
-  pos += sprintf(& args[pos], " -D %d -O stoneWallingWearOut=1", options->stonewall_timer);
-  pos += sprintf(& args[pos], " -s %d", options->iorhard_max_segments);
-
-  io500_replace_str(args); // make sure workdirs with space works
-  pos += sprintf(& args[pos], "\n-o\n%s/ior_hard/file", options->workdir);
-  pos += sprintf(& args[pos], "\n%s", options->ior_hard_options);
+  IOR_param_t params;
+  io500_ior_hard_init(& params, options);
+  params.writeFile = TRUE;
+  io500_ior_stonewall(& params, options);
 
-  return io500_run_ior_really(args, "ior_hard_create", 1, options);
+  return io500_run_ior_really(& params, options->ior_hard_options, "ior_hard_create", 1, options);
 }
 
 
 IOR_test_t * io500_io_hard_read(io500_options_t * options, IOR_test_t * create_read){
-  //generic array holding the arguments to the subtests
-  char args[10000];
-  int pos;
-  pos = sprintf(args, IOR_HARD_OPTIONS" -R");
-  pos += sprintf(& args[pos], " -a %s", options->backend_name_bandwidth);
-  for(int i=0; i < options->verbosity; i++){
-    pos += sprintf(& args[pos], " -v");
-  }
-  pos += sprintf(& args[pos], " -O stoneWallingWearOutIterations=%zu", create_read->results->pairs_accessed);
+  IOR_param_t params;
+  io500_ior_hard_init(& params, options);
+  params.checkRead = TRUE;
+  params.stoneWallingWearOutIterations = create_read->results->pairs_accessed;
   if (options->stonewall_timer_reads){
-    pos += sprintf(& args[pos], " -D %d -O stoneWallingWearOut=1", options->stonewall_timer);
+    io500_ior_stonewall(& params, options);
   }
-  pos += sprintf(& args[pos], " -s %d", options->iorhard_max_segments);
 
-  io500_replace_str(args); // make sure workdirs with space works
-  pos += sprintf(& args[pos], "\n-o\n%s/ior_hard/file", options->workdir);
-  pos += sprintf(& args[pos], "\n%s", options->ior_hard_options);
-
-  return io500_run_ior_really(args, "ior_hard_read", 1, options);
+  return io500_run_ior_really(& params, options->ior_hard_options, "ior_hard_read", 1, options);
 }
 
 
 IOR_test_t * io500_io_easy_create(io500_options_t * options){
-  //generic array holding the arguments to the subtests
-  char args[10000];
-  int pos;
-  pos = sprintf(args, IOR_EASY_OPTIONS" -w");
-  pos += sprintf(& args[pos], " -a %s", options->backend_name_bandwidth);
-  for(int i=0; i < options->verbosity; i++){
-    pos += sprintf(& args[pos], " -v");
-  }
-  pos += sprintf(& args[pos], " -D %d -O stoneWallingWearOut=1", options->stonewall_timer);
-
-  io500_replace_str(args); // make sure workdirs with space works
-  pos += sprintf(& args[pos], "\n-o\n%s/ior_easy/file", options->workdir);
-  pos += sprintf(& args[pos], "\n%s", options->ior_easy_options);
+  IOR_param_t params;
+  io500_ior_init(& params, "ior_easy/file", options);
+  params.writeFile = TRUE;
+  io500_ior_stonewall(& params, options);
 
-  return io500_run_ior_really(args, "ior_easy_create", 1, options);
+  return io500_run_ior_really(& params, options->ior_easy_options, "ior_easy_create", 1, options);
 }
 
 IOR_test_t * io500_io_easy_read(io500_options_t * options, IOR_test_t * create_read){
-  //generic array holding the arguments to the subtests
-  char args[10000];
-  int pos;
-  pos = sprintf(args, IOR_EASY_OPTIONS" -r");
-  pos += sprintf(& args[pos], " -a %s", options->backend_name_bandwidth);
-  for(int i=0; i < options->verbosity; i++){
-    pos += sprintf(& args[pos], " -v");
-  }
-  pos += sprintf(& args[pos], " -O stoneWallingWearOutIterations=%zu", create_read->results->pairs_accessed);
+  IOR_param_t params;
+  io500_ior_init(& params, "ior_easy/file", options);
+  params.readFile = TRUE;
+  params.stoneWallingWearOutIterations = create_read->results->pairs_accessed;
   if (options->stonewall_timer_reads){
-    pos += sprintf(& args[pos], " -D %d -O stoneWallingWearOut=1", options->stonewall_timer);
+    io500_ior_stonewall(& params, options);
   }
 
-  io500_replace_str(args); // make sure workdirs with space works
-  pos += sprintf(& args[pos], "\n-o\n%s/ior_easy/file", options->workdir);
-  pos += sprintf(& args[pos], "\n%s", options->ior_easy_options);
+  return io500_run_ior_really(& params, options->ior_easy_options, "ior_easy_read", 1, options);
+}
+
+// parameters shared by the mdtest phases, the equivalent of "mdtest -F -d
+// WORKDIR/NAME" with the path stored in dir
+static void io500_mdtest_init(mdtest_options_t * o, char * dir, const char * name, io500_options_t * options){
+  mdtest_init_options(o);
+  o->backend_name = options->backend_name_metadata;
+  o->verbose = options->verbosity;
+  o->files_only = 1;
+  sprintf(dir, "%s/%s", options->workdir, name);
+  o->dirpath = dir;
+}
 
-  return io500_run_ior_really(args, "ior_easy_read", 1, options);
+// the phase of mode: C(reate), E (read), T (stat) or r(emove) with -n maxfiles
+static void io500_mdtest_mode(mdtest_options_t * o, char mode, int maxfiles, int use_stonewall, io500_options_t * options){
+  switch(mode){
+    case 'C': o->create_only = 1; break;
+    case 'E': o->read_only = 1; break;
+    case 'T': o->stat_only = 1; break;
+    case 'r': o->remove_only = 1; break;
+  }
+  o->items = maxfiles;
+  o->measure_latency = 1;
+  if(use_stonewall){
+    o->stone_wall_timer_seconds = options->stonewall_timer;
+  }
 }
 
-static mdtest_results_t * io500_run_mdtest_really(char * args, char * suffix, int testID, io500_options_t * options){
+// runs mdtest with the options o, ctx is set to the context of the run, the
+// one of a previous run is freed
+static mdtest_results_t * io500_run_mdtest_really(mdtest_options_t * o, const char * extra, char * suffix, int testID, io500_options_t * options, mdtest_ctx_t ** ctx){
   int argc_count;
   char ** args_array;
   mdtest_results_t * table;
   FILE * out;
 
-  if(io500_rank == 0){
+  if(options->rank == 0){
     printf("\n[Starting] %s: %s", suffix, CurrentTimeString());
     fprintf(options->output, "\n[Starting] %s: %s", suffix, CurrentTimeString());
     fflush(options->output);
   }
 
-  args_array = io500_str_to_arr_prep_exec(args, & argc_count);
   out = io500_prepare_out(suffix, testID, options);
-  table = mdtest_run(argc_count, args_array, MPI_COMM_WORLD, out);
+  args_array = io500_str_to_argv("mdtest", extra, & argc_count);
+  mdtest_parse_options(o, argc_count, args_array, options->comm, out);
+
+  if(*ctx != NULL){
+    mdtest_free(*ctx);
+  }
+  *ctx = mdtest_init(o, options->comm, out);
+  table = mdtest_run_ctx(*ctx);
   fclose(out);
+  // the options point into the arguments until the run returns
+  free(args_array[0]);
   free(args_array);
   return table;
 }
 
-mdtest_results_t * io500_run_mdtest_easy(char mode, int maxfiles, int use_stonewall, const char * extra, char * suffix, int testID, io500_options_t * options){
-  char args[10000];
-  memset(args, 0, 10000);
+mdtest_results_t * io500_run_mdtest_easy(char mode, int maxfiles, int use_stonewall, char * suffix, int testID, io500_options_t * options, mdtest_ctx_t ** ctx){
+  mdtest_options_t o;
+  char dir[4096];
+  char rate_series[4096];
   if(maxfiles == 0){
     io500_error("Error, mdtest does not support 0 files.");
   }
 
-  int pos;
-  pos = sprintf(args, MDTEST_EASY_OPTIONS" -%c", mode);
-  pos += sprintf(& args[pos], " -a %s", options->backend_name_metadata);
-  pos += sprintf(& args[pos], " -n %d", maxfiles);
-  if(use_stonewall){
-    pos += sprintf(& args[pos], " -W %d", options->stonewall_timer);
-  }
-  for(int i=0; i < options->verbosity; i++){
-    pos += sprintf(& args[pos], " -v");
-  }
-  pos += sprintf(& args[pos], "%s", extra);
-  io500_replace_str(args);
-  pos += sprintf(& args[pos], "\n-d\n%s/mdtest_easy", options->workdir);
-  pos += sprintf(& args[pos], "\n%s", options->mdtest_easy_options);
+  io500_mdtest_init(& o, dir, "mdtest_easy", options);
+  io500_mdtest_mode(& o, mode, maxfiles, use_stonewall, options);
+  sprintf(rate_series, "%s/%s", options->results_dir, suffix);
+  o.rate_series_prefix = rate_series;
 
-  return io500_run_mdtest_really(args, suffix, testID, options);
+  return io500_run_mdtest_really(& o, options->mdtest_easy_options, suffix, testID, options, ctx);
 }
 
-mdtest_results_t * io500_md_easy_create(io500_options_t * options){
-  mdtest_results_t * res = io500_run_mdtest_easy('C', options->mdeasy_max_files, 1, "", "mdtest_easy_create", 1, options);
+mdtest_results_t * io500_md_easy_create(io500_options_t * options, mdtest_ctx_t ** ctx){
+  mdtest_results_t * res = io500_run_mdtest_easy('C', options->mdeasy_max_files, 1, "mdtest_easy_create", 1, options, ctx);
   if(res->items == 0){
     io500_error("Stonewalling returned 0 created files, that is wrong.");
   }
   return res;
 }
 
-mdtest_results_t * io500_md_easy_read(io500_options_t * options, mdtest_results_t * create_read){
-  return io500_run_mdtest_easy('E', create_read->stonewall_last_item[MDTEST_FILE_CREATE_NUM], options->stonewall_timer_reads, "", "mdtest_easy_read", 1, options);
+mdtest_results_t * io500_md_easy_read(io500_options_t * options, mdtest_results_t * create_read, mdtest_ctx_t ** ctx){
+  return io500_run_mdtest_easy('E', create_read->stonewall_last_item[MDTEST_FILE_CREATE_NUM], options->stonewall_timer_reads, "mdtest_easy_read", 1, options, ctx);
 }
 
-mdtest_results_t * io500_md_easy_stat(io500_options_t * options, mdtest_results_t * create_read){
-  return io500_run_mdtest_easy('T', create_read->stonewall_last_item[MDTEST_FILE_CREATE_NUM], options->stonewall_timer_reads, "", "mdtest_easy_stat", 1, options);
+mdtest_results_t * io500_md_easy_stat(io500_options_t * options, mdtest_results_t * create_read, mdtest_ctx_t ** ctx){
+  return io500_run_mdtest_easy('T', create_read->stonewall_last_item[MDTEST_FILE_CREATE_NUM], options->stonewall_timer_reads, "mdtest_easy_stat", 1, options, ctx);
 }
 
 
-mdtest_results_t * io500_md_easy_delete(io500_options_t * options, mdtest_results_t * create_read){
-  return io500_run_mdtest_easy('r', create_read->stonewall_last_item[MDTEST_FILE_CREATE_NUM], options->stonewall_timer_delete, "", "mdtest_easy_delete", 1, options);
+mdtest_results_t * io500_md_easy_delete(io500_options_t * options, mdtest_results_t * create_read, mdtest_ctx_t ** ctx){
+  return io500_run_mdtest_easy('r', create_read->stonewall_last_item[MDTEST_FILE_CREATE_NUM], options->stonewall_timer_delete, "mdtest_easy_delete", 1, options, ctx);
 }
 
 
-mdtest_results_t * io500_run_mdtest_hard(char mode, int maxfiles, int use_stonewall, const char * extra,  char * suffix, int testID, io500_options_t * options){
-  char args[10000];
-  int pos;
-  pos = sprintf(args, MDTEST_HARD_OPTIONS" -%c", mode);
-  pos += sprintf(& args[pos], " -a %s", options->backend_name_metadata);
-  pos += sprintf(& args[pos], " -n %d", maxfiles);
-  if(use_stonewall){
-    pos += sprintf(& args[pos], " -W %d", options->stonewall_timer);
-  }
-  for(int i=0; i < options->verbosity; i++){
-    pos += sprintf(& args[pos], " -v");
-  }
-  pos += sprintf(& args[pos], "%s", extra);
-  io500_replace_str(args);
-  pos += sprintf(& args[pos], "\n-d\n%s/mdtest_hard", options->workdir);
+// "mdtest -w 3900 -e 3900 -t -F"
+mdtest_results_t * io500_run_mdtest_hard(char mode, int maxfiles, int use_stonewall, char * suffix, int testID, io500_options_t * options, mdtest_ctx_t ** ctx){
+  mdtest_options_t o;
+  char dir[4096];
+  char rate_series[4096];
 
-  return io500_run_mdtest_really(args, suffix, testID, options);
+  io500_mdtest_init(& o, dir, "mdtest_hard", options);
+  io500_mdtest_mode(& o, mode, maxfiles, use_stonewall, options);
+  o.write_bytes = 3900;
+  o.read_bytes = 3900;
+  o.time_unique_dir_overhead = 1;
+  sprintf(rate_series, "%s/%s", options->results_dir, suffix);
+  o.rate_series_prefix = rate_series;
+
+  return io500_run_mdtest_really(& o, "", suffix, testID, options, ctx);
 }
 
-mdtest_results_t * io500_md_hard_create(io500_options_t * options){
-  mdtest_results_t * res = io500_run_mdtest_hard('C', options->mdhard_max_files, 1, "", "mdtest_hard_create", 1, options);
+mdtest_results_t * io500_md_hard_create(io500_options_t * options, mdtest_ctx_t ** ctx){
+  mdtest_results_t * res = io500_run_mdtest_hard('C', options->mdhard_max_files, 1, "mdtest_hard_create", 1, options, ctx);
   if(res->items == 0){
     io500_error("Stonewalling returned 0 created files, that is wrong.");
   }
   return res;
 }
 
-mdtest_results_t * io500_md_hard_read(io500_options_t * options, mdtest_results_t * create_read){
-  return io500_run_mdtest_hard('E', create_read->stonewall_last_item[MDTEST_FILE_CREATE_NUM], options->stonewall_timer_reads, "","mdtest_hard_read", 1, options);
+mdtest_results_t * io500_md_hard_read(io500_options_t * options, mdtest_results_t * create_read, mdtest_ctx_t ** ctx){
+  return io500_run_mdtest_hard('E', create_read->stonewall_last_item[MDTEST_FILE_CREATE_NUM], options->stonewall_timer_reads, "mdtest_hard_read", 1, options, ctx);
+}
+
+mdtest_results_t * io500_md_hard_stat(io500_options_t * options, mdtest_results_t * create_read, mdtest_ctx_t ** ctx){
+  return io500_run_mdtest_hard('T', create_read->stonewall_last_item[MDTEST_FILE_CREATE_NUM], options->stonewall_timer_reads, "mdtest_hard_stat", 1, options, ctx);
 }
 
-mdtest_results_t * io500_md_hard_stat(io500_options_t * options, mdtest_results_t * create_read){
-  return io500_run_mdtest_hard('T', create_read->stonewall_last_item[MDTEST_FILE_CREATE_NUM], options->stonewall_timer_reads, "","mdtest_hard_stat", 1, options);
+mdtest_results_t * io500_md_hard_delete(io500_options_t * options, mdtest_results_t * create_read, mdtest_ctx_t ** ctx){
+  return io500_run_mdtest_hard('r', create_read->stonewall_last_item[MDTEST_FILE_CREATE_NUM], options->stonewall_timer_delete, "mdtest_hard_delete", 1, options, ctx);
 }
 
-mdtest_results_t * io500_md_hard_delete(io500_options_t * options, mdtest_results_t * create_read){
-  return io500_run_mdtest_hard('r', create_read->stonewall_last_item[MDTEST_FILE_CREATE_NUM], options->stonewall_timer_delete, "", "mdtest_hard_delete", 1, options);
+// "mdtest -w 3900 -e 3900 -F -X -O mixedWorkingSet=N,latency=1"
+mdtest_results_t * io500_md_mixed(io500_options_t * options, mdtest_ctx_t ** ctx){
+  mdtest_options_t o;
+  char dir[4096];
+
+  io500_mdtest_init(& o, dir, "mdtest_mixed", options);
+  o.write_bytes = 3900;
+  o.read_bytes = 3900;
+  o.mixed_workload = 1;
+  o.mixed_working_set = options->mdmixed_working_set;
+  o.measure_latency = 1;
+  o.stone_wall_timer_seconds = options->stonewall_timer;
+
+  return io500_run_mdtest_really(& o, "", "mdtest_mixed", 1, options, ctx);
 }
 
 void io500_touch(char * const filename){
@@ -240,11 +276,17 @@ void io500_cleanup(io500_options_t* options){
     fprintf(options->output,"\nCleaning files from working directory: %s", CurrentTimeString());
     fflush(options->output);
   }
-  io500_parallel_find_or_delete(stdout, options->workdir, NULL, 1, 0);
+  double start = GetTimeStamp();
+  io500_find_results_t * res = io500_parallel_find_or_delete(stdout, options->backend_name_metadata, options->workdir, NULL, 1, 0, options->find_threads);
+  double runtime = GetTimeStamp() - start;
+
+  long long counts[3] = {res->deleted_files, res->deleted_dirs, res->errors};
+  MPI_Reduce(io500_rank == 0 ? MPI_IN_PLACE : counts, counts, 3, MPI_LONG_LONG_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(io500_rank == 0 ? MPI_IN_PLACE : & runtime, & runtime, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+  free(res);
   if(io500_rank == 0){
+    fprintf(options->output, "[Result] cleanup rate: %.3f kiops time: %.1fs err: %lld files: %lld dirs: %lld\n", (counts[0] + counts[1]) / runtime / 1000, runtime, counts[2], counts[0], counts[1]);
     fprintf(options->output, "Done: %s", CurrentTimeString());
-    fprintf(options->output, "  If you want to use the same directory with different numbers of ranks,\n"
-           "  remove the directory structure with rm -r, too\n");
     fflush(options->output);
   }
 }
@@ -275,12 +317,17 @@ void io500_recursively_create(const char * dir, int touch){
 }
 
 int io500_contains_workdir_tag(io500_options_t * options){
-    char fname[4096];
-    sprintf(fname, "%s/IO500-testfile", options->workdir);
-    int fd = open(fname, O_RDONLY);
-    int ret = (fd != -1);
-    close(fd);
-    return ret;
+    int ret = 0;
+    if(io500_rank == 0){
+      char fname[4096];
+      sprintf(fname, "%s/IO500-testfile", options->workdir);
+      int fd = open(fname, O_RDONLY);
+      ret = (fd != -1);
+      if(ret){
+        close(fd);
+      }
+    }
+    return io500_bcast_probe(ret, NULL, 0);
 }
 
 void io500_create_workdir(io500_options_t * options){
@@ -298,6 +345,10 @@ void io500_create_workdir(io500_options_t * options){
   io500_recursively_create(dir, 1);
   sprintf(dir, "%s/mdtest_hard/", options->workdir);
   io500_recursively_create(dir, 1);
+  if(options->run_mdtest_mixed){
+    sprintf(dir, "%s/mdtest_mixed/", options->workdir);
+    io500_recursively_create(dir, 1);
+  }
 
   sprintf(dir, "%s/IO500-testfile", options->workdir);
   io500_touch(dir);
@@ -330,6 +381,10 @@ void io500_print_md(FILE * out, const char * prefix, int id, mdtest_test_num_t p
     fprintf(out, " (perf at stonewall min: %.1f kiops avg: %.1f kiops)", stat->stonewall_item_min[pos] / 1000.0 / stat->stonewall_time[pos],
     stat->stonewall_item_sum[pos] / 1000.0 / stat->stonewall_time[pos]);
   }
+  mdtest_latency_t * lat = & stat->latency[pos];
+  if(lat->ops != 0){
+    fprintf(out, " latency p50: %.3fms p99: %.3fms p99.9: %.3fms max: %.3fms", lat->p50 * 1e3, lat->p99 * 1e3, lat->p999 * 1e3, lat->max * 1e3);
+  }
   fprintf(out, "\n");
   fflush(out);
 }
@@ -339,6 +394,29 @@ void io500_print_find(FILE * out, const char * prefix, io500_find_results_t * fi
     fflush(out);
 }
 
+static void io500_print_find_dist(FILE * out, const char * name, const char * fmt, io500_find_dist_t * dist){
+    char line[256];
+    snprintf(line, sizeof(line), "  %%-16s min: %s median: %s max: %s\n", fmt, fmt, fmt);
+    fprintf(out, line, name, dist->min, dist->median, dist->max);
+}
+
+void io500_print_find_balance(FILE * out, const char * prefix, io500_find_results_t * find){
+    fprintf(out, "[Balance] %s per process\n", prefix);
+    io500_print_find_dist(out, "dirs read", "%.0f", & find->dist_dirs);
+    io500_print_find_dist(out, "entries scanned", "%.0f", & find->dist_entries);
+    io500_print_find_dist(out, "stats issued", "%.0f", & find->dist_stats);
+    io500_print_find_dist(out, "items received", "%.0f", & find->dist_received);
+    io500_print_find_dist(out, "bytes received", "%.0f", & find->dist_bytes);
+    io500_print_find_dist(out, "idle time (s)", "%.3f", & find->dist_idle);
+    fflush(out);
+}
+
+static char * proc_names = NULL;
+
+char * io500_proc_names(void){
+  return proc_names;
+}
+
 void io500_print_startup(int argc, char ** argv, io500_options_t * options){
   int size;
   MPI_Comm_size(MPI_COMM_WORLD, & size);
@@ -376,12 +454,12 @@ void io500_print_startup(int argc, char ** argv, io500_options_t * options){
     char * curP = procNames;
     fprintf(options->output, "%d:%s", 0, curP);
     for(int i=1; i < size; i++){
-      fprintf(options->output, ",%d:%s", i, curP);
       curP += MPI_MAX_PROCESSOR_NAME;
+      fprintf(options->output, ",%d:%s", i, curP);
     }
     fprintf(options->output, "\n");
     free(procName);
-    free(procNames);
+    proc_names = procNames;
   }
   fflush(options->output);
 }
@@ -7,6 +7,9 @@
 #include "io500-types.h"
 
 void io500_print_startup(int argc, char ** argv, io500_options_t * options);
+// host names of all ranks gathered by io500_print_startup(), MPI_MAX_PROCESSOR_NAME
+// bytes per rank, valid on rank 0 only and NULL with 1000 or more processes
+char * io500_proc_names(void);
 
 
 IOR_test_t * io500_io_hard_create(io500_options_t * options);
@@ -14,21 +17,26 @@ IOR_test_t * io500_io_hard_read(io500_options_t * options, IOR_test_t * create_r
 IOR_test_t * io500_io_easy_create(io500_options_t * options);
 IOR_test_t * io500_io_easy_read(io500_options_t * options, IOR_test_t * create_read);
 
-mdtest_results_t * io500_run_mdtest_easy(char mode, int maxfiles, int use_stonewall, const char * extra, char * suffix, int testID, io500_options_t * options);
+// the mdtest phases store the context of their run in *ctx, the one of an earlier run is freed
+mdtest_results_t * io500_run_mdtest_easy(char mode, int maxfiles, int use_stonewall, char * suffix, int testID, io500_options_t * options, mdtest_ctx_t ** ctx);
 
-mdtest_results_t * io500_md_easy_create(io500_options_t * options);
-mdtest_results_t * io500_md_easy_read(io500_options_t * options, mdtest_results_t * create_read);
-mdtest_results_t * io500_md_easy_stat(io500_options_t * options, mdtest_results_t * create_read);
-mdtest_results_t * io500_md_easy_delete(io500_options_t * options, mdtest_results_t * create_read);
+mdtest_results_t * io500_md_easy_create(io500_options_t * options, mdtest_ctx_t ** ctx);
+mdtest_results_t * io500_md_easy_read(io500_options_t * options, mdtest_results_t * create_read, mdtest_ctx_t ** ctx);
+mdtest_results_t * io500_md_easy_stat(io500_options_t * options, mdtest_results_t * create_read, mdtest_ctx_t ** ctx);
+mdtest_results_t * io500_md_easy_delete(io500_options_t * options, mdtest_results_t * create_read, mdtest_ctx_t ** ctx);
 
-mdtest_results_t * io500_run_mdtest_hard(char mode, int maxfiles, int use_stonewall, const char * extra,  char * suffix, int testID, io500_options_t * options);
-mdtest_results_t * io500_md_hard_create(io500_options_t * options);
-mdtest_results_t * io500_md_hard_read(io500_options_t * options, mdtest_results_t * create_read);
-mdtest_results_t * io500_md_hard_stat(io500_options_t * options, mdtest_results_t * create_read);
-mdtest_results_t * io500_md_hard_delete(io500_options_t * options, mdtest_results_t * create_read);
+mdtest_results_t * io500_run_mdtest_hard(char mode, int maxfiles, int use_stonewall, char * suffix, int testID, io500_options_t * options, mdtest_ctx_t ** ctx);
+mdtest_results_t * io500_md_hard_create(io500_options_t * options, mdtest_ctx_t ** ctx);
+mdtest_results_t * io500_md_hard_read(io500_options_t * options, mdtest_results_t * create_read, mdtest_ctx_t ** ctx);
+mdtest_results_t * io500_md_hard_stat(io500_options_t * options, mdtest_results_t * create_read, mdtest_ctx_t ** ctx);
+mdtest_results_t * io500_md_hard_delete(io500_options_t * options, mdtest_results_t * create_read, mdtest_ctx_t ** ctx);
+
+mdtest_results_t * io500_md_mixed(io500_options_t * options, mdtest_ctx_t ** ctx);
 
 io500_find_results_t * io500_find(io500_options_t * opt);
 io500_find_results_t * io500_find_hard(io500_options_t * opt);
+// parallel find or delete, uses the AIORI backend api for all metadata operations
+io500_find_results_t * io500_parallel_find_or_delete(FILE * out, const char * api, char * workdir, const char * expression, int delete, int stonewall_timer_s, int threads);
 
 
 
@@ -38,12 +46,12 @@ void io500_create_workdir(io500_options_t * options);
 int  io500_contains_workdir_tag(io500_options_t * options);
 void io500_recursively_create(const char * dir, int touch);
 
-io500_find_results_t * io500_parallel_find_or_delete(FILE * out, char * workdir, char * const filename_pattern, int delete, int stonewall_timer_s);
 ///////////////////////////////////
 
 void io500_cleanup(io500_options_t* options);
 
 void io500_print_find(FILE * out, const char * prefix, io500_find_results_t * find);
+void io500_print_find_balance(FILE * out, const char * prefix, io500_find_results_t * find);
 void io500_print_bw(FILE * out, const char * prefix, int id, IOR_test_t * stat, int read);
 void io500_print_md(FILE * out, const char * prefix, int id, mdtest_test_num_t pos, mdtest_results_t * stat);
 
@@ -0,0 +1,413 @@
+/*
+ * License: MIT license
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include <utilities.h>
+
+#include "io500-json.h"
+#include "io500-functions.h"
+#include "io500-utils.h"
+#include "io500-score.h"
+
+#define IO500_JSON_FILE "IO500-result.json"
+
+// names of the mdtest operations, indexed by mdtest_test_num_t and the latency steps
+static const char * md_op_names[MDTEST_LATENCY_LAST_NUM] = {
+  "dir_create", "dir_stat", "", "dir_remove",
+  "file_create", "file_stat", "file_read", "file_remove",
+  "tree_create", "tree_remove",
+  "mixed_create", "mixed_stat", "mixed_read", "mixed_remove",
+  "dir_list", "file_list",
+  "file_create_open", "file_create_write", "file_create_close"
+};
+
+static char json_fname[4096];
+static io500_options_t * options;
+static char * results_dir;
+static char * head = NULL;     // configuration and rank map
+static size_t head_len = 0;
+static char * records = NULL;  // the phase objects, separated by commas
+static size_t records_len = 0;
+static FILE * records_out = NULL;
+static int record_count = 0;
+
+static void json_str(FILE * f, const char * str){
+  fputc('"', f);
+  for(const char * c = str ? str : ""; *c; c++){
+    switch(*c){
+      case '"':  fputs("\\\"", f); break;
+      case '\\': fputs("\\\\", f); break;
+      case '\n': fputs("\\n", f); break;
+      case '\t': fputs("\\t", f); break;
+      default:
+        if((unsigned char) *c < 0x20){
+          fprintf(f, "\\u%04x", *c);
+        }else{
+          fputc(*c, f);
+        }
+    }
+  }
+  fputc('"', f);
+}
+
+// JSON has no representation for inf and nan
+static void json_num(FILE * f, double val){
+  if(isfinite(val)){
+    fprintf(f, "%.17g", val);
+  }else{
+    fprintf(f, "null");
+  }
+}
+
+// the IOR options are stored one argument per line
+static void json_args(FILE * f, const char * args){
+  char * copy = strdup(args);
+  for(char * c = copy; *c; c++){
+    if(*c == '\n'){
+      *c = ' ';
+    }
+  }
+  json_str(f, copy);
+  free(copy);
+}
+
+static void json_time(FILE * f){
+  char now[64];
+  snprintf(now, sizeof(now), "%s", CurrentTimeString());
+  now[strcspn(now, "\n")] = 0;
+  json_str(f, now);
+}
+
+static io500_score_t * final_score = NULL;
+
+static void json_write(int complete){
+  char tmp[4096 + 8];
+  sprintf(tmp, "%s.tmp", json_fname);
+  FILE * f = fopen(tmp, "w");
+  if(f == NULL){
+    printf("Could not write %s\n", tmp);
+    return;
+  }
+  fflush(records_out);
+  fwrite(head, 1, head_len, f);
+  fprintf(f, "  \"phases\": [");
+  fwrite(records, 1, records_len, f);
+  fprintf(f, "\n  ],\n");
+  if(final_score){
+    fprintf(f, "  \"score\": {\"bw\": ");
+    json_num(f, final_score->bw);
+    fprintf(f, ", \"md\": ");
+    json_num(f, final_score->md);
+    fprintf(f, ", \"total\": ");
+    json_num(f, final_score->total);
+    fprintf(f, ", \"complete\": %s, \"valid\": %s},\n", final_score->complete ? "true" : "false", final_score->valid ? "true" : "false");
+  }
+  fprintf(f, "  \"complete\": %s,\n  \"updated\": ", complete ? "true" : "false");
+  json_time(f);
+  fprintf(f, "\n}\n");
+  fclose(f);
+  if(rename(tmp, json_fname) != 0){
+    printf("Could not rename %s\n", tmp);
+  }
+}
+
+void io500_json_begin(io500_options_t * o){
+  int size;
+  MPI_Comm_size(MPI_COMM_WORLD, & size);
+  options = o;
+  results_dir = o->results_dir;
+  sprintf(json_fname, "%s/%s", o->results_dir, IO500_JSON_FILE);
+
+  FILE * f = open_memstream(& head, & head_len);
+  fprintf(f, "{\n  \"version\": 1,\n  \"start\": ");
+  json_time(f);
+  fprintf(f, ",\n  \"config\": {\n    \"workdir\": ");
+  json_str(f, o->workdir);
+  fprintf(f, ",\n    \"results_dir\": ");
+  json_str(f, o->results_dir);
+  fprintf(f, ",\n    \"api_bandwidth\": ");
+  json_str(f, o->backend_name_bandwidth);
+  fprintf(f, ",\n    \"api_metadata\": ");
+  json_str(f, o->backend_name_metadata);
+  fprintf(f, ",\n    \"ior_easy_options\": ");
+  json_args(f, o->ior_easy_options);
+  fprintf(f, ",\n    \"ior_hard_options\": ");
+  json_args(f, o->ior_hard_options);
+  fprintf(f, ",\n    \"iorhard_max_segments\": %d", o->iorhard_max_segments);
+  fprintf(f, ",\n    \"mdeasy_max_files\": %d", o->mdeasy_max_files);
+  fprintf(f, ",\n    \"mdhard_max_files\": %d", o->mdhard_max_files);
+  fprintf(f, ",\n    \"mdmixed_working_set\": %d", o->mdmixed_working_set);
+  fprintf(f, ",\n    \"stonewall_timer\": %d", o->stonewall_timer);
+  fprintf(f, ",\n    \"stonewall_timer_reads\": %d", o->stonewall_timer_reads);
+  fprintf(f, ",\n    \"stonewall_timer_delete\": %d", o->stonewall_timer_delete);
+  fprintf(f, ",\n    \"find_expression\": ");
+  if(o->find_expression){
+    json_str(f, o->find_expression);
+  }else{
+    fprintf(f, "null");
+  }
+  fprintf(f, ",\n    \"find_threads\": %d", o->find_threads);
+  fprintf(f, ",\n    \"find_dont_sync\": %d", o->find_dont_sync);
+  fprintf(f, ",\n    \"phases\": ");
+  if(o->phases){
+    json_str(f, o->phases);
+  }else{
+    fprintf(f, "null");
+  }
+  fprintf(f, ",\n    \"skip_phases\": ");
+  if(o->skip_phases){
+    json_str(f, o->skip_phases);
+  }else{
+    fprintf(f, "null");
+  }
+  fprintf(f, ",\n    \"resume\": %d\n  },\n", o->resume);
+
+  // ranks grouped by host, in the order of the first rank of each host
+  fprintf(f, "  \"nproc\": %d,\n  \"rank_map\": ", size);
+  char * names = io500_proc_names();
+  if(names == NULL){
+    fprintf(f, "null,\n");
+  }else{
+    int * host = malloc(sizeof(int) * size);
+    int first = 1;
+    fprintf(f, "[");
+    for(int i=0; i < size; i++){
+      host[i] = i;
+      for(int j=0; j < i; j++){
+        if(strcmp(names + j * MPI_MAX_PROCESSOR_NAME, names + i * MPI_MAX_PROCESSOR_NAME) == 0){
+          host[i] = host[j];
+          break;
+        }
+      }
+      if(host[i] != i){
+        continue;
+      }
+      fprintf(f, "%s\n    {\"host\": ", first ? "" : ",");
+      json_str(f, names + i * MPI_MAX_PROCESSOR_NAME);
+      fprintf(f, ", \"ranks\": [%d", i);
+      for(int j=i+1; j < size; j++){
+        if(strcmp(names + j * MPI_MAX_PROCESSOR_NAME, names + i * MPI_MAX_PROCESSOR_NAME) == 0){
+          fprintf(f, ", %d", j);
+        }
+      }
+      fprintf(f, "]}");
+      first = 0;
+    }
+    fprintf(f, "\n  ],\n");
+    free(host);
+  }
+  fclose(f);
+
+  records_out = open_memstream(& records, & records_len);
+  record_count = 0;
+  json_write(0);
+}
+
+// embed the rate series mdtest wrote for the operation of a phase
+static void json_series(FILE * f, const char * phase, const char * op){
+  char fname[8192];
+  char line[1024];
+  sprintf(fname, "%s/%s-%s.0.csv", results_dir, phase, op);
+  FILE * csv = fopen(fname, "r");
+  if(csv == NULL){
+    return;
+  }
+  int first = 1;
+  fprintf(f, ",\n        \"series\": [");
+  while(fgets(line, sizeof(line), csv) != NULL){
+    double t, rate;
+    unsigned long long items, entries;
+    if(sscanf(line, "%lf,%llu,%lf,%llu", & t, & items, & rate, & entries) != 4){
+      continue; // comment and header
+    }
+    fprintf(f, "%s\n          {\"time\": ", first ? "" : ",");
+    json_num(f, t);
+    fprintf(f, ", \"items\": %llu, \"rate\": ", items);
+    json_num(f, rate);
+    fprintf(f, ", \"dir_entries\": %llu}", entries);
+    first = 0;
+  }
+  fprintf(f, "\n        ]");
+  fclose(csv);
+}
+
+static void json_md_op(FILE * f, io500_phase_t * p, int pos, int resumed, int first){
+  mdtest_results_t * r = p->md;
+  fprintf(f, "%s\n      {\"op\": ", first ? "" : ",");
+  json_str(f, md_op_names[pos]);
+  fprintf(f, ", \"rate\": ");
+  json_num(f, r->rate[pos]);
+  fprintf(f, ", \"time\": ");
+  json_num(f, r->time[pos]);
+  fprintf(f, ", \"items\": %"PRIu64, r->items[pos]);
+  if(r->bytes[pos] != 0){
+    fprintf(f, ", \"bytes\": %"PRIu64, r->bytes[pos]);
+  }
+  if(r->stonewall_last_item[pos] != 0){
+    fprintf(f, ", \"stonewall_last_item\": %"PRIu64, r->stonewall_last_item[pos]);
+  }
+  if(r->stonewall_item_sum[pos] != 0){
+    fprintf(f, ",\n        \"stonewall\": {\"time\": ");
+    json_num(f, r->stonewall_time[pos]);
+    fprintf(f, ", \"items_min\": %"PRIu64", \"items_sum\": %"PRIu64", \"rate_min\": ",
+      r->stonewall_item_min[pos], r->stonewall_item_sum[pos]);
+    json_num(f, r->stonewall_item_min[pos] / r->stonewall_time[pos]);
+    fprintf(f, ", \"rate_sum\": ");
+    json_num(f, r->stonewall_item_sum[pos] / r->stonewall_time[pos]);
+    fprintf(f, "}");
+  }
+  if(! resumed){
+    json_series(f, p->name, md_op_names[pos]);
+  }
+  fprintf(f, "}");
+}
+
+static void json_md_latency(FILE * f, io500_phase_t * p, int resumed){
+  static double limit[MDTEST_LATENCY_BUCKETS];
+  static uint64_t count[MDTEST_LATENCY_BUCKETS];
+  int first = 1;
+  fprintf(f, ",\n    \"latency\": [");
+  for(int i=0; i < MDTEST_LATENCY_LAST_NUM; i++){
+    mdtest_latency_t * l = & p->md->latency[i];
+    if(l->ops == 0){
+      continue;
+    }
+    fprintf(f, "%s\n      {\"op\": ", first ? "" : ",");
+    json_str(f, md_op_names[i]);
+    fprintf(f, ", \"ops\": %"PRIu64", \"p50\": ", l->ops);
+    json_num(f, l->p50);
+    fprintf(f, ", \"p99\": ");
+    json_num(f, l->p99);
+    fprintf(f, ", \"p999\": ");
+    json_num(f, l->p999);
+    fprintf(f, ", \"max\": ");
+    json_num(f, l->max);
+    // the histogram is kept in the context of the run on this process, a
+    // concurrent phase may have run on other processes
+    if(! resumed && p->md_ctx != NULL){
+      int n = mdtest_latency_histogram(p->md_ctx, i, limit, count, MDTEST_LATENCY_BUCKETS);
+      fprintf(f, ",\n        \"histogram\": [");
+      for(int b=0; b < n; b++){
+        fprintf(f, "%s[", b ? ", " : "");
+        json_num(f, limit[b]);
+        fprintf(f, ", %"PRIu64"]", count[b]);
+      }
+      fprintf(f, "]");
+    }
+    fprintf(f, "}");
+    first = 0;
+  }
+  fprintf(f, "\n    ]");
+}
+
+static void json_dist(FILE * f, const char * name, io500_find_dist_t * d, int first){
+  fprintf(f, "%s\n      ", first ? "" : ",");
+  json_str(f, name);
+  fprintf(f, ": {\"min\": ");
+  json_num(f, d->min);
+  fprintf(f, ", \"median\": ");
+  json_num(f, d->median);
+  fprintf(f, ", \"max\": ");
+  json_num(f, d->max);
+  fprintf(f, "}");
+}
+
+void io500_json_phase(io500_phase_t * p, int resumed){
+  if(p->kind == IO500_PHASE_NONE){
+    return;
+  }
+  FILE * f = records_out;
+  fprintf(f, "%s\n   {\"name\": ", record_count ? "," : "");
+  json_str(f, p->name);
+  fprintf(f, ", \"id\": %d, \"run\": %d, \"resumed\": %s, \"end\": ", p->id, p->runs, resumed ? "true" : "false");
+  json_time(f);
+  if(p->concurrent){
+    fprintf(f, ", \"concurrent\": ");
+    json_str(f, p->concurrent);
+  }
+  char reason[256];
+  if(io500_phase_invalid(p, options, reason, sizeof(reason))){
+    fprintf(f, ", \"valid\": false, \"invalid_reason\": ");
+    json_str(f, reason);
+  }else{
+    fprintf(f, ", \"valid\": true");
+  }
+
+  switch(p->kind){
+    case IO500_PHASE_IOR:{
+      IOR_results_t * r = p->ior->results;
+      double time = p->read ? r->readTime[0] : r->writeTime[0];
+      double gib = r->aggFileSizeFromXfer[0] / 1024.0 / 1024.0 / 1024.0;
+      fprintf(f, ",\n    \"type\": \"ior\", \"bw\": ");
+      json_num(f, gib / time);
+      fprintf(f, ", \"time\": ");
+      json_num(f, time);
+      fprintf(f, ", \"size\": ");
+      json_num(f, gib);
+      fprintf(f, ", \"pairs_accessed\": %zu", r->pairs_accessed);
+      if(r->stonewall_min_data_accessed != 0){
+        fprintf(f, ",\n    \"stonewall\": {\"time\": ");
+        json_num(f, r->stonewall_time);
+        fprintf(f, ", \"bw_min\": ");
+        json_num(f, r->stonewall_min_data_accessed / r->stonewall_time / 1024.0 / 1024.0 / 1024.0);
+        fprintf(f, ", \"bw_avg\": ");
+        json_num(f, r->stonewall_avg_data_accessed / r->stonewall_time / 1024.0 / 1024.0 / 1024.0);
+        fprintf(f, "}");
+      }
+      break;
+    }
+    case IO500_PHASE_MDTEST:
+    case IO500_PHASE_MIXED:{
+      fprintf(f, ",\n    \"type\": \"mdtest\", \"ops\": [");
+      if(p->kind == IO500_PHASE_MDTEST){
+        json_md_op(f, p, p->md_pos, resumed, 1);
+      }else{
+        for(int pos = MDTEST_MIXED_CREATE_NUM; pos <= MDTEST_MIXED_REMOVE_NUM; pos++){
+          json_md_op(f, p, pos, resumed, pos == MDTEST_MIXED_CREATE_NUM);
+        }
+      }
+      fprintf(f, "\n    ]");
+      json_md_latency(f, p, resumed);
+      break;
+    }
+    case IO500_PHASE_FIND:{
+      io500_find_results_t * r = p->find;
+      fprintf(f, ",\n    \"type\": \"find\", \"rate\": ");
+      json_num(f, r->rate);
+      fprintf(f, ", \"time\": ");
+      json_num(f, r->runtime);
+      fprintf(f, ", \"errors\": %"PRIu64", \"found\": %"PRIu64", \"scanned\": %"PRIu64, r->errors, r->found_files, r->total_files);
+      fprintf(f, ",\n    \"balance\": {");
+      json_dist(f, "dirs_read", & r->dist_dirs, 1);
+      json_dist(f, "entries_scanned", & r->dist_entries, 0);
+      json_dist(f, "stats_issued", & r->dist_stats, 0);
+      json_dist(f, "items_received", & r->dist_received, 0);
+      json_dist(f, "bytes_received", & r->dist_bytes, 0);
+      json_dist(f, "idle_time", & r->dist_idle, 0);
+      fprintf(f, "\n    }");
+      break;
+    }
+    case IO500_PHASE_NONE:
+      break;
+  }
+  fprintf(f, "}");
+  record_count++;
+  json_write(0);
+}
+
+void io500_json_end(io500_score_t * score){
+  final_score = score;
+  json_write(1);
+  final_score = NULL;
+  fclose(records_out);
+  free(records);
+  free(head);
+  records_out = NULL;
+  records = NULL;
+  head = NULL;
+}
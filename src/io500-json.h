@@ -0,0 +1,19 @@
+#ifndef _IO500_JSON_H
+#define _IO500_JSON_H
+
+#include "io500-types.h"
+#include "io500-phases.h"
+#include "io500-score.h"
+
+// The JSON result document IO500-result.json in the results directory is
+// rewritten after every phase, so it stays parseable if the run aborts.
+// Bandwidths are in GiB/s, rates in operations per second and times in
+// seconds. All functions are called by rank 0 only.
+void io500_json_begin(io500_options_t * options);
+// add the latest run of a phase, call it directly after the phase to include
+// the latency histograms of mdtest
+void io500_json_phase(io500_phase_t * phase, int resumed);
+// mark the document complete and add the score
+void io500_json_end(io500_score_t * score);
+
+#endif
@@ -3,6 +3,9 @@
 #include "io500-options.h"
 #include "io500-utils.h"
 #include "io500-functions.h"
+#include "io500-phases.h"
+#include "io500-score.h"
+#include "io500-json.h"
 
 #include "io500-types.h"
 
@@ -44,98 +47,43 @@ int main(int argc, char ** argv){
     exit(0);
   }
 
-  if(io500_contains_workdir_tag(options)){
-      if(io500_rank == 0){
-        fprintf(options->output, "Error, the working directory contains IO500-testfile already, so I will clean that directory for you before I start!");
-      }
-      io500_cleanup(options);
-  }
+  int official = io500_phases_schedule(options);
 
-  if(io500_rank == 0){
-    io500_create_workdir(options);
-  }
-  MPI_Barrier(MPI_COMM_WORLD);
-
-  IOR_test_t * io_easy_create = io500_io_easy_create(options);
-  if(io500_rank == 0) io500_print_bw(out, "ior_easy_write", 1, io_easy_create, 0);
-
-  mdtest_results_t *    md_easy_create = io500_md_easy_create(options);
-  if(io500_rank == 0) io500_print_md(out, "mdtest_easy_create", 1, MDTEST_FILE_CREATE_NUM, md_easy_create);
+  if(options->resume){
+    if(! io500_contains_workdir_tag(options)){
+      io500_error("Cannot resume, the working directory does not contain IO500-testfile");
+    }
+  }else{
+    if(io500_contains_workdir_tag(options)){
+        if(io500_rank == 0){
+          fprintf(options->output, "Error, the working directory contains IO500-testfile already, so I will clean that directory for you before I start!");
+        }
+        io500_cleanup(options);
+    }
 
-  {
-    char fname[4096];
-    sprintf(fname, "%s/IO500_TIMESTAMP", options->workdir);
-    io500_touch(fname);
+    if(io500_rank == 0){
+      io500_create_workdir(options);
+    }
   }
   MPI_Barrier(MPI_COMM_WORLD);
 
-  IOR_test_t * io_hard_create = io500_io_hard_create(options);
-  if(io500_rank == 0) io500_print_bw(out, "ior_hard_write", 3, io_hard_create, 0);
-
-  mdtest_results_t *    md_hard_create = io500_md_hard_create(options);
-  if(io500_rank == 0) io500_print_md(out, "mdtest_hard_create", 5, MDTEST_FILE_CREATE_NUM, md_hard_create);
-
-  // mdreal...
-  if(io500_rank == 0){
-    fprintf(out, "\n[Starting] find: %s", CurrentTimeString());
-    fflush(out);
-  }
-  FILE * fout = io500_prepare_out("find", 1, options);
-  io500_find_results_t* find = io500_find(options);
-  fclose(fout);
-  if(io500_rank == 0) io500_print_find(out, "find-easy", find);
-
-  fout = io500_prepare_out("find-hard", 1, options);
-  io500_find_results_t* find2 = io500_find_hard(options);
-  fclose(fout);
-  if(io500_rank == 0) io500_print_find(out, "find-hard", find2);
-
-
-  IOR_test_t * io_easy_read = io500_io_easy_read(options, io_easy_create);
-  if(io500_rank == 0) io500_print_bw(out, "ior_easy_read", 2, io_easy_read, 1);
-
-  //mdtest_results_t *    md_easy_read = io500_md_easy_read(options, md_easy_create);
-  mdtest_results_t *    md_hard_stat = io500_md_hard_stat(options, md_hard_create);
-  if(io500_rank == 0) io500_print_md(out, "mdtest_hard_stat",   7, MDTEST_FILE_STAT_NUM, md_hard_stat);
-
-  IOR_test_t * io_hard_read = io500_io_hard_read(options, io_hard_create);
-  mdtest_results_t *    md_hard_read = io500_md_hard_read(options, md_hard_create);
-  if(io500_rank == 0) io500_print_md(out, "mdtest_hard_read",   6, MDTEST_FILE_READ_NUM, md_hard_read);
-
-  mdtest_results_t *    md_easy_stat = io500_md_easy_stat(options, md_easy_create);
-  if(io500_rank == 0) io500_print_md(out, "mdtest_easy_stat",   3, MDTEST_FILE_STAT_NUM, md_easy_stat);
-
-  mdtest_results_t *    md_hard_delete = io500_md_hard_delete(options, md_hard_create);
-  if(io500_rank == 0) io500_print_md(out, "mdtest_hard_delete", 8, MDTEST_FILE_REMOVE_NUM, md_hard_delete);
-
-  mdtest_results_t *    md_easy_delete = io500_md_easy_delete(options, md_easy_create);
-  if(io500_rank == 0) io500_print_md(out, "mdtest_easy_delete", 4, MDTEST_FILE_REMOVE_NUM, md_easy_delete);
+  io500_phases_run(options);
 
   if(io500_rank == 0){
     fprintf(out, "\nIO500 complete: %s\n", CurrentTimeString());
+    io500_phases_print_summary(out, official && ! options->resume);
 
-    fprintf(out, "\n");
-    fprintf(out, "=== IO-500 submission ===\n");
-
-    io500_print_bw(out, "ior_easy_write", 1, io_easy_create, 0);
-    io500_print_bw(out, "ior_easy_read", 2, io_easy_read, 1);
-    io500_print_bw(out, "ior_hard_write", 3, io_hard_create, 0);
-    io500_print_bw(out, "ior_hard_read", 4, io_hard_read, 1);
-
-    io500_print_md(out, "mdtest_easy_create", 1, MDTEST_FILE_CREATE_NUM, md_easy_create);
-    //io500_print_md(out, "mdtest_easy_read",   2, MDTEST_FILE_READ_NUM, md_easy_read);
-    io500_print_md(out, "mdtest_easy_stat",   3, MDTEST_FILE_STAT_NUM, md_easy_stat);
-    io500_print_md(out, "mdtest_easy_delete", 4, MDTEST_FILE_REMOVE_NUM, md_easy_delete);
-
-    io500_print_md(out, "mdtest_hard_create", 5, MDTEST_FILE_CREATE_NUM, md_hard_create);
-    io500_print_md(out, "mdtest_hard_read",   6, MDTEST_FILE_READ_NUM, md_hard_read);
-    io500_print_md(out, "mdtest_hard_stat",   7, MDTEST_FILE_STAT_NUM, md_hard_stat);
-    io500_print_md(out, "mdtest_hard_delete", 8, MDTEST_FILE_REMOVE_NUM, md_hard_delete);
-
-    io500_print_find(out, "find-easy", find);
-    io500_print_find(out, "find-hard", find2);
+    io500_score_t score;
+    io500_score(options, official, & score);
+    io500_print_score(out, options, official, & score);
+    io500_json_end(& score);
   }
-  if(! options->stonewall_timer_delete){
+  if(! official){
+    // a later job may resume with the data of this one
+    if(io500_rank == 0){
+      fprintf(out, "\nKeeping the working directory of the partial run, use -C to remove it\n");
+    }
+  }else if(! options->stonewall_timer_delete){
     io500_cleanup(options);
   }
   MPI_Finalize();
@@ -21,6 +21,18 @@ static void io500_print_help(io500_options_t * res){
       "\t-I <N>: Max segments for ior_hard (per process) = %d\n"
       "\t-f <N>: Max number of files for mdtest_easy (per process) = %d\n"
       "\t-F <N>: Max number of files for mdtest_hard (per process)= %d\n"
+      "\t-X: Run the optional mixed metadata workload (interleaved create/stat/read/delete) after the standard phases\n"
+      "\t-K <N>: Working set of files per process for the mixed metadata workload = %d\n"
+      "\t-q <EXPR>: Predicates for the find phases instead of the IO500 rules, e.g. \"-name *01* -size +1k\"\n"
+      "\t\tsupported: [!] -name GLOB, -regex RE, -type [fdlbcFs], -size [+-]N[c|k|M|G], -newer FILE, -cnewer FILE\n"
+      "\t-T <N>: Worker threads per process for find and cleanup = %d\n"
+      "\t-Y: Let find use cached file attributes (AT_STATX_DONT_SYNC), results may be stale\n"
+      "\t-P <LIST>: Run only these phases in the given order, comma separated, NAME:N repeats a phase N times\n"
+      "\t\tA+B runs IOR or mdtest phases concurrently, each on every n-th process, to measure their interference\n"
+      "\t\t@FILE reads the list from FILE, phases a listed phase depends on are added before it\n"
+      "\t-N <LIST>: Skip these phases and the ones depending on them\n"
+      "\t-R, --resume: Continue an aborted run with the data in the working directory, skips the phases completed\n"
+      "\t\taccording to IO500-state.txt in the result directory, use the same options as the aborted run\n"
       "\t-v: increase the verbosity, use multiple times to increase level = %d\n"
       "Useful utility flags\n"
       "\t-C: only parallel delete of files in the working directory, use to cleanup leftovers from aborted runs\n"
@@ -38,6 +50,8 @@ static void io500_print_help(io500_options_t * res){
       res->iorhard_max_segments,
       res->mdeasy_max_files,
       res->mdhard_max_files,
+      res->mdmixed_working_set,
+      res->find_threads,
       res->verbosity
     );
 }
@@ -58,13 +72,23 @@ io500_options_t * io500_parse_args(int argc, char ** argv, int force_print_help)
   res->mdtest_easy_options = strdup("-u -L");
   res->mdeasy_max_files = 100000000;
   res->mdhard_max_files = 100000000;
+  res->mdmixed_working_set = 1000;
   res->stonewall_timer = 300;
+  res->find_threads = 1;
   res->iorhard_max_segments = 100000000;
   res->output = stdout;
+  res->comm = MPI_COMM_WORLD;
+  res->rank = io500_rank;
+
+  for(int i=1; i < argc; i++){
+    if(strcmp(argv[i], "--resume") == 0){
+      argv[i] = "-R";
+    }
+  }
 
   int c;
   while (1) {
-    c = getopt(argc, argv, "a:A:e:E:hvw:f:F:s:SI:ClLr:");
+    c = getopt(argc, argv, "a:A:e:E:hvw:f:F:s:SI:K:ClLN:P:q:r:RT:XY");
     if (c == -1) {
         break;
     }
@@ -88,14 +112,24 @@ io500_options_t * io500_parse_args(int argc, char ** argv, int force_print_help)
       print_help = 1; break;
     case 'I':
       res->iorhard_max_segments = atol(optarg); break;
+    case 'K':
+      res->mdmixed_working_set = atol(optarg); break;
     case 'l':
       res->log_all_procs = 1; break;
     case 'L':
       res->write_output_to_log = 1; break;
     case 'm':
         res->mdtest_easy_options = strdup(optarg); break;
+    case 'N':
+        res->skip_phases = strdup(optarg); break;
+    case 'P':
+        res->phases = strdup(optarg); break;
+    case 'q':
+        res->find_expression = strdup(optarg); break;
     case 'r':
         res->results_dir = strdup(optarg); break;
+    case 'R':
+      res->resume = 1; break;
     case 's':
       res->stonewall_timer = atol(optarg);
       break;
@@ -104,10 +138,16 @@ io500_options_t * io500_parse_args(int argc, char ** argv, int force_print_help)
         res->stonewall_timer_delete = 1;
       }
       res->stonewall_timer_reads = 1; break;
+    case 'T':
+      res->find_threads = atol(optarg); break;
     case 'v':
       res->verbosity++; break;
     case 'w':
       res->workdir = strdup(optarg); break;
+    case 'X':
+      res->run_mdtest_mixed = 1; break;
+    case 'Y':
+      res->find_dont_sync = 1; break;
     }
   }
   if(print_help){
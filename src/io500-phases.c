@@ -0,0 +1,800 @@
+/*
+ * License: MIT license
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+#include <utilities.h>
+
+#include "io500-phases.h"
+#include "io500-functions.h"
+#include "io500-utils.h"
+#include "io500-json.h"
+
+static io500_phase_t * io500_phase_dep(io500_phase_t * p){
+  return io500_phase_find(p->depends);
+}
+
+static void run_ior_easy_write(io500_phase_t * p, io500_options_t * o){
+  p->ior = io500_io_easy_create(o);
+}
+
+static void run_ior_easy_read(io500_phase_t * p, io500_options_t * o){
+  p->ior = io500_io_easy_read(o, io500_phase_dep(p)->ior);
+}
+
+static void run_ior_hard_write(io500_phase_t * p, io500_options_t * o){
+  p->ior = io500_io_hard_create(o);
+}
+
+static void run_ior_hard_read(io500_phase_t * p, io500_options_t * o){
+  p->ior = io500_io_hard_read(o, io500_phase_dep(p)->ior);
+}
+
+static void run_md_easy_create(io500_phase_t * p, io500_options_t * o){
+  p->md = io500_md_easy_create(o, & p->md_ctx);
+}
+
+static void run_md_easy_read(io500_phase_t * p, io500_options_t * o){
+  p->md = io500_md_easy_read(o, io500_phase_dep(p)->md, & p->md_ctx);
+}
+
+static void run_md_easy_stat(io500_phase_t * p, io500_options_t * o){
+  p->md = io500_md_easy_stat(o, io500_phase_dep(p)->md, & p->md_ctx);
+}
+
+static void run_md_easy_delete(io500_phase_t * p, io500_options_t * o){
+  p->md = io500_md_easy_delete(o, io500_phase_dep(p)->md, & p->md_ctx);
+}
+
+static void run_md_hard_create(io500_phase_t * p, io500_options_t * o){
+  p->md = io500_md_hard_create(o, & p->md_ctx);
+}
+
+static void run_md_hard_read(io500_phase_t * p, io500_options_t * o){
+  p->md = io500_md_hard_read(o, io500_phase_dep(p)->md, & p->md_ctx);
+}
+
+static void run_md_hard_stat(io500_phase_t * p, io500_options_t * o){
+  p->md = io500_md_hard_stat(o, io500_phase_dep(p)->md, & p->md_ctx);
+}
+
+static void run_md_hard_delete(io500_phase_t * p, io500_options_t * o){
+  p->md = io500_md_hard_delete(o, io500_phase_dep(p)->md, & p->md_ctx);
+}
+
+static void run_md_mixed(io500_phase_t * p, io500_options_t * o){
+  p->md = io500_md_mixed(o, & p->md_ctx);
+}
+
+// the find phases select the files created after this file
+static void run_timestamp(io500_phase_t * p, io500_options_t * o){
+  char fname[4096];
+  (void) p;
+  sprintf(fname, "%s/IO500_TIMESTAMP", o->workdir);
+  io500_touch(fname);
+  MPI_Barrier(MPI_COMM_WORLD);
+}
+
+static FILE * io500_find_start(io500_phase_t * p, io500_options_t * o, char * log){
+  if(io500_rank == 0){
+    fprintf(o->output, "\n[Starting] %s: %s", p->name, CurrentTimeString());
+    fflush(o->output);
+  }
+  return io500_prepare_out(log, 1, o);
+}
+
+static void run_find_easy(io500_phase_t * p, io500_options_t * o){
+  FILE * fout = io500_find_start(p, o, "find");
+  p->find = io500_find(o);
+  fclose(fout);
+}
+
+static void run_find_hard(io500_phase_t * p, io500_options_t * o){
+  FILE * fout = io500_find_start(p, o, "find-hard");
+  p->find = io500_find_hard(o);
+  fclose(fout);
+}
+
+static io500_phase_t phases[] = {
+  {.name = "ior_easy_write", .kind = IO500_PHASE_IOR, .id = 1,
+   .official = 1, .run = run_ior_easy_write},
+  {.name = "mdtest_easy_create", .kind = IO500_PHASE_MDTEST, .id = 1, .md_pos = MDTEST_FILE_CREATE_NUM,
+   .official = 1, .run = run_md_easy_create},
+  {.name = "timestamp", .kind = IO500_PHASE_NONE,
+   .official = 1, .run = run_timestamp},
+  {.name = "ior_hard_write", .kind = IO500_PHASE_IOR, .id = 3,
+   .official = 1, .run = run_ior_hard_write},
+  {.name = "mdtest_hard_create", .kind = IO500_PHASE_MDTEST, .id = 5, .md_pos = MDTEST_FILE_CREATE_NUM,
+   .official = 1, .run = run_md_hard_create},
+  {.name = "find-easy", .depends = "timestamp", .kind = IO500_PHASE_FIND,
+   .official = 1, .run = run_find_easy},
+  {.name = "find-hard", .depends = "timestamp", .kind = IO500_PHASE_FIND,
+   .official = 1, .run = run_find_hard},
+  {.name = "ior_easy_read", .depends = "ior_easy_write", .kind = IO500_PHASE_IOR, .id = 2, .read = 1,
+   .official = 1, .run = run_ior_easy_read},
+  {.name = "mdtest_easy_read", .depends = "mdtest_easy_create", .kind = IO500_PHASE_MDTEST, .id = 2, .md_pos = MDTEST_FILE_READ_NUM,
+   .official = 0, .run = run_md_easy_read},
+  {.name = "mdtest_hard_stat", .depends = "mdtest_hard_create", .kind = IO500_PHASE_MDTEST, .id = 7, .md_pos = MDTEST_FILE_STAT_NUM,
+   .official = 1, .run = run_md_hard_stat},
+  {.name = "ior_hard_read", .depends = "ior_hard_write", .kind = IO500_PHASE_IOR, .id = 4, .read = 1,
+   .official = 1, .run = run_ior_hard_read},
+  {.name = "mdtest_hard_read", .depends = "mdtest_hard_create", .kind = IO500_PHASE_MDTEST, .id = 6, .md_pos = MDTEST_FILE_READ_NUM,
+   .official = 1, .run = run_md_hard_read},
+  {.name = "mdtest_easy_stat", .depends = "mdtest_easy_create", .kind = IO500_PHASE_MDTEST, .id = 3, .md_pos = MDTEST_FILE_STAT_NUM,
+   .official = 1, .run = run_md_easy_stat},
+  {.name = "mdtest_hard_delete", .depends = "mdtest_hard_create", .kind = IO500_PHASE_MDTEST, .id = 8, .md_pos = MDTEST_FILE_REMOVE_NUM,
+   .official = 1, .run = run_md_hard_delete},
+  {.name = "mdtest_easy_delete", .depends = "mdtest_easy_create", .kind = IO500_PHASE_MDTEST, .id = 4, .md_pos = MDTEST_FILE_REMOVE_NUM,
+   .official = 1, .run = run_md_easy_delete},
+  // optional phase, not part of the submission, -X adds it to the default schedule
+  {.name = "mdtest_mixed", .kind = IO500_PHASE_MIXED, .id = 9,
+   .official = 0, .run = run_md_mixed},
+  {.name = NULL}
+};
+
+// order of the phases in the submission summary
+static const char * summary_order[] = {
+  "ior_easy_write", "ior_easy_read", "ior_hard_write", "ior_hard_read",
+  "mdtest_easy_create", "mdtest_easy_read", "mdtest_easy_stat", "mdtest_easy_delete",
+  "mdtest_hard_create", "mdtest_hard_read", "mdtest_hard_stat", "mdtest_hard_delete",
+  "find-easy", "find-hard", NULL
+};
+
+// phases of the same step run concurrently
+static io500_phase_t ** schedule = NULL;
+static int * schedule_step = NULL;
+static int schedule_len = 0;
+static int schedule_size = 0;
+static int step_count = 0;
+// on resume: the completed runs of each phase that are not scheduled again
+static int * resume_left = NULL;
+
+// IOR results with one repetition, as io500 uses them
+static IOR_test_t * io500_ior_result_alloc(void){
+  IOR_test_t * t = calloc(1, sizeof(IOR_test_t));
+  IOR_results_t * r = calloc(1, sizeof(IOR_results_t));
+  t->results = r;
+  r->writeTime = calloc(1, sizeof(double));
+  r->readTime = calloc(1, sizeof(double));
+  r->aggFileSizeFromXfer = calloc(1, sizeof(IOR_offset_t));
+  return t;
+}
+
+io500_phase_t * io500_phase_find(const char * name){
+  if(name == NULL){
+    return NULL;
+  }
+  for(io500_phase_t * p = phases; p->name != NULL; p++){
+    if(strcmp(p->name, name) == 0){
+      return p;
+    }
+  }
+  return NULL;
+}
+
+static io500_phase_t * io500_phase_lookup(const char * name){
+  io500_phase_t * p = io500_phase_find(name);
+  if(p == NULL){
+    if(io500_rank == 0){
+      printf("Unknown phase \"%s\", available phases:", name);
+      for(p = phases; p->name != NULL; p++){
+        printf(" %s", p->name);
+      }
+      printf("\n");
+    }
+    io500_error("Invalid phase list");
+  }
+  return p;
+}
+
+// a list starting with @ names a file holding it, rank 0 reads the file
+static char * io500_phases_read_list(const char * list){
+  if(list[0] != '@'){
+    return strdup(list);
+  }
+  char * buf = io500_read_file_bcast(list + 1);
+  if(buf == NULL){
+    if(io500_rank == 0){
+      printf("Phase file: %s\n", list + 1);
+    }
+    io500_error("Could not read the phase file");
+  }
+  // drop comments
+  for(char * c = strchr(buf, '#'); c != NULL; c = strchr(c, '#')){
+    for(; *c != 0 && *c != '\n'; c++){
+      *c = ' ';
+    }
+  }
+  return buf;
+}
+
+// scheduled[] holds the number of processes a phase runs on, -1 if unknown
+static void io500_phases_push(io500_phase_t * p, int step, int procs, int * scheduled){
+  // files of a phase can only be processed by as many processes as created them
+  io500_phase_t * dep = io500_phase_dep(p);
+  if(dep != NULL && scheduled[dep - phases] > 0 && scheduled[dep - phases] < procs){
+    if(io500_rank == 0){
+      printf("Phase %s would run on %d processes but %s ran on %d\n", p->name, procs, dep->name, scheduled[dep - phases]);
+    }
+    io500_error("A phase cannot run on more processes than its dependency");
+  }
+  if(schedule_len == schedule_size){
+    schedule_size = schedule_size ? schedule_size * 2 : 32;
+    schedule = realloc(schedule, schedule_size * sizeof(* schedule));
+    schedule_step = realloc(schedule_step, schedule_size * sizeof(* schedule_step));
+  }
+  schedule[schedule_len] = p;
+  schedule_step[schedule_len] = step;
+  schedule_len++;
+  scheduled[p - phases] = procs;
+}
+
+static void io500_phases_append(io500_phase_t * p, int * skip, int * scheduled);
+
+// on resume, takes one completed run of p, returns 1 if there was one
+static int io500_phases_completed(io500_phase_t * p){
+  if(resume_left == NULL || resume_left[p - phases] == 0){
+    return 0;
+  }
+  resume_left[p - phases]--;
+  return 1;
+}
+
+// schedule the dependency of p if needed, returns 0 if p is skipped
+static int io500_phases_ready(io500_phase_t * p, int * skip, int * scheduled){
+  int idx = p - phases;
+  if(skip[idx]){
+    return 0;
+  }
+  io500_phase_t * dep = io500_phase_dep(p);
+  if(dep != NULL && ! scheduled[dep - phases]){
+    if(skip[dep - phases]){
+      if(io500_rank == 0){
+        printf("Skipping phase %s, it needs the skipped phase %s\n", p->name, dep->name);
+      }
+      skip[idx] = 1;
+      return 0;
+    }
+    io500_phases_append(dep, skip, scheduled);
+  }
+  return 1;
+}
+
+static void io500_phases_append(io500_phase_t * p, int * skip, int * scheduled){
+  if(io500_phases_ready(p, skip, scheduled) && ! io500_phases_completed(p)){
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, & size);
+    io500_phases_push(p, step_count++, size, scheduled);
+  }
+}
+
+// A+B+...: the phases run at the same time on disjoint sets of processes
+static void io500_phases_append_concurrent(char * tok, int * skip, int * scheduled){
+  io500_phase_t * group[16];
+  int n = 0;
+  char * saveptr;
+  for(char * name = strtok_r(tok, "+", & saveptr); name != NULL; name = strtok_r(NULL, "+", & saveptr)){
+    if(n == 16){
+      io500_error("Too many concurrent phases");
+    }
+    group[n] = io500_phase_lookup(name);
+    if(group[n]->kind != IO500_PHASE_IOR && group[n]->kind != IO500_PHASE_MDTEST && group[n]->kind != IO500_PHASE_MIXED){
+      if(io500_rank == 0){
+        printf("Phase %s cannot run concurrently\n", name);
+      }
+      io500_error("Only IOR and mdtest phases can run concurrently");
+    }
+    n++;
+  }
+  for(int i=0; i < n; i++){
+    for(int j=0; j < n; j++){
+      if(io500_phase_dep(group[i]) == group[j] || (i != j && group[i] == group[j])){
+        if(io500_rank == 0){
+          printf("Phases %s and %s\n", group[i]->name, group[j]->name);
+        }
+        io500_error("A phase cannot run concurrently with itself or its dependency");
+      }
+    }
+  }
+  // the dependencies run before the group
+  int ready[16];
+  for(int i=0; i < n; i++){
+    ready[i] = io500_phases_ready(group[i], skip, scheduled) && ! io500_phases_completed(group[i]);
+  }
+  int size;
+  MPI_Comm_size(MPI_COMM_WORLD, & size);
+  if(size < n){
+    io500_error("Not enough processes to run the phases concurrently");
+  }
+  // only the phases pushed here run in the step and share its processes
+  int m = 0;
+  for(int i=0; i < n; i++){
+    m += ready[i] != 0;
+  }
+  if(m == 0){
+    return;
+  }
+  int step = step_count++;
+  int k = 0;
+  for(int i=0; i < n; i++){
+    if(ready[i]){
+      // the processes are dealt out round-robin, see io500_phases_run_concurrent()
+      io500_phases_push(group[i], step, (size - k + m - 1) / m, scheduled);
+      k++;
+    }
+  }
+}
+
+// The state file in the results directory records every completed phase so
+// that -R can continue an aborted run in a later job. It starts with the
+// number of processes and the options that shape the data in the working
+// directory, the later job must use the same; followed by one record per
+// completed phase:
+//   phase NAME
+//   procs N the number of processes it ran on
+//   concurrent NAMES if the phase ran together with others
+//   ior | md | lat | find lines with the results
+//   end NAME
+// A record without its end line is ignored.
+#define IO500_STATE_FILE "IO500-state.txt"
+
+static FILE * state_file = NULL;
+
+static void io500_state_header(io500_options_t * o, char * buf, size_t size){
+  char easy[4096];
+  char hard[4096];
+  char md_easy[4096];
+  int nproc;
+  snprintf(easy, sizeof(easy), "%s", o->ior_easy_options);
+  snprintf(hard, sizeof(hard), "%s", o->ior_hard_options);
+  snprintf(md_easy, sizeof(md_easy), "%s", o->mdtest_easy_options);
+  for(char * c = easy; *c; c++) if(*c == '\n') *c = ' ';
+  for(char * c = hard; *c; c++) if(*c == '\n') *c = ' ';
+  for(char * c = md_easy; *c; c++) if(*c == '\n') *c = ' ';
+  MPI_Comm_size(MPI_COMM_WORLD, & nproc);
+  snprintf(buf, size, "io500-state 2\n"
+    "workdir %s\n"
+    "nproc %d\n"
+    "option ior_easy_options %s\n"
+    "option ior_hard_options %s\n"
+    "option mdtest_easy_options %s\n"
+    "option iorhard_max_segments %d\n"
+    "option mdeasy_max_files %d\n"
+    "option mdhard_max_files %d\n"
+    "option mdmixed_working_set %d\n"
+    "option stonewall_timer %d\n",
+    o->workdir, nproc, easy, hard, md_easy, o->iorhard_max_segments, o->mdeasy_max_files,
+    o->mdhard_max_files, o->mdmixed_working_set, o->stonewall_timer);
+}
+
+static void io500_state_write(io500_phase_t * p){
+  FILE * f = state_file;
+  fprintf(f, "phase %s\n", p->name);
+  fprintf(f, "procs %d\n", p->procs);
+  if(p->concurrent){
+    fprintf(f, "concurrent %s\n", p->concurrent);
+  }
+  if(p->ior){
+    IOR_results_t * r = p->ior->results;
+    fprintf(f, "ior %.17g %.17g %lld %zu %.17g %lld %lld\n", r->writeTime[0], r->readTime[0],
+      (long long) r->aggFileSizeFromXfer[0], r->pairs_accessed, r->stonewall_time,
+      r->stonewall_min_data_accessed, r->stonewall_avg_data_accessed);
+  }
+  if(p->md){
+    mdtest_results_t * r = p->md;
+    for(int i=0; i < MDTEST_LAST_NUM; i++){
+      if(r->items[i] == 0 && r->time[i] == 0 && r->stonewall_last_item[i] == 0){
+        continue;
+      }
+      fprintf(f, "md %d %.17g %.17g %"PRIu64" %"PRIu64" %"PRIu64" %.17g %"PRIu64" %"PRIu64"\n", i,
+        r->rate[i], r->time[i], r->items[i], r->bytes[i], r->stonewall_last_item[i],
+        r->stonewall_time[i], r->stonewall_item_min[i], r->stonewall_item_sum[i]);
+    }
+    for(int i=0; i < MDTEST_LATENCY_LAST_NUM; i++){
+      mdtest_latency_t * l = & r->latency[i];
+      if(l->ops != 0){
+        fprintf(f, "lat %d %"PRIu64" %.17g %.17g %.17g %.17g\n", i, l->ops, l->p50, l->p99, l->p999, l->max);
+      }
+    }
+  }
+  if(p->find){
+    io500_find_results_t * r = p->find;
+    io500_find_dist_t * d[] = {& r->dist_dirs, & r->dist_entries, & r->dist_stats, & r->dist_received, & r->dist_bytes, & r->dist_idle};
+    fprintf(f, "find %"PRIu64" %"PRIu64" %"PRIu64" %.17g %.17g", r->errors, r->found_files, r->total_files, r->rate, r->runtime);
+    for(int i=0; i < 6; i++){
+      fprintf(f, " %.17g %.17g %.17g", d[i]->min, d[i]->median, d[i]->max);
+    }
+    fprintf(f, "\n");
+  }
+  fprintf(f, "end %s\n", p->name);
+  fflush(f);
+  fsync(fileno(f));
+}
+
+static void io500_state_parse_error(const char * line){
+  if(io500_rank == 0){
+    printf("State file line: %s\n", line);
+  }
+  io500_error("Invalid state file, cannot resume");
+}
+
+// load the results of the completed phases, all ranks parse the content of rank 0
+static void io500_state_load(io500_options_t * o){
+  char fname[4096];
+  char header[16384];
+  sprintf(fname, "%s/%s", o->results_dir, IO500_STATE_FILE);
+  char * buf = io500_read_file_bcast(fname);
+  if(buf == NULL){
+    if(io500_rank == 0){
+      printf("State file: %s\n", fname);
+    }
+    io500_error("Could not read the state file, cannot resume");
+  }
+  io500_state_header(o, header, sizeof(header));
+  if(strncmp(buf, header, strlen(header)) != 0){
+    if(io500_rank == 0){
+      printf("Expected state header:\n%s", header);
+    }
+    io500_error("The state file was written with different options, working directory or number of processes, cannot resume");
+  }
+
+  io500_phase_t * cur = NULL;
+  io500_phase_t tmp;
+  char * saveptr;
+  for(char * line = strtok_r(buf + strlen(header), "\n", & saveptr); line != NULL; line = strtok_r(NULL, "\n", & saveptr)){
+    char name[256];
+    int pos;
+    if(sscanf(line, "phase %255s", name) == 1){
+      cur = io500_phase_lookup(name);
+      memset(& tmp, 0, sizeof(tmp));
+    }else if(cur == NULL){
+      io500_state_parse_error(line);
+    }else if(sscanf(line, "procs %d", & tmp.procs) == 1){
+      if(tmp.procs < 1){
+        io500_state_parse_error(line);
+      }
+    }else if(strncmp(line, "concurrent ", 11) == 0){
+      tmp.concurrent = strdup(line + 11);
+    }else if(strncmp(line, "ior ", 4) == 0){
+      tmp.ior = io500_ior_result_alloc();
+      IOR_results_t * r = tmp.ior->results;
+      long long size;
+      if(sscanf(line, "ior %lf %lf %lld %zu %lf %lld %lld", r->writeTime, r->readTime, & size,
+        & r->pairs_accessed, & r->stonewall_time, & r->stonewall_min_data_accessed,
+        & r->stonewall_avg_data_accessed) != 7){
+        io500_state_parse_error(line);
+      }
+      r->aggFileSizeFromXfer[0] = size;
+    }else if(sscanf(line, "md %d", & pos) == 1){
+      if(tmp.md == NULL){
+        tmp.md = calloc(1, sizeof(mdtest_results_t));
+      }
+      mdtest_results_t * r = tmp.md;
+      if(pos < 0 || pos >= MDTEST_LAST_NUM || sscanf(line, "md %*d %lf %lf %"SCNu64" %"SCNu64" %"SCNu64" %lf %"SCNu64" %"SCNu64,
+        & r->rate[pos], & r->time[pos], & r->items[pos], & r->bytes[pos], & r->stonewall_last_item[pos],
+        & r->stonewall_time[pos], & r->stonewall_item_min[pos], & r->stonewall_item_sum[pos]) != 8){
+        io500_state_parse_error(line);
+      }
+    }else if(sscanf(line, "lat %d", & pos) == 1){
+      if(tmp.md == NULL){
+        tmp.md = calloc(1, sizeof(mdtest_results_t));
+      }
+      if(pos < 0 || pos >= MDTEST_LATENCY_LAST_NUM){
+        io500_state_parse_error(line);
+      }
+      mdtest_latency_t * l = & tmp.md->latency[pos];
+      if(sscanf(line, "lat %*d %"SCNu64" %lf %lf %lf %lf", & l->ops, & l->p50, & l->p99, & l->p999, & l->max) != 5){
+        io500_state_parse_error(line);
+      }
+    }else if(strncmp(line, "find ", 5) == 0){
+      io500_find_results_t * r = calloc(1, sizeof(io500_find_results_t));
+      io500_find_dist_t * d[] = {& r->dist_dirs, & r->dist_entries, & r->dist_stats, & r->dist_received, & r->dist_bytes, & r->dist_idle};
+      tmp.find = r;
+      int n;
+      char * c = line;
+      if(sscanf(c, "find %"SCNu64" %"SCNu64" %"SCNu64" %lf %lf%n", & r->errors, & r->found_files,
+        & r->total_files, & r->rate, & r->runtime, & n) != 5){
+        io500_state_parse_error(line);
+      }
+      for(int i=0; i < 6; i++){
+        c += n;
+        if(sscanf(c, " %lf %lf %lf%n", & d[i]->min, & d[i]->median, & d[i]->max, & n) != 3){
+          io500_state_parse_error(line);
+        }
+      }
+    }else if(sscanf(line, "end %255s", name) == 1 && strcmp(name, cur->name) == 0){
+      if((cur->kind == IO500_PHASE_IOR && ! tmp.ior) || (cur->kind == IO500_PHASE_FIND && ! tmp.find)
+        || ((cur->kind == IO500_PHASE_MDTEST || cur->kind == IO500_PHASE_MIXED) && ! tmp.md) || tmp.procs == 0){
+        io500_state_parse_error(line);
+      }
+      cur->ior = tmp.ior;
+      cur->md = tmp.md;
+      cur->find = tmp.find;
+      cur->concurrent = tmp.concurrent;
+      cur->procs = tmp.procs;
+      cur->runs++;
+      cur = NULL;
+    }else{
+      io500_state_parse_error(line);
+    }
+  }
+  free(buf);
+}
+
+static void io500_state_open(io500_options_t * o){
+  if(io500_rank != 0){
+    return;
+  }
+  char fname[4096];
+  sprintf(fname, "%s/%s", o->results_dir, IO500_STATE_FILE);
+  state_file = fopen(fname, o->resume ? "a" : "w");
+  if(state_file == NULL){
+    io500_error("Could not open the state file");
+  }
+  if(! o->resume){
+    char header[16384];
+    io500_state_header(o, header, sizeof(header));
+    fprintf(state_file, "%s", header);
+    fflush(state_file);
+  }
+}
+
+int io500_phases_schedule(io500_options_t * options){
+  int count = sizeof(phases) / sizeof(* phases) - 1;
+  int * skip = calloc(count, sizeof(int));
+  int * scheduled = calloc(count, sizeof(int));
+  int official = options->phases == NULL && options->skip_phases == NULL;
+  char * saveptr;
+  char * tok;
+
+  schedule_len = 0;
+  if(options->resume){
+    // completed phases keep the number of processes they ran on for the
+    // check of the phases that depend on them
+    io500_state_load(options);
+    resume_left = calloc(count, sizeof(int));
+    for(int i=0; i < count; i++){
+      resume_left[i] = phases[i].runs;
+      scheduled[i] = phases[i].runs > 0 ? phases[i].procs : 0;
+    }
+  }
+  if(options->skip_phases){
+    char * list = io500_phases_read_list(options->skip_phases);
+    for(tok = strtok_r(list, ", \t\n", & saveptr); tok != NULL; tok = strtok_r(NULL, ", \t\n", & saveptr)){
+      skip[io500_phase_lookup(tok) - phases] = 1;
+    }
+    free(list);
+  }
+
+  if(options->phases == NULL){
+    for(io500_phase_t * p = phases; p->name != NULL; p++){
+      if(p->official || (p->kind == IO500_PHASE_MIXED && options->run_mdtest_mixed)){
+        io500_phases_append(p, skip, scheduled);
+      }
+    }
+  }else{
+    // entries are NAME or NAME:REPEATS, NAME+NAME runs phases concurrently
+    char * list = io500_phases_read_list(options->phases);
+    for(tok = strtok_r(list, ", \t\n", & saveptr); tok != NULL; tok = strtok_r(NULL, ", \t\n", & saveptr)){
+      int repeats = 1;
+      char * colon = strchr(tok, ':');
+      if(colon != NULL){
+        *colon = 0;
+        repeats = atoi(colon + 1);
+        if(repeats < 1){
+          io500_error("Invalid number of repeats in the phase list");
+        }
+      }
+      if(strchr(tok, '+') != NULL){
+        for(int i=0; i < repeats; i++){
+          char * group = strdup(tok);
+          io500_phases_append_concurrent(group, skip, scheduled);
+          free(group);
+        }
+        continue;
+      }
+      io500_phase_t * p = io500_phase_lookup(tok);
+      for(int i=0; i < repeats; i++){
+        io500_phases_append(p, skip, scheduled);
+      }
+    }
+    free(list);
+  }
+  free(skip);
+
+  if(options->resume){
+    // the completed runs were not scheduled again, see io500_phases_completed()
+    int done = 0;
+    for(int i=0; i < count; i++){
+      done += phases[i].runs;
+    }
+    free(resume_left);
+    resume_left = NULL;
+    if(io500_rank == 0){
+      fprintf(options->output, "Resuming after %d completed phases:", done);
+      for(io500_phase_t * p = phases; p->name != NULL; p++){
+        if(p->runs > 0){
+          fprintf(options->output, " %s", p->name);
+        }
+      }
+      fprintf(options->output, "\n");
+    }
+  }
+  free(scheduled);
+
+  if(schedule_len == 0 && ! options->resume){
+    io500_error("The phase list is empty");
+  }
+  if(io500_rank == 0 && (! official || options->resume)){
+    fprintf(options->output, "Phases:");
+    for(int i=0; i < schedule_len; i++){
+      int with_prev = i > 0 && schedule_step[i] == schedule_step[i-1];
+      fprintf(options->output, "%s%s", with_prev ? "+" : " ", schedule[i]->name);
+    }
+    fprintf(options->output, "\n");
+    fflush(options->output);
+  }
+  return official;
+}
+
+void io500_phase_print(FILE * out, io500_phase_t * p){
+  switch(p->kind){
+    case IO500_PHASE_IOR:
+      io500_print_bw(out, p->name, p->id, p->ior, p->read);
+      break;
+    case IO500_PHASE_MDTEST:
+      io500_print_md(out, p->name, p->id, p->md_pos, p->md);
+      break;
+    case IO500_PHASE_FIND:
+      io500_print_find(out, p->name, p->find);
+      break;
+    case IO500_PHASE_MIXED:
+      io500_print_md(out, "mdtest_mixed_create", p->id, MDTEST_MIXED_CREATE_NUM, p->md);
+      io500_print_md(out, "mdtest_mixed_stat",   p->id, MDTEST_MIXED_STAT_NUM, p->md);
+      io500_print_md(out, "mdtest_mixed_read",   p->id, MDTEST_MIXED_READ_NUM, p->md);
+      io500_print_md(out, "mdtest_mixed_delete", p->id, MDTEST_MIXED_REMOVE_NUM, p->md);
+      break;
+    case IO500_PHASE_NONE:
+      break;
+  }
+}
+
+static void io500_phase_done(io500_phase_t * p, io500_options_t * options){
+  p->runs++;
+  if(io500_rank == 0){
+    io500_state_write(p);
+    io500_json_phase(p, 0);
+    io500_phase_print(options->output, p);
+    if(p->kind == IO500_PHASE_FIND){
+      io500_print_find_balance(options->output, p->name, p->find);
+    }
+  }
+}
+
+// hand the results of a phase that ran on a part of the processes to all
+static void io500_phase_bcast(io500_phase_t * p, int root, int mine){
+  if(p->kind == IO500_PHASE_IOR){
+    struct{
+      double write;
+      double read;
+      double stonewall_time;
+      long long size;
+      long long stonewall_min;
+      long long stonewall_avg;
+      size_t pairs;
+    } r;
+    if(mine){
+      IOR_results_t * res = p->ior->results;
+      r.write = res->writeTime[0];
+      r.read = res->readTime[0];
+      r.stonewall_time = res->stonewall_time;
+      r.size = res->aggFileSizeFromXfer[0];
+      r.stonewall_min = res->stonewall_min_data_accessed;
+      r.stonewall_avg = res->stonewall_avg_data_accessed;
+      r.pairs = res->pairs_accessed;
+    }
+    MPI_Bcast(& r, sizeof(r), MPI_BYTE, root, MPI_COMM_WORLD);
+    if(! mine){
+      p->ior = io500_ior_result_alloc();
+      IOR_results_t * res = p->ior->results;
+      res->writeTime[0] = r.write;
+      res->readTime[0] = r.read;
+      res->stonewall_time = r.stonewall_time;
+      res->aggFileSizeFromXfer[0] = r.size;
+      res->stonewall_min_data_accessed = r.stonewall_min;
+      res->stonewall_avg_data_accessed = r.stonewall_avg;
+      res->pairs_accessed = r.pairs;
+    }
+  }else{
+    if(! mine){
+      p->md = malloc(sizeof(mdtest_results_t));
+    }
+    MPI_Bcast(p->md, sizeof(mdtest_results_t), MPI_BYTE, root, MPI_COMM_WORLD);
+  }
+}
+
+// Run the phases of a step at the same time. The processes are dealt out
+// round-robin, so every phase shares the nodes and their clients with the
+// others like concurrent jobs of production do.
+static void io500_phases_run_concurrent(io500_phase_t ** group, int n, io500_options_t * options){
+  int size;
+  MPI_Comm_size(MPI_COMM_WORLD, & size);
+  char names[4096];
+  int pos = 0;
+  for(int i=0; i < n; i++){
+    pos += snprintf(names + pos, sizeof(names) - pos, "%s%s", i ? "+" : "", group[i]->name);
+  }
+  if(io500_rank == 0){
+    fprintf(options->output, "\n[Concurrent] %s on %d processes: %s", names, size, CurrentTimeString());
+    fflush(options->output);
+  }
+
+  int color = io500_rank % n;
+  io500_options_t sub = * options;
+  MPI_Comm_split(MPI_COMM_WORLD, color, io500_rank, & sub.comm);
+  MPI_Comm_rank(sub.comm, & sub.rank);
+  group[color]->run(group[color], & sub);
+  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Comm_free(& sub.comm);
+
+  // the lowest rank of each set is its rank 0
+  for(int i=0; i < n; i++){
+    if(i != color && group[i]->md_ctx != NULL){
+      // from an earlier run, this one ran on other processes
+      mdtest_free(group[i]->md_ctx);
+      group[i]->md_ctx = NULL;
+    }
+    io500_phase_bcast(group[i], i, i == color);
+    group[i]->concurrent = strdup(names);
+    group[i]->procs = (size - i + n - 1) / n;
+    io500_phase_done(group[i], options);
+  }
+}
+
+void io500_phases_run(io500_options_t * options){
+  io500_state_open(options);
+  if(io500_rank == 0){
+    io500_json_begin(options);
+    for(io500_phase_t * p = phases; p->name != NULL; p++){
+      if(p->runs > 0){
+        io500_json_phase(p, 1);
+      }
+    }
+  }
+  for(int i=0; i < schedule_len; ){
+    int n = 1;
+    for(; i + n < schedule_len && schedule_step[i + n] == schedule_step[i]; n++);
+    if(n > 1){
+      io500_phases_run_concurrent(& schedule[i], n, options);
+    }else{
+      io500_phase_t * p = schedule[i];
+      p->run(p, options);
+      p->concurrent = NULL;
+      MPI_Comm_size(MPI_COMM_WORLD, & p->procs);
+      io500_phase_done(p, options);
+    }
+    i += n;
+  }
+  if(state_file){
+    fclose(state_file);
+    state_file = NULL;
+  }
+}
+
+void io500_phases_print_summary(FILE * out, int official){
+  fprintf(out, "\n");
+  if(official){
+    fprintf(out, "=== IO-500 submission ===\n");
+  }else{
+    fprintf(out, "=== IO-500 partial run, not a valid submission ===\n");
+  }
+  for(int i=0; summary_order[i] != NULL; i++){
+    io500_phase_t * p = io500_phase_find(summary_order[i]);
+    if(p->runs > 0){
+      io500_phase_print(out, p);
+    }
+  }
+}
@@ -0,0 +1,58 @@
+#ifndef _IO500_PHASES_H
+#define _IO500_PHASES_H
+
+#include <stdio.h>
+
+#include <ior.h>
+#include <mdtest.h>
+
+#include "io500-types.h"
+
+typedef enum{
+  IO500_PHASE_NONE,   // preparation steps without a result
+  IO500_PHASE_IOR,
+  IO500_PHASE_MDTEST,
+  IO500_PHASE_FIND,
+  IO500_PHASE_MIXED
+} io500_phase_kind_t;
+
+typedef struct io500_phase_t io500_phase_t;
+
+// a benchmark phase of the registry, the table in io500-phases.c lists them
+// in the official order of the IO500 run
+struct io500_phase_t{
+  const char * name;
+  const char * depends; // phase providing the files (and stonewall counts) this one needs, NULL if none
+  io500_phase_kind_t kind;
+  int id;               // test id printed with the result
+  int read;             // IOR: print the read bandwidth
+  mdtest_test_num_t md_pos;
+  int official;         // part of the default schedule
+
+  void (*run)(io500_phase_t * phase, io500_options_t * options);
+
+  // results of the latest run
+  int runs;
+  int procs;            // number of processes of the latest run
+  IOR_test_t * ior;
+  mdtest_results_t * md;
+  mdtest_ctx_t * md_ctx; // of the mdtest run on this process, NULL if it ran on others
+  io500_find_results_t * find;
+  char * concurrent;    // phases that ran at the same time, NULL if it ran alone
+};
+
+io500_phase_t * io500_phase_find(const char * name);
+
+// build the schedule from options->phases and options->skip_phases, the
+// default is the official order, A+B in the list runs IOR and mdtest phases
+// concurrently on disjoint sets of the processes; returns 1 if the schedule is the official one.
+// With options->resume the results of the phases recorded in the state file
+// are loaded and these phases are dropped from the schedule.
+int io500_phases_schedule(io500_options_t * options);
+// run the schedule, records each completed phase in the state file
+void io500_phases_run(io500_options_t * options);
+
+void io500_phase_print(FILE * out, io500_phase_t * phase);
+void io500_phases_print_summary(FILE * out, int official);
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ * License: MIT license
+ */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "io500-score.h"
+
+static const char * bw_phases[] = {"ior_easy_write", "ior_easy_read", "ior_hard_write", "ior_hard_read", NULL};
+static const char * md_phases[] = {"mdtest_easy_create", "mdtest_easy_stat", "mdtest_easy_delete",
+  "mdtest_hard_create", "mdtest_hard_read", "mdtest_hard_stat", "mdtest_hard_delete", NULL};
+// the find phases count as one value: the files scanned by both over their total time
+static const char * find_phases[] = {"find-easy", "find-hard", NULL};
+
+double io500_phase_value(io500_phase_t * p){
+  switch(p->kind){
+    case IO500_PHASE_IOR:{
+      double time = p->read ? p->ior->results->readTime[0] : p->ior->results->writeTime[0];
+      return p->ior->results->aggFileSizeFromXfer[0] / 1024.0 / 1024.0 / 1024.0 / time;
+    }
+    case IO500_PHASE_MDTEST:
+      return p->md->rate[p->md_pos] / 1000;
+    case IO500_PHASE_FIND:
+      return p->find->rate / 1000;
+    default:
+      return NAN;
+  }
+}
+
+int io500_phase_invalid(io500_phase_t * p, io500_options_t * o, char * buf, size_t size){
+  if(p->runs == 0){
+    snprintf(buf, size, "not run");
+    return 1;
+  }
+  if(p->concurrent){
+    snprintf(buf, size, "ran concurrently as %s", p->concurrent);
+    return 1;
+  }
+  double val = io500_phase_value(p);
+  if(! isfinite(val) || val <= 0){
+    snprintf(buf, size, "no result");
+    return 1;
+  }
+  // the create phases must be stopped by the stonewall, not by running out of work
+  double time = -1;
+  if(p->kind == IO500_PHASE_IOR && ! p->read){
+    time = p->ior->results->writeTime[0];
+  }else if(p->kind == IO500_PHASE_MDTEST && p->md_pos == MDTEST_FILE_CREATE_NUM){
+    time = p->md->time[p->md_pos];
+  }
+  if(time >= 0 && time < o->stonewall_timer){
+    snprintf(buf, size, "runtime %.1fs is shorter than the stonewall timer of %ds", time, o->stonewall_timer);
+    return 1;
+  }
+  if(p->kind == IO500_PHASE_FIND){
+    if(p->find->errors > 0){
+      snprintf(buf, size, "%ld errors", (long) p->find->errors);
+      return 1;
+    }
+    if(o->find_expression){
+      snprintf(buf, size, "custom find expression (-q)");
+      return 1;
+    }
+    if(o->find_dont_sync){
+      snprintf(buf, size, "uses cached attributes (-Y)");
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// add the logarithms of the phase values to sum, clears complete or valid if a phase lacks
+static void io500_log_sum(const char ** names, io500_options_t * o, io500_score_t * score, double * sum, int * count){
+  char reason[256];
+  for(int i=0; names[i] != NULL; i++){
+    io500_phase_t * p = io500_phase_find(names[i]);
+    if(p->runs == 0){
+      score->complete = 0;
+      continue;
+    }
+    if(io500_phase_invalid(p, o, reason, sizeof(reason))){
+      score->valid = 0;
+    }
+    *sum += log(io500_phase_value(p));
+    (*count)++;
+  }
+}
+
+static void io500_log_sum_find(io500_options_t * o, io500_score_t * score, double * sum, int * count){
+  char reason[256];
+  double files = 0;
+  double time = 0;
+  for(int i=0; find_phases[i] != NULL; i++){
+    io500_phase_t * p = io500_phase_find(find_phases[i]);
+    if(p->runs == 0){
+      score->complete = 0;
+      return;
+    }
+    if(io500_phase_invalid(p, o, reason, sizeof(reason))){
+      score->valid = 0;
+    }
+    files += p->find->total_files;
+    time += p->find->runtime;
+  }
+  *sum += log(files / time / 1000);
+  (*count)++;
+}
+
+void io500_score(io500_options_t * o, int official, io500_score_t * score){
+  double sum = 0;
+  int count = 0;
+  score->complete = 1;
+  score->valid = 1;
+
+  io500_log_sum(bw_phases, o, score, & sum, & count);
+  score->bw = count ? exp(sum / count) : NAN;
+
+  sum = 0;
+  count = 0;
+  io500_log_sum(md_phases, o, score, & sum, & count);
+  io500_log_sum_find(o, score, & sum, & count);
+  score->md = count ? exp(sum / count) : NAN;
+
+  score->total = sqrt(score->bw * score->md);
+  // the phases of a resumed run ran in different jobs
+  if(! score->complete || ! official || o->resume || o->stonewall_timer < IO500_MIN_STONEWALL){
+    score->valid = 0;
+  }
+}
+
+static void io500_print_invalid(FILE * out, const char ** names, io500_options_t * o){
+  char reason[256];
+  for(int i=0; names[i] != NULL; i++){
+    io500_phase_t * p = io500_phase_find(names[i]);
+    if(io500_phase_invalid(p, o, reason, sizeof(reason))){
+      fprintf(out, "[Invalid] %s: %s\n", p->name, reason);
+    }
+  }
+}
+
+void io500_print_score(FILE * out, io500_options_t * o, int official, io500_score_t * score){
+  fprintf(out, "[Score] Bandwidth %.6f GiB/s : IOPS %.6f kiops : TOTAL %.6f%s\n",
+    score->bw, score->md, score->total, score->valid ? "" : " [INVALID]");
+  if(! official){
+    fprintf(out, "[Invalid] run: not the official phase schedule\n");
+  }
+  if(o->resume){
+    fprintf(out, "[Invalid] run: resumed from an earlier job\n");
+  }
+  if(o->stonewall_timer < IO500_MIN_STONEWALL){
+    fprintf(out, "[Invalid] run: stonewall timer of %ds is below %ds\n", o->stonewall_timer, IO500_MIN_STONEWALL);
+  }
+  io500_print_invalid(out, bw_phases, o);
+  io500_print_invalid(out, md_phases, o);
+  io500_print_invalid(out, find_phases, o);
+  fflush(out);
+}
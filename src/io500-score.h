@@ -0,0 +1,28 @@
+#ifndef _IO500_SCORE_H
+#define _IO500_SCORE_H
+
+#include <stdio.h>
+
+#include "io500-types.h"
+#include "io500-phases.h"
+
+#define IO500_MIN_STONEWALL 300 // seconds the create phases must run for a valid submission
+
+typedef struct{
+  double bw;     // geometric mean of the IOR phases in GiB/s
+  double md;     // geometric mean of the metadata phases in kIOPS
+  double total;  // geometric mean of both
+  int complete;  // all phases of the score were run
+  int valid;     // complete and no phase or option makes the run invalid
+} io500_score_t;
+
+// result of a phase in GiB/s or kIOPS
+double io500_phase_value(io500_phase_t * phase);
+// write the reason why the result of the phase does not count into buf,
+// returns 0 if the phase is valid
+int io500_phase_invalid(io500_phase_t * phase, io500_options_t * options, char * buf, size_t size);
+
+void io500_score(io500_options_t * options, int official, io500_score_t * score);
+void io500_print_score(FILE * out, io500_options_t * options, int official, io500_score_t * score);
+
+#endif
@@ -2,6 +2,7 @@
 #define _IO500_TYPES_H
 
 #include <stdint.h>
+#include <mpi.h>
 
 typedef struct{
   char * backend_name_bandwidth;
@@ -16,6 +17,7 @@ typedef struct{
   int iorhard_max_segments;
   int mdhard_max_files;
   int mdeasy_max_files;
+  int mdmixed_working_set;
   int stonewall_timer;
   int stonewall_timer_reads;
   int stonewall_timer_delete;
@@ -23,19 +25,57 @@ typedef struct{
   int log_all_procs;
 
   int only_cleanup;
+  int run_mdtest_mixed;
+  int find_dont_sync;
+  char * find_expression;
+  int find_threads;
+  char * phases;      // phase list to run instead of the official schedule, @FILE reads it from a file
+  char * skip_phases; // phases to leave out of the schedule
+  int resume;         // continue after the phases recorded in the state file
 
   int verbosity;
   int write_output_to_log;
 
   FILE * output;
+
+  // the processes running the IOR and mdtest phases, a part of
+  // MPI_COMM_WORLD if phases run concurrently
+  MPI_Comm comm;
+  int rank;
 } io500_options_t;
 
+// distribution of a per-rank counter over all ranks
+typedef struct{
+  double min;
+  double median;
+  double max;
+} io500_find_dist_t;
+
 typedef struct{
   uint64_t errors;
 
   uint64_t found_files;
   uint64_t total_files;
 
+  uint64_t deleted_files;
+  uint64_t deleted_dirs;
+
+  // load-balance counters of this rank
+  uint64_t dirs_read;
+  uint64_t entries_scanned;
+  uint64_t stats_issued;
+  int64_t items_received; // work items processed minus produced, > 0 if other ranks handed work to this one
+  int64_t bytes_received; // the same in bytes of work items
+  double idle_time;       // time in the work loop without an item to process
+
+  // distribution of the counters above, valid on rank 0
+  io500_find_dist_t dist_dirs;
+  io500_find_dist_t dist_entries;
+  io500_find_dist_t dist_stats;
+  io500_find_dist_t dist_received;
+  io500_find_dist_t dist_bytes;
+  io500_find_dist_t dist_idle;
+
   double rate;
   double runtime;
 } io500_find_results_t;
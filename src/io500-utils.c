@@ -18,11 +18,13 @@ void io500_replace_str(char * str){
   }
 }
 
-char ** io500_str_to_arr_prep_exec(char * str, int * out_count){
-  // str is separated on "\n"
+char ** io500_str_to_argv(const char * prog, const char * str, int * out_count){
+  // str is separated on "\n", the arguments point into a copy of it
+  char * buf = malloc(strlen(prog) + strlen(str) + 2);
+  sprintf(buf, "%s\n%s", prog, str);
   int cnt = 1;
-  for(int i=0; str[i] != 0; i++){
-    if(str[i] == '\n'){
+  for(int i=0; buf[i] != 0; i++){
+    if(buf[i] == '\n'){
       cnt++;
     }
   }
@@ -30,20 +32,14 @@ char ** io500_str_to_arr_prep_exec(char * str, int * out_count){
   *out_count = cnt;
 
   int pos = 0;
-  out_arr[pos] = & str[0];
-  if(io500_rank == 0)
-    printf("[Exec]:");
-  for(int i=0; str[i] != 0; i++){
-    if(str[i] == '\n'){
+  out_arr[pos] = & buf[0];
+  for(int i=0; buf[i] != 0; i++){
+    if(buf[i] == '\n'){
       pos++;
-      out_arr[pos] = & str[i+1];
-      str[i] = 0;
-      if(io500_rank == 0)
-        printf(" \"%s\"", out_arr[pos - 1]);
+      out_arr[pos] = & buf[i+1];
+      buf[i] = 0;
     }
   }
-  if(io500_rank == 0)
-    printf(" \"%s\"\n", out_arr[pos]);
   return out_arr;
 }
 
@@ -54,9 +50,46 @@ void io500_error(char * const str){
   MPI_Abort(MPI_COMM_WORLD, 1);
 }
 
+int io500_bcast_probe(int ret, void * buf, size_t size){
+  MPI_Bcast(& ret, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  if(size > 0){
+    MPI_Bcast(buf, size, MPI_BYTE, 0, MPI_COMM_WORLD);
+  }
+  return ret;
+}
+
+char * io500_read_file_bcast(const char * fname){
+  long len = -1;
+  char * buf = NULL;
+  if(io500_rank == 0){
+    FILE * f = fopen(fname, "r");
+    if(f != NULL){
+      fseek(f, 0, SEEK_END);
+      len = ftell(f);
+      fseek(f, 0, SEEK_SET);
+      buf = malloc(len + 1);
+      if(fread(buf, 1, len, f) != (size_t) len){
+        len = -1;
+        free(buf);
+      }
+      fclose(f);
+    }
+  }
+  len = io500_bcast_probe(len, NULL, 0);
+  if(len < 0){
+    return NULL;
+  }
+  if(io500_rank != 0){
+    buf = malloc(len + 1);
+  }
+  io500_bcast_probe(0, buf, len);
+  buf[len] = 0;
+  return buf;
+}
+
 
 FILE * io500_prepare_out(char * suffix, int testID, io500_options_t * options){
-  if(io500_rank == 0 || options->log_all_procs){
+  if(options->rank == 0 || options->log_all_procs){
     char out[10000];
     if(options->log_all_procs){
       sprintf(out, "%s/%s-%d-%d.log", options->results_dir, suffix, io500_rank, testID);
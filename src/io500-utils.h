@@ -10,7 +10,17 @@ extern int io500_rank;
 FILE * io500_prepare_out(char * suffix, int testID, io500_options_t * options);
 
 void io500_replace_str(char * str);
-char ** io500_str_to_arr_prep_exec(char * str, int * out_count);
+// the options str separated by "\n" as argument vector for the option parsers
+// of IOR and mdtest with argv[0] = prog; free argv[0] and the vector
+char ** io500_str_to_argv(const char * prog, const char * str, int * out_count);
 void io500_error(char * const str);
 
+// setup probes (stat, open, realpath) are performed by rank 0 only, otherwise
+// all ranks hit the same inode at once before any measurement starts.
+// Collective: rank 0 passes the return code and result of its probe, all
+// ranks return that code with buf holding the result of rank 0.
+int io500_bcast_probe(int ret, void * buf, size_t size);
+// collective: rank 0 reads the file, returns its content on all ranks or NULL
+char * io500_read_file_bcast(const char * fname);
+
 #endif
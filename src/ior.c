@@ -38,9 +38,6 @@
 /* file scope globals */
 extern char **environ;
 
-static const ior_aiori_t *backend;
-static int totalErrorCount = 0;
-
 
 static void DestroyTests(IOR_test_t *tests_head);
 static void DisplayUsage(char **);
@@ -50,6 +47,8 @@ static char **ParseFileName(char *, int *);
 static void PrintEarlyHeader();
 static void PrintHeader(int argc, char **argv);
 static IOR_test_t *SetupTests(int, char **);
+static void PrepareTests(IOR_test_t *);
+static void RunTests(IOR_test_t *);
 static void ShowTestInfo(IOR_param_t *);
 static void ShowSetup(IOR_param_t *params);
 static void ShowTest(IOR_param_t *);
@@ -61,7 +60,6 @@ static void WriteTimes(IOR_param_t *, double **, int, int);
 
 IOR_test_t * ior_run(int argc, char **argv, MPI_Comm world_com, FILE * world_out){
         IOR_test_t *tests_head;
-        IOR_test_t *tptr;
         out_logfile = world_out;
         mpi_comm_world = world_com;
 
@@ -87,7 +85,41 @@ IOR_test_t * ior_run(int argc, char **argv, MPI_Comm world_com, FILE * world_out
 
         PrintHeader(argc, argv);
 
-        /* perform each test */
+        RunTests(tests_head);
+        return tests_head;
+}
+
+IOR_test_t * ior_run_params(IOR_param_t * params, MPI_Comm world_com, FILE * world_out){
+        IOR_test_t *test;
+        out_logfile = world_out;
+        mpi_comm_world = world_com;
+
+        MPI_CHECK(MPI_Comm_size(mpi_comm_world, &numTasksWorld), "cannot get number of tasks");
+        MPI_CHECK(MPI_Comm_rank(mpi_comm_world, &rank), "cannot get rank");
+        PrintEarlyHeader();
+
+        /* the same steps as SetupTests() for a single test */
+        tasksPerNode = CountTasksPerNode(numTasksWorld, mpi_comm_world);
+        test = CreateTest(params, 0);
+        AllocResults(test);
+        CheckRunSettings(test);
+        PrepareTests(test);
+        verbose = test->params.verbose;
+        test->params.testComm = world_com;
+
+        PrintHeader(0, NULL);
+
+        RunTests(test);
+        return test;
+}
+
+/*
+ * Perform each test of the list and print the summary.
+ */
+static void RunTests(IOR_test_t *tests_head)
+{
+        IOR_test_t *tptr;
+
         for (tptr = tests_head; tptr != NULL; tptr = tptr->next) {
                 verbose = tptr->params.verbose;
                 if (rank == 0 && verbose >= VERBOSE_0) {
@@ -102,8 +134,6 @@ IOR_test_t * ior_run(int argc, char **argv, MPI_Comm world_com, FILE * world_out
                 if(rank == 0 && tptr->params.stoneWallingWearOut){
                   fprintf(out_logfile, "Pairs deadlineForStonewallingaccessed: %lld\n", (long long) tptr->results->pairs_accessed);
                 }
-                tptr->results->errors = totalErrorCount;
-                totalErrorCount = 0;
         }
 
         PrintLongSummaryAllTests(tests_head);
@@ -113,7 +143,6 @@ IOR_test_t * ior_run(int argc, char **argv, MPI_Comm world_com, FILE * world_out
                 fprintf(out_logfile, "\n");
                 fprintf(out_logfile, "Finished: %s", CurrentTimeString());
         }
-        return tests_head;
 }
 
 
@@ -122,6 +151,7 @@ IOR_test_t * ior_run(int argc, char **argv, MPI_Comm world_com, FILE * world_out
 int main(int argc, char **argv)
 {
         int i;
+        int errors = 0;
         IOR_test_t *tests_head;
         IOR_test_t *tptr;
         out_logfile = stdout;
@@ -215,6 +245,9 @@ int main(int argc, char **argv)
                 fprintf(out_logfile, "Finished: %s", CurrentTimeString());
         }
 
+        for (tptr = tests_head; tptr != NULL; tptr = tptr->next) {
+                errors += tptr->results->errors;
+        }
         DestroyTests(tests_head);
 
         MPI_CHECK(MPI_Finalize(), "cannot finalize MPI");
@@ -225,7 +258,7 @@ int main(int argc, char **argv)
         aws_cleanup();
 #endif
 
-        return (totalErrorCount);
+        return (errors);
 }
 
 /***************************** F U N C T I O N S ******************************/
@@ -283,8 +316,8 @@ void init_IOR_Param_t(IOR_param_t * p)
 
 static void AioriBind(char* api, IOR_param_t* param)
 {
-        backend = aiori_select (api);
-        if (NULL != backend) {
+        param->backend = aiori_select (api);
+        if (NULL != param->backend) {
                 if (! strncmp(api, "S3", 2)) {
                         if (! strcmp(api, "S3_EMC")) {
                                 param->curl_flags |= IOR_CURL_S3_EMC_EXT;
@@ -516,7 +549,6 @@ static int CountErrors(IOR_param_t * test, int access, int errors)
                 MPI_CHECK(MPI_Bcast(&allErrors, 1, MPI_INT, 0, testComm),
                           "cannot broadcast allErrors value");
                 if (allErrors != 0) {
-                        totalErrorCount += allErrors;
                         test->errorFound = TRUE;
                 }
                 if (rank == 0 && allErrors != 0) {
@@ -1296,7 +1328,7 @@ static void RemoveFile(char *testFileName, int filePerProc, IOR_param_t * test)
                         GetTestFileName(testFileName, test);
                 }
                 if (access(testFileName, F_OK) == 0) {
-                        backend->delete(testFileName, test);
+                        test->backend->delete(testFileName, test);
                 }
                 if (test->reorderTasksRandom == TRUE) {
                         rankOffset = tmpRankOffset;
@@ -1310,7 +1342,7 @@ static void RemoveFile(char *testFileName, int filePerProc, IOR_param_t * test)
                 //      "file".
                 //
                 if ((rank == 0) && (access(testFileName, F_OK) == 0)) {
-                        backend->delete(testFileName, test);
+                        test->backend->delete(testFileName, test);
                 }
         }
 }
@@ -1321,12 +1353,22 @@ static void RemoveFile(char *testFileName, int filePerProc, IOR_param_t * test)
  */
 static IOR_test_t *SetupTests(int argc, char **argv)
 {
-        IOR_test_t *tests, *testsHead;
+        IOR_test_t *testsHead;
 
         /* count the tasks per node */
         tasksPerNode = CountTasksPerNode(numTasksWorld, mpi_comm_world);
 
-        testsHead = tests = ParseCommandLine(argc, argv);
+        testsHead = ParseCommandLine(argc, argv);
+        PrepareTests(testsHead);
+
+        return (testsHead);
+}
+
+/*
+ * Validate the tests of the list and prepare the run of them.
+ */
+static void PrepareTests(IOR_test_t *tests)
+{
         /*
          * Since there is no guarantee that anyone other than
          * task 0 has the environment settings for the hints, pass
@@ -1344,8 +1386,6 @@ static IOR_test_t *SetupTests(int argc, char **argv)
 
         /* seed random number generator */
         SeedRandGen(mpi_comm_world);
-
-        return (testsHead);
 }
 
 /*
@@ -1410,11 +1450,13 @@ static void PrintHeader(int argc, char **argv)
                 return;
 
         fprintf(out_logfile, "Began: %s", CurrentTimeString());
-        fprintf(out_logfile, "Command line used: %s", argv[0]);
-        for (i = 1; i < argc; i++) {
-                fprintf(out_logfile, " \"%s\"", argv[i]);
+        if (argc > 0) {
+                fprintf(out_logfile, "Command line used: %s", argv[0]);
+                for (i = 1; i < argc; i++) {
+                        fprintf(out_logfile, " \"%s\"", argv[i]);
+                }
+                fprintf(out_logfile, "\n");
         }
-        fprintf(out_logfile, "\n");
         if (uname(&unamebuf) != 0) {
                 EWARN("uname failed");
                 fprintf(out_logfile, "Machine: Unknown");
@@ -2057,7 +2099,7 @@ static void TestIoSys(IOR_test_t *test)
                         MPI_CHECK(MPI_Barrier(testComm), "barrier error");
                         params->open = WRITE;
                         timer[0][rep] = GetTimeStamp();
-                        fd = backend->create(testFileName, params);
+                        fd = params->backend->create(testFileName, params);
                         timer[1][rep] = GetTimeStamp();
                         if (params->intraTestBarriers)
                                 MPI_CHECK(MPI_Barrier(testComm),
@@ -2078,14 +2120,14 @@ static void TestIoSys(IOR_test_t *test)
                                 MPI_CHECK(MPI_Barrier(testComm),
                                           "barrier error");
                         timer[4][rep] = GetTimeStamp();
-                        backend->close(fd, params);
+                        params->backend->close(fd, params);
 
                         timer[5][rep] = GetTimeStamp();
                         MPI_CHECK(MPI_Barrier(testComm), "barrier error");
 
                         /* get the size of the file just written */
                         results->aggFileSizeFromStat[rep] =
-                                backend->get_file_size(params, testComm, testFileName);
+                                params->backend->get_file_size(params, testComm, testFileName);
 
                         /* check if stat() of file doesn't equal expected file size,
                            use actual amount of byte moved */
@@ -2120,9 +2162,9 @@ static void TestIoSys(IOR_test_t *test)
 
                         GetTestFileName(testFileName, params);
                         params->open = WRITECHECK;
-                        fd = backend->open(testFileName, params);
+                        fd = params->backend->open(testFileName, params);
                         dataMoved = WriteOrRead(params, results, fd, WRITECHECK, &ioBuffers);
-                        backend->close(fd, params);
+                        params->backend->close(fd, params);
                         rankOffset = 0;
                 }
                 /*
@@ -2182,7 +2224,7 @@ static void TestIoSys(IOR_test_t *test)
                         MPI_CHECK(MPI_Barrier(testComm), "barrier error");
                         params->open = READ;
                         timer[6][rep] = GetTimeStamp();
-                        fd = backend->open(testFileName, params);
+                        fd = params->backend->open(testFileName, params);
                         timer[7][rep] = GetTimeStamp();
                         if (params->intraTestBarriers)
                                 MPI_CHECK(MPI_Barrier(testComm),
@@ -2199,12 +2241,12 @@ static void TestIoSys(IOR_test_t *test)
                                 MPI_CHECK(MPI_Barrier(testComm),
                                           "barrier error");
                         timer[10][rep] = GetTimeStamp();
-                        backend->close(fd, params);
+                        params->backend->close(fd, params);
                         timer[11][rep] = GetTimeStamp();
 
                         /* get the size of the file just read */
                         results->aggFileSizeFromStat[rep] =
-                                backend->get_file_size(params, testComm,
+                                params->backend->get_file_size(params, testComm,
                                                        testFileName);
 
                         /* check if stat() of file doesn't equal expected file size,
@@ -2267,7 +2309,7 @@ static void ValidateTests(IOR_param_t * test)
 
         /* get the version of the tests */
         AioriBind(test->api, test);
-        backend->set_version(test);
+        test->backend->set_version(test);
 
         if (test->repetitions <= 0)
                 WARN_RESET("too few test repetitions",
@@ -2548,18 +2590,18 @@ static IOR_offset_t WriteOrReadSingle(IOR_offset_t pairCnt, IOR_offset_t *offset
                   FillBuffer(buffer, test, test->offset, pretendRank);
           }
           amtXferred =
-                  backend->xfer(access, fd, buffer, transfer, test);
+                  test->backend->xfer(access, fd, buffer, transfer, test);
           if (amtXferred != transfer)
                   ERR("cannot write to file");
   } else if (access == READ) {
           amtXferred =
-                  backend->xfer(access, fd, buffer, transfer, test);
+                  test->backend->xfer(access, fd, buffer, transfer, test);
           if (amtXferred != transfer)
                   ERR("cannot read from file");
   } else if (access == WRITECHECK) {
           memset(checkBuffer, 'a', transfer);
           amtXferred =
-                  backend->xfer(access, fd, checkBuffer, transfer,
+                  test->backend->xfer(access, fd, checkBuffer, transfer,
                                 test);
           if (amtXferred != transfer)
                   ERR("cannot read from file write check");
@@ -2568,7 +2610,7 @@ static IOR_offset_t WriteOrReadSingle(IOR_offset_t pairCnt, IOR_offset_t *offset
                                    *transferCount, test,
                                    WRITECHECK);
   } else if (access == READCHECK) {
-          amtXferred = backend->xfer(access, fd, buffer, transfer, test);
+          amtXferred = test->backend->xfer(access, fd, buffer, transfer, test);
           if (amtXferred != transfer){
             ERR("cannot read from file");
           }
@@ -2606,21 +2648,19 @@ static IOR_offset_t WriteOrRead(IOR_param_t * test, IOR_results_t * results, voi
         }
 
 
-        /* check for stonewall */
+        /* check for stonewall, the deadline timer sets the flag */
         startForStonewall = GetTimeStamp();
-        hitStonewall = ((test->deadlineForStonewalling != 0)
-                        && ((GetTimeStamp() - startForStonewall)
-                            > test->deadlineForStonewalling));
+        StartDeadline(test->deadlineForStonewalling);
+        hitStonewall = DeadlineReached();
 
         /* loop over offsets to access */
         while ((offsetArray[pairCnt] != -1) && !hitStonewall ) {
                 dataMoved += WriteOrReadSingle(pairCnt, offsetArray, pretendRank, & transferCount, & errors, test, fd, ioBuffers, access);
                 pairCnt++;
 
-                hitStonewall = ((test->deadlineForStonewalling != 0)
-                                && ((GetTimeStamp() - startForStonewall)
-                                    > test->deadlineForStonewalling)) || (test->stoneWallingWearOutIterations != 0 && pairCnt == test->stoneWallingWearOutIterations) ;
+                hitStonewall = DeadlineReached() || (test->stoneWallingWearOutIterations != 0 && pairCnt == test->stoneWallingWearOutIterations) ;
         }
+        StopDeadline();
         if (test->stoneWallingWearOut){
           if (verbose >= VERBOSE_1){
             fprintf(out_logfile, "%d: stonewalling pairs accessed: %lld\n", rank, (long long) pairCnt);
@@ -2659,12 +2699,12 @@ static IOR_offset_t WriteOrRead(IOR_param_t * test, IOR_results_t * results, voi
         }
 
 
-        totalErrorCount += CountErrors(test, access, errors);
+        results->errors += CountErrors(test, access, errors);
 
         free(offsetArray);
 
         if (access == WRITE && test->fsync == TRUE) {
-                backend->fsync(fd, test);       /*fsync after all accesses */
+                test->backend->fsync(fd, test);       /*fsync after all accesses */
         }
         return (dataMoved);
 }
@@ -40,6 +40,9 @@
 
 
 #include "iordef.h"
+
+struct ior_aiori;
+
 /******************** DATA Packet Type ***************************************/
 /* Holds the types of data packets: generic, offset, timestamp, incompressible */
 
@@ -88,6 +91,7 @@ typedef struct
     unsigned int openFlags;          /* open flags (see also <open>) */
     int referenceNumber;             /* user supplied reference number */
     char api[MAX_STR];               /* API for I/O */
+    const struct ior_aiori * backend; /* backend of the API, bound when the test is validated */
     char apiVersion[MAX_STR];        /* API version */
     char platform[MAX_STR];          /* platform type */
     char testFileName[MAXPATHLEN];   /* full name for test */
@@ -243,4 +247,10 @@ int CountTasksPerNode(int numTasks, MPI_Comm comm);
  */
 IOR_test_t * ior_run(int argc, char **argv, MPI_Comm world_com, FILE * out_logfile);
 
+/*
+ * Run a single test with the parameters params, set up with
+ * init_IOR_Param_t() and ParseOptions(); the parameters are copied.
+ */
+IOR_test_t * ior_run_params(IOR_param_t * params, MPI_Comm world_com, FILE * out_logfile);
+
 #endif /* !_IOR_H */
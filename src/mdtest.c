@@ -29,10 +29,15 @@
  *   $Author: brettkettering $
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE             /* O_DIRECT */
+#endif
+
 #include <limits.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <fcntl.h>
 #include <stdbool.h>
 #include <inttypes.h>
 #include <sys/types.h>
@@ -86,82 +91,105 @@
 
 #define LLU "%lu"
 
-//int rank;
-static int size;
-static uint64_t *rand_array;
-static char testdir[MAX_LEN];
-static char testdirpath[MAX_LEN];
-static char top_dir[MAX_LEN];
-static char base_tree_name[MAX_LEN];
-static char **filenames;
-static char hostname[MAX_LEN];
-static char unique_dir[MAX_LEN];
-static char mk_name[MAX_LEN];
-static char stat_name[MAX_LEN];
-static char read_name[MAX_LEN];
-static char rm_name[MAX_LEN];
-static char unique_mk_dir[MAX_LEN];
-static char unique_chdir_dir[MAX_LEN];
-static char unique_stat_dir[MAX_LEN];
-static char unique_read_dir[MAX_LEN];
-static char unique_rm_dir[MAX_LEN];
-static char unique_rm_uni_dir[MAX_LEN];
-static char *write_buffer;
-static char *read_buffer;
-
-static int barriers;
-static int create_only;
-static int stat_only;
-static int read_only;
-static int remove_only;
-static int leaf_only;
-static unsigned branch_factor;
-static int depth;
+static const char *name_scheme_names[] = {"sequential", "hex", "long", "prefix", NULL};
+static const char *sync_mode_names[] = {"none", "fsync", "fdatasync", "dsync", NULL};
 
 /*
- * This is likely a small value, but it's sometimes computed by
- * branch_factor^(depth+1), so we'll make it a larger variable,
- * just in case.
+ * Latency histogram with logarithmic buckets: latencies below 8ns get a
+ * bucket each, above every power of two is split into 8 buckets, so a
+ * bucket is at most 12.5% wide.
  */
-static uint64_t num_dirs_in_tree;
+#define LATENCY_SUB_BUCKETS 8
+#define LATENCY_BUCKETS MDTEST_LATENCY_BUCKETS /* 41 powers of two */
+
+typedef struct {
+    uint64_t count[LATENCY_BUCKETS];
+    double max;
+} latency_hist_t;
+
+/* items completed by this process at the end of every interval of a phase */
+typedef struct {
+    int active;
+    double start;
+    double end;
+    uint64_t items;
+    int count;
+    int max;
+    uint64_t *samples;
+} rate_series_t;
+
 /*
- * As we start moving towards Exascale, we could have billions
- * of files in a directory. Make room for that possibility with
- * a larger variable.
+ * The state of a run, every function of the benchmark works on the context
+ * it is given, so runs on different communicators do not share any state.
  */
-static uint64_t items_per_dir;
-static int print_time;
-static int random_seed;
-static int shared_file;
-static int files_only;
-static int dirs_only;
-static int pre_delay;
-static int unique_dir_per_task;
-static int time_unique_dir_overhead;
-static int throttle;
-static uint64_t items;
-static int collective_creates;
-static size_t write_bytes;
-static int stone_wall_timer_seconds;
-static size_t read_bytes;
-static int sync_file;
-static int path_count;
-static int nstride; /* neighbor stride */
-
-static mdtest_results_t * summary_table;
-static pid_t pid;
-static uid_t uid;
-
-/* just use the POSIX backend for now */
-static const char *backend_name = "POSIX";
-static const ior_aiori_t *backend;
-
-static IOR_param_t param;
+struct mdtest_ctx {
+    mdtest_options_t o;   /* copy of the options, the run adjusts some */
+
+    MPI_Comm comm;        /* the processes of the current test */
+    int rank;
+    int size;             /* of the communicator the run was started on */
+    FILE *out;
+
+    uint64_t *rand_array;
+    char testdir[MAX_LEN];
+    char testdirpath[MAX_LEN];
+    char top_dir[MAX_LEN];
+    char base_tree_name[MAX_LEN];
+    char *dirpath;        /* copy of o.dirpath, filenames point into it */
+    char **filenames;
+    int path_count;
+    char hostname[MAX_LEN];
+    char datestring[80];  /* returned by print_timestamp() */
+    char unique_dir[MAX_LEN];
+    char mk_name[MAX_LEN];
+    char stat_name[MAX_LEN];
+    char read_name[MAX_LEN];
+    char rm_name[MAX_LEN];
+    char unique_mk_dir[MAX_LEN];
+    char unique_chdir_dir[MAX_LEN];
+    char unique_stat_dir[MAX_LEN];
+    char unique_read_dir[MAX_LEN];
+    char unique_rm_dir[MAX_LEN];
+    char unique_rm_uni_dir[MAX_LEN];
+    char *write_buffer;
+    char *read_buffer;
+
+    /*
+     * This is likely a small value, but it's sometimes computed by
+     * branch_factor^(depth+1), so we'll make it a larger variable,
+     * just in case.
+     */
+    uint64_t num_dirs_in_tree;
+
+    /* small-file data path: POSIX calls with flags preset once instead of the generic AIORI path */
+    int small_create_flags;
+    int small_open_flags;
+    size_t write_io_size;  /* bytes transferred, rounded up to the alignment with O_DIRECT */
+    size_t read_io_size;
+    uint64_t verify_errors;
+
+    latency_hist_t latency_hist[MDTEST_LATENCY_LAST_NUM];  /* this process, current iteration */
+    latency_hist_t latency_total[MDTEST_LATENCY_LAST_NUM]; /* all processes and iterations */
+
+    rate_series_t rate_series[MDTEST_LAST_NUM];
+    rate_series_t *rate_series_current;
+
+    /* the processes an aggregator creates and removes items for with -c */
+    MPI_Comm aggregator_comm;
+    int *aggregator_owners;
+    int aggregator_owner_count;
+    int is_aggregator;
+
+    mdtest_results_t * summary_table;
+    pid_t pid;
+    uid_t uid;
+
+    const ior_aiori_t *backend;
+    IOR_param_t param;
+};
 
 /* This structure describes the processing status for stonewalling */
 typedef struct{
-  double start_time;
-
   int stone_wall_timer_seconds;
   long long unsigned items_done;
 
@@ -169,52 +197,52 @@ typedef struct{
   uint64_t items_per_dir;
 } rank_progress_t;
 
-#define CHECK_STONE_WALL(p) (((p)->stone_wall_timer_seconds != 0) && ((GetTimeStamp() - (p)->start_time) > (p)->stone_wall_timer_seconds))
+/* the deadline is armed once for the whole run, the check only reads its flag */
+#define CHECK_STONE_WALL(p) (((p)->stone_wall_timer_seconds != 0) && DeadlineReached())
 
 /* for making/removing unique directory && stating/deleting subdirectory */
 enum {MK_UNI_DIR, STAT_SUB_DIR, READ_SUB_DIR, RM_SUB_DIR, RM_UNI_DIR};
 
 #ifdef __linux__
 #define FAIL(msg) do {                                                  \
-        fprintf(out_logfile, "%s: Process %d(%s): FAILED in %s, %s: %s\n",   \
-                print_timestamp(), rank, hostname, __func__,            \
+        fprintf(ctx->out, "%s: Process %d(%s): FAILED in %s, %s: %s\n",   \
+                print_timestamp(ctx), ctx->rank, ctx->hostname, __func__,            \
                 msg, strerror(errno));                                  \
-        fflush(out_logfile);                                                 \
-        MPI_Abort(testComm, 1);                                   \
+        fflush(ctx->out);                                                 \
+        MPI_Abort(ctx->comm, 1);                                   \
     } while(0)
 #else
 #define FAIL(msg) do {                                                  \
-        fprintf(out_logfile, "%s: Process %d(%s): FAILED at %d, %s: %s\n",   \
-                print_timestamp(), rank, hostname, __LINE__,            \
+        fprintf(ctx->out, "%s: Process %d(%s): FAILED at %d, %s: %s\n",   \
+                print_timestamp(ctx), ctx->rank, ctx->hostname, __LINE__,            \
                 msg, strerror(errno));                                  \
-        fflush(out_logfile);                                                 \
-        MPI_Abort(testComm, 1);                                   \
+        fflush(ctx->out);                                                 \
+        MPI_Abort(ctx->comm, 1);                                   \
     } while(0)
 #endif
 
-static char *print_timestamp() {
-    static char datestring[80];
+static char *print_timestamp(mdtest_ctx_t * ctx) {
     time_t cur_timestamp;
 
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering print_timestamp...\n" );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering print_timestamp...\n" );
     }
 
-    fflush(out_logfile);
+    fflush(ctx->out);
     cur_timestamp = time(NULL);
-    strftime(datestring, 80, "%m/%d/%Y %T", localtime(&cur_timestamp));
+    strftime(ctx->datestring, sizeof(ctx->datestring), "%m/%d/%Y %T", localtime(&cur_timestamp));
 
-    return datestring;
+    return ctx->datestring;
 }
 
 #if MPI_VERSION >= 3
-int count_tasks_per_node(void) {
+int count_tasks_per_node(mdtest_ctx_t * ctx) {
     /* modern MPI provides a simple way to get the local process count */
     MPI_Comm shared_comm;
     int rc, count;
 
-    MPI_Comm_split_type (testComm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &shared_comm);
+    MPI_Comm_split_type (ctx->comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &shared_comm);
 
     MPI_Comm_size (shared_comm, &count);
 
@@ -223,66 +251,66 @@ int count_tasks_per_node(void) {
     return count;
 }
 #else
-int count_tasks_per_node(void) {
+int count_tasks_per_node(mdtest_ctx_t * ctx) {
     char       localhost[MAX_LEN],
         hostname[MAX_LEN];
     int        count               = 1,
         i;
     MPI_Status status;
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering count_tasks_per_node...\n" );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering count_tasks_per_node...\n" );
+        fflush( ctx->out );
     }
 
     if (gethostname(localhost, MAX_LEN) != 0) {
         FAIL("gethostname()");
     }
-    if (rank == 0) {
+    if (ctx->rank == 0) {
         /* MPI_receive all hostnames, and compare to local hostname */
-        for (i = 0; i < size-1; i++) {
+        for (i = 0; i < ctx->size-1; i++) {
             MPI_Recv(hostname, MAX_LEN, MPI_CHAR, MPI_ANY_SOURCE,
-                     MPI_ANY_TAG, testComm, &status);
+                     MPI_ANY_TAG, ctx->comm, &status);
             if (strcmp(hostname, localhost) == 0) {
                 count++;
             }
         }
     } else {
         /* MPI_send hostname to root node */
-        MPI_Send(localhost, MAX_LEN, MPI_CHAR, 0, 0, testComm);
+        MPI_Send(localhost, MAX_LEN, MPI_CHAR, 0, 0, ctx->comm);
     }
-    MPI_Bcast(&count, 1, MPI_INT, 0, testComm);
+    MPI_Bcast(&count, 1, MPI_INT, 0, ctx->comm);
 
     return(count);
 }
 #endif
 
-void delay_secs(int delay) {
+void delay_secs(mdtest_ctx_t * ctx, int delay) {
 
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering delay_secs...\n" );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering delay_secs...\n" );
+        fflush( ctx->out );
     }
 
-    if (rank == 0 && delay > 0) {
-        if (verbose >= 1) {
-            fprintf(out_logfile, "delaying %d seconds . . .\n", delay);
-            fflush(out_logfile);
+    if (ctx->rank == 0 && delay > 0) {
+        if (ctx->o.verbose >= 1) {
+            fprintf(ctx->out, "delaying %d seconds . . .\n", delay);
+            fflush(ctx->out);
         }
         sleep(delay);
     }
-    MPI_Barrier(testComm);
+    MPI_Barrier(ctx->comm);
 }
 
-void offset_timers(double * t, int tcount) {
+void offset_timers(mdtest_ctx_t * ctx, double * t, int tcount) {
     double toffset;
     int i;
 
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering offset_timers...\n" );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering offset_timers...\n" );
+        fflush( ctx->out );
     }
 
     toffset = MPI_Wtime() - t[tcount];
@@ -291,147 +319,715 @@ void offset_timers(double * t, int tcount) {
     }
 }
 
-void parse_dirpath(char *dirpath_arg) {
+void parse_dirpath(mdtest_ctx_t * ctx, char *dirpath_arg) {
     char * tmp, * token;
     char delimiter_string[3] = { '@', '\n', '\0' };
     int i = 0;
 
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering parse_dirpath...\n" );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering parse_dirpath...\n" );
+        fflush( ctx->out );
     }
 
     tmp = dirpath_arg;
 
-    if (* tmp != '\0') path_count++;
+    if (* tmp != '\0') ctx->path_count++;
     while (* tmp != '\0') {
         if (* tmp == '@') {
-            path_count++;
+            ctx->path_count++;
         }
         tmp++;
     }
-    filenames = (char **)malloc(path_count * sizeof(char **));
-    if (filenames == NULL) {
+    ctx->filenames = (char **)malloc(ctx->path_count * sizeof(char **));
+    if (ctx->filenames == NULL) {
         FAIL("out of memory");
     }
 
     token = strtok(dirpath_arg, delimiter_string);
     while (token != NULL) {
-        filenames[i] = token;
+        ctx->filenames[i] = token;
         token = strtok(NULL, delimiter_string);
         i++;
     }
 }
 
+/* report an invalid option on the first process and stop all of them */
+static void option_fail(MPI_Comm com, FILE * out, const char *msg, const char *value) {
+    int r;
+
+    MPI_Comm_rank(com, &r);
+    if (r == 0) {
+        fprintf(out, "%s: %s\n", msg, value);
+        fflush(out);
+    }
+    MPI_Abort(com, 1);
+}
+
+/* parse a list of attribute names separated by '+', e.g. "size+ctime" */
+static int parse_stat_mask(char *value, MPI_Comm com, FILE * out) {
+    int mask = 0;
+    char *token, *saveptr = NULL;
+
+    for (token = strtok_r(value, "+", & saveptr); token != NULL; token = strtok_r(NULL, "+", & saveptr)) {
+        if (strcasecmp(token, "type") == 0) {
+            mask |= IOR_STATX_TYPE;
+        } else if (strcasecmp(token, "mode") == 0) {
+            mask |= IOR_STATX_MODE;
+        } else if (strcasecmp(token, "size") == 0) {
+            mask |= IOR_STATX_SIZE;
+        } else if (strcasecmp(token, "mtime") == 0) {
+            mask |= IOR_STATX_MTIME;
+        } else if (strcasecmp(token, "ctime") == 0) {
+            mask |= IOR_STATX_CTIME;
+        } else if (strcasecmp(token, "all") == 0) {
+            mask |= IOR_STATX_ALL;
+        } else {
+            option_fail(com, out, "statMask accepts type, mode, size, mtime, ctime and all", token);
+        }
+    }
+    return mask;
+}
+
+/*
+ * Set extended options from "key=value" pairs given with -O, similar to
+ * the IOR directives.
+ */
+static void decode_directive(mdtest_options_t * o, char *line, MPI_Comm com, FILE * out) {
+    char option[MAX_LEN];
+    char value[MAX_LEN];
+    int rc;
+
+    rc = sscanf(line, " %[^=# \t\r\n] = %[^# \t\r\n] ", option, value);
+    if (rc != 2) {
+        option_fail(com, out, "Syntax error in option", line);
+    }
+    if (strcasecmp(option, "mixedWorkingSet") == 0) {
+        o->mixed_working_set = (uint64_t) strtoul(value, NULL, 10);
+    } else if (strcasecmp(option, "mixedRatio") == 0) {
+        rc = sscanf(value, "%d:%d:%d:%d", & o->mixed_ratio[0], & o->mixed_ratio[1], & o->mixed_ratio[2], & o->mixed_ratio[3]);
+        if (rc != 4) {
+            option_fail(com, out, "mixedRatio must be given as create:stat:read:remove", value);
+        }
+    } else if (strcasecmp(option, "mixedRounds") == 0) {
+        o->mixed_rounds = (uint64_t) strtoul(value, NULL, 10);
+    } else if (strcasecmp(option, "mixedInterval") == 0) {
+        o->mixed_interval = atof(value);
+    } else if (strcasecmp(option, "collectiveAggregators") == 0) {
+        o->collective_aggregators = atoi(value);
+    } else if (strcasecmp(option, "list") == 0) {
+        o->list_phase = atoi(value);
+    } else if (strcasecmp(option, "listPlus") == 0) {
+        o->list_plus = atoi(value);
+    } else if (strcasecmp(option, "listBufferSize") == 0) {
+        o->list_buffer_size = (size_t) strtoull(value, NULL, 10);
+    } else if (strcasecmp(option, "rateSeries") == 0) {
+        o->rate_series_prefix = strdup(value);
+    } else if (strcasecmp(option, "rateInterval") == 0) {
+        o->rate_series_interval = atof(value);
+    } else if (strcasecmp(option, "nameScheme") == 0) {
+        for (o->name_scheme = 0; name_scheme_names[o->name_scheme] != NULL; o->name_scheme++) {
+            if (strcasecmp(value, name_scheme_names[o->name_scheme]) == 0) {
+                break;
+            }
+        }
+        if (name_scheme_names[o->name_scheme] == NULL) {
+            option_fail(com, out, "nameScheme must be sequential, hex, long or prefix", value);
+        }
+    } else if (strcasecmp(option, "nameLength") == 0) {
+        o->name_length = atoi(value);
+    } else if (strcasecmp(option, "smallFile") == 0) {
+        o->small_file = atoi(value);
+    } else if (strcasecmp(option, "directIO") == 0) {
+        o->direct_io = atoi(value);
+    } else if (strcasecmp(option, "syncMode") == 0) {
+        for (o->sync_mode = 0; sync_mode_names[o->sync_mode] != NULL; o->sync_mode++) {
+            if (strcasecmp(value, sync_mode_names[o->sync_mode]) == 0) {
+                break;
+            }
+        }
+        if (sync_mode_names[o->sync_mode] == NULL) {
+            option_fail(com, out, "syncMode must be none, fsync, fdatasync or dsync", value);
+        }
+    } else if (strcasecmp(option, "verify") == 0) {
+        o->verify_data = atoi(value);
+    } else if (strcasecmp(option, "ioAlignment") == 0) {
+        o->io_alignment = (size_t) strtoull(value, NULL, 10);
+    } else if (strcasecmp(option, "latency") == 0) {
+        o->measure_latency = atoi(value);
+    } else if (strcasecmp(option, "statMask") == 0) {
+        o->stat_mask = (o->stat_mask & IOR_STATX_DONT_SYNC) | parse_stat_mask(value, com, out);
+    } else if (strcasecmp(option, "statDontSync") == 0) {
+        if (atoi(value)) {
+            o->stat_mask |= IOR_STATX_DONT_SYNC;
+        } else {
+            o->stat_mask &= ~IOR_STATX_DONT_SYNC;
+        }
+    } else {
+        option_fail(com, out, "Unrecognized option", option);
+    }
+}
+
+/* parse a string with multiple comma separated directives */
+static void parse_directives(mdtest_options_t * o, char *line, MPI_Comm com, FILE * out) {
+    char *start, *end;
+
+    start = line;
+    do {
+        end = strchr(start, ',');
+        if (end != NULL) {
+            *end = '\0';
+        }
+        decode_directive(o, start, com, out);
+        start = end + 1;
+    } while (end != NULL);
+}
+
 /*
  * This function copies the unique directory name for a given option to
  * the "to" parameter. Some memory must be allocated to the "to" parameter.
  */
 
-void unique_dir_access(int opt, char *to) {
+void unique_dir_access(mdtest_ctx_t * ctx, int opt, char *to) {
 
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering unique_dir_access...\n" );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering unique_dir_access...\n" );
+        fflush( ctx->out );
     }
 
     if (opt == MK_UNI_DIR) {
-        MPI_Barrier(testComm);
-        strcpy( to, unique_chdir_dir );
+        MPI_Barrier(ctx->comm);
+        strcpy( to, ctx->unique_chdir_dir );
     } else if (opt == STAT_SUB_DIR) {
-        strcpy( to, unique_stat_dir );
+        strcpy( to, ctx->unique_stat_dir );
     } else if (opt == READ_SUB_DIR) {
-        strcpy( to, unique_read_dir );
+        strcpy( to, ctx->unique_read_dir );
     } else if (opt == RM_SUB_DIR) {
-        strcpy( to, unique_rm_dir );
+        strcpy( to, ctx->unique_rm_dir );
     } else if (opt == RM_UNI_DIR) {
-        strcpy( to, unique_rm_uni_dir );
+        strcpy( to, ctx->unique_rm_uni_dir );
     }
 }
 
-static void create_remove_dirs (const char *path, bool create, uint64_t itemNum) {
-    char curr_item[MAX_LEN];
+/* bijective 64 bit mixing function (the splitmix64 finalizer) */
+static inline uint64_t name_mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+/* append pseudo random hex digits derived from key to name until it has len characters */
+static void name_fill_hex(char *name, int pos, int len, uint64_t key) {
+    char block[17];
+
+    for (uint64_t k = 0; pos < len; k++) {
+        sprintf(block, "%016"PRIx64, name_mix(key + k * 0x9e3779b97f4a7c15ull));
+        for (int i = 0; i < 16 && pos < len; i++) {
+            name[pos++] = block[i];
+        }
+    }
+    name[pos] = '\0';
+}
+
+/* unique key of item num of the process owner refers to, used for names and data signatures */
+static uint64_t item_key(const char *owner, uint64_t num) {
+    uint64_t key;
+
+    /* the task number in "mdtest.<task>.", shared items use their own key space */
+    if (strncmp(owner, "mdtest.shared.", 14) == 0) {
+        key = 0xffffffull << 40;
+    } else {
+        key = (uint64_t) strtoul(owner + 7, NULL, 10) << 40;
+    }
+    return key | num;
+}
+
+/*
+ * Generate the name of item num of the process owner refers to (one of
+ * mk_name, stat_name, read_name or rm_name), prefixed with type ("file."
+ * or "dir.").  Every scheme computes the name from the item number alone,
+ * so all phases get the same names without keeping them.
+ */
+static char * item_name(mdtest_ctx_t * ctx, char *name, const char *type, const char *owner, uint64_t num) {
+    int pos, len;
+    uint64_t key;
+
+    if (ctx->o.name_scheme == MDTEST_NAME_SEQUENTIAL) {
+        sprintf(name, "%s%s"LLU"", type, owner, num);
+        return name;
+    }
+
+    key = item_key(owner, num);
+
+    switch (ctx->o.name_scheme) {
+    case MDTEST_NAME_HEX:
+        /* the first 16 digits are a bijection of task and item number */
+        len = ctx->o.name_length ? ctx->o.name_length : 16;
+        pos = sprintf(name, "%s", type);
+        name_fill_hex(name, pos, pos + len, key);
+        break;
+    case MDTEST_NAME_LONG:
+        len = ctx->o.name_length ? ctx->o.name_length : NAME_MAX - 5;
+        pos = sprintf(name, "%s%s"LLU".", type, owner, num);
+        name_fill_hex(name, pos, len > pos ? len : pos, key);
+        break;
+    case MDTEST_NAME_PREFIX:
+        len = ctx->o.name_length ? ctx->o.name_length : 200;
+        pos = sprintf(name, "%s", type);
+        for (int i = 0; i < len; i++) {
+            name[pos++] = "shared_prefix_"[i % 14];
+        }
+        sprintf(& name[pos], "%s"LLU"", owner, num);
+        break;
+    }
+    return name;
+}
+
+/* current time in ns for latency measurements, 0 if they are disabled */
+static inline uint64_t latency_now(mdtest_ctx_t * ctx) {
+    struct timespec ts;
+
+    if (! ctx->o.measure_latency) {
+        return 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, & ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int latency_bucket(uint64_t ns) {
+    int msb, bucket;
+
+    if (ns < LATENCY_SUB_BUCKETS) {
+        return (int) ns;
+    }
+    msb = 63 - __builtin_clzll(ns);
+    bucket = (msb - 2) * LATENCY_SUB_BUCKETS + (int) ((ns >> (msb - 3)) & (LATENCY_SUB_BUCKETS - 1));
+    return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+}
+
+/* upper bound of the latencies in a bucket, in seconds */
+static double latency_bucket_limit(int bucket) {
+    int msb, sub;
+
+    if (bucket < LATENCY_SUB_BUCKETS) {
+        return (bucket + 1) * 1e-9;
+    }
+    msb = bucket / LATENCY_SUB_BUCKETS + 2;
+    sub = bucket % LATENCY_SUB_BUCKETS;
+    return ldexp(LATENCY_SUB_BUCKETS + sub + 1, msb - 3) * 1e-9;
+}
+
+/* account the operation started at start (from latency_now()), returns the current time */
+static uint64_t latency_record(mdtest_ctx_t * ctx, int num, uint64_t start) {
+    uint64_t now, ns;
+    latency_hist_t *h;
+
+    if (! ctx->o.measure_latency) {
+        return 0;
+    }
+    now = latency_now(ctx);
+    ns = now - start;
+    h = & ctx->latency_hist[num];
+    h->count[latency_bucket(ns)]++;
+    if (ns * 1e-9 > h->max) {
+        h->max = ns * 1e-9;
+    }
+    return now;
+}
+
+/* compute the percentiles of a histogram */
+static void latency_percentiles(const latency_hist_t *h, mdtest_latency_t *out) {
+    const double fractions[3] = {0.5, 0.99, 0.999};
+    double *values[3] = {& out->p50, & out->p99, & out->p999};
+    uint64_t sum = 0;
+    int bucket = 0;
+
+    memset(out, 0, sizeof(*out));
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        out->ops += h->count[i];
+    }
+    if (out->ops == 0) {
+        return;
+    }
+    for (int p = 0; p < 3; p++) {
+        uint64_t rank_needed = (uint64_t) ceil(fractions[p] * out->ops);
+
+        while (sum + h->count[bucket] < rank_needed) {
+            sum += h->count[bucket];
+            bucket++;
+        }
+        *values[p] = fmin(latency_bucket_limit(bucket), h->max);
+    }
+    out->max = h->max;
+}
+
+/*
+ * Merge the histograms of the iteration over all processes, store the
+ * percentiles in the results and start over for the next iteration.
+ */
+static void latency_merge(mdtest_ctx_t * ctx, mdtest_results_t *results) {
+    latency_hist_t merged[MDTEST_LATENCY_LAST_NUM];
+    uint64_t count[MDTEST_LATENCY_LAST_NUM][LATENCY_BUCKETS];
+    double max[MDTEST_LATENCY_LAST_NUM];
+
+    /* the counts are summed and the maxima reduced on their own */
+    for (int i = 0; i < MDTEST_LATENCY_LAST_NUM; i++) {
+        memcpy(count[i], ctx->latency_hist[i].count, sizeof(count[i]));
+        max[i] = ctx->latency_hist[i].max;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, count, MDTEST_LATENCY_LAST_NUM * LATENCY_BUCKETS,
+                  MPI_UINT64_T, MPI_SUM, ctx->comm);
+    MPI_Allreduce(MPI_IN_PLACE, max, MDTEST_LATENCY_LAST_NUM, MPI_DOUBLE, MPI_MAX, ctx->comm);
+
+    for (int i = 0; i < MDTEST_LATENCY_LAST_NUM; i++) {
+        memcpy(merged[i].count, count[i], sizeof(count[i]));
+        merged[i].max = max[i];
+        latency_percentiles(& merged[i], & results->latency[i]);
+
+        for (int b = 0; b < LATENCY_BUCKETS; b++) {
+            ctx->latency_total[i].count[b] += merged[i].count[b];
+        }
+        ctx->latency_total[i].max = fmax(ctx->latency_total[i].max, max[i]);
+    }
+    memset(ctx->latency_hist, 0, sizeof(ctx->latency_hist));
+}
+
+/*
+ * Store the upper limit (in seconds) and count of the non-empty buckets of
+ * the histogram of operation num, summed over all processes and iterations
+ * of the run, returns the number of buckets stored.
+ */
+int mdtest_latency_histogram(mdtest_ctx_t * ctx, int num, double *limit, uint64_t *count, int max) {
+    int n = 0;
+
+    if (num < 0 || num >= MDTEST_LATENCY_LAST_NUM) {
+        return 0;
+    }
+    for (int b = 0; b < LATENCY_BUCKETS && n < max; b++) {
+        if (ctx->latency_total[num].count[b] != 0) {
+            limit[n] = fmin(latency_bucket_limit(b), ctx->latency_total[num].max);
+            count[n] = ctx->latency_total[num].count[b];
+            n++;
+        }
+    }
+    return n;
+}
+
+/* start sampling the items completed in phase num */
+static void series_begin(mdtest_ctx_t * ctx, int num) {
+    rate_series_t *r = & ctx->rate_series[num];
+
+    if (ctx->o.rate_series_prefix == NULL) {
+        return;
+    }
+    r->active = 1;
+    r->start = GetTimeStamp();
+    r->items = 0;
+    r->count = 0;
+    ctx->rate_series_current = r;
+    StartTicker(ctx->o.rate_series_interval);
+}
+
+/*
+ * count one completed item, closing the intervals the ticker thread
+ * counted so far, the clock is not read per item
+ */
+static inline void series_tick(mdtest_ctx_t * ctx) {
+    rate_series_t *r = ctx->rate_series_current;
+
+    if (r == NULL) {
+        return;
+    }
+    r->items++;
+    while (r->count < TickerCount()) {
+        if (r->count == r->max) {
+            r->max = r->max == 0 ? 64 : r->max * 2;
+            r->samples = realloc(r->samples, r->max * sizeof(uint64_t));
+            if (r->samples == NULL) {
+                FAIL("out of memory");
+            }
+        }
+        r->samples[r->count++] = r->items;
+    }
+}
+
+static void series_end(mdtest_ctx_t * ctx) {
+    if (ctx->rate_series_current != NULL) {
+        StopTicker();
+        ctx->rate_series_current->end = GetTimeStamp();
+        ctx->rate_series_current = NULL;
+    }
+}
+
+/*
+ * Sum the samples of all processes for the phases of this iteration and
+ * let rank 0 write one file per phase with the rate per interval and the
+ * number of entries of the directories being worked on.  The directory
+ * size is derived from the total progress, assuming that all processes
+ * progress evenly.
+ */
+static void series_write(mdtest_ctx_t * ctx, const int iteration, const char *path) {
+    static const char *phase_name[MDTEST_LAST_NUM] = {"dir_create", "dir_stat", "dir_read", "dir_remove",
+        "file_create", "file_stat", "file_read", "file_remove"};
+    int size;
+
+    if (ctx->o.rate_series_prefix == NULL) {
+        return;
+    }
+    MPI_Comm_size(ctx->comm, & size);
+
+    for (int num = 0; num <= MDTEST_FILE_REMOVE_NUM; num++) {
+        rate_series_t *r = & ctx->rate_series[num];
+        int active = r->active, count;
+        uint64_t *local, *total;
+
+        MPI_Allreduce(MPI_IN_PLACE, & active, 1, MPI_INT, MPI_MAX, ctx->comm);
+        if (! active) {
+            continue;
+        }
+
+        /* close the last, partial interval and pad to the longest series */
+        count = r->count + 1;
+        MPI_Allreduce(MPI_IN_PLACE, & count, 1, MPI_INT, MPI_MAX, ctx->comm);
+        local = (uint64_t *) malloc(count * sizeof(uint64_t));
+        total = (uint64_t *) malloc(count * sizeof(uint64_t));
+        if (local == NULL || total == NULL) {
+            FAIL("out of memory");
+        }
+        for (int i = 0; i < count; i++) {
+            local[i] = i < r->count ? r->samples[i] : r->items;
+        }
+        double duration = r->active ? r->end - r->start : 0;
+        MPI_Allreduce(MPI_IN_PLACE, & duration, 1, MPI_DOUBLE, MPI_MAX, ctx->comm);
+        MPI_Reduce(local, total, count, MPI_UINT64_T, MPI_SUM, 0, ctx->comm);
+
+        if (ctx->rank == 0) {
+            char fname[MAX_LEN];
+            FILE *out;
+            uint64_t sharers = ctx->o.unique_dir_per_task ? 1 : size;
+            uint64_t previous = 0;
+
+            sprintf(fname, "%s-%s.%d.csv", ctx->o.rate_series_prefix, phase_name[num], iteration);
+            out = fopen(fname, "w");
+            if (out == NULL) {
+                FAIL("unable to write the rate series");
+            }
+            fprintf(out, "# %s items completed by %d processes in %s, sampled every %.3f s\n",
+                    phase_name[num], size, path, ctx->o.rate_series_interval);
+            fprintf(out, "time,items,rate,dir_entries\n");
+            for (int i = 0; i < count; i++) {
+                double t = i < count - 1 ? (i + 1) * ctx->o.rate_series_interval : duration;
+                double len = t - i * ctx->o.rate_series_interval;
+                uint64_t per_process = total[i] / size;
+                uint64_t in_dir = per_process, entries;
+
+                /* items done in the directory currently worked on */
+                if (ctx->o.items_per_dir > 0 && per_process > 0) {
+                    in_dir = (per_process - 1) % ctx->o.items_per_dir + 1;
+                }
+                if (num == MDTEST_DIR_CREATE_NUM || num == MDTEST_FILE_CREATE_NUM) {
+                    entries = sharers * in_dir;
+                } else if (num == MDTEST_DIR_REMOVE_NUM || num == MDTEST_FILE_REMOVE_NUM) {
+                    entries = sharers * (ctx->o.items_per_dir > in_dir ? ctx->o.items_per_dir - in_dir : 0);
+                } else {
+                    entries = sharers * ctx->o.items_per_dir;
+                }
+                fprintf(out, "%.3f,%"PRIu64",%.3f,%"PRIu64"\n", t, total[i],
+                        len > 0 ? (total[i] - previous) / len : 0.0, entries);
+                previous = total[i];
+            }
+            fclose(out);
+        }
+        free(local);
+        free(total);
+        r->active = 0;
+    }
+}
+
+#define SIGNATURE_STEP 0x9e3779b97f4a7c15ull
+
+/* fill buf with the content signature of the item with the given key */
+static void signature_fill(char *buf, size_t bytes, uint64_t key) {
+    uint64_t *words = (uint64_t *) buf;
+    uint64_t seed = name_mix(key);
+
+    for (size_t i = 0; i < (bytes + 7) / 8; i++) {
+        words[i] = seed + i * SIGNATURE_STEP;
+    }
+}
+
+/* check the signature, the loop over whole words is kept simple so the compiler vectorizes it */
+static int signature_check(const char *buf, size_t bytes, uint64_t key) {
+    const uint64_t *words = (const uint64_t *) buf;
+    uint64_t seed = name_mix(key), diff = 0;
+    size_t full = bytes / 8;
+
+    for (size_t i = 0; i < full; i++) {
+        diff |= words[i] ^ (seed + i * SIGNATURE_STEP);
+    }
+    if (bytes % 8 != 0) {
+        uint64_t expected = seed + full * SIGNATURE_STEP;
+        diff |= memcmp(& words[full], & expected, bytes % 8);
+    }
+    return diff == 0;
+}
+
+/* buffer for file data, aligned and padded for O_DIRECT and whole word signatures */
+static char * alloc_io_buffer(mdtest_ctx_t * ctx, size_t bytes) {
+    size_t align = ctx->o.io_alignment > 0 ? ctx->o.io_alignment : 8;
+    size_t len = (bytes + align - 1) / align * align;
+    void *buf = NULL;
+
+    if (posix_memalign(& buf, align, len) != 0) {
+        FAIL("out of memory");
+    }
+    return (char *) buf;
+}
+
+static void verify_item(mdtest_ctx_t * ctx, const char *item, uint64_t key) {
+    if (signature_check(ctx->read_buffer, ctx->o.read_bytes, key)) {
+        return;
+    }
+    if (ctx->verify_errors++ < 10 || ctx->o.verbose >= 3) {
+        fprintf(ctx->out, "WARNING: rank %d: content of \"%s\" does not match its signature\n", ctx->rank, item);
+        fflush(ctx->out);
+    }
+}
+
+/* stat an item, restricted to the attributes of the statMask option if given */
+static int stat_item(mdtest_ctx_t * ctx, const char *item, struct stat *buf) {
+    if (ctx->o.stat_mask) {
+        return ctx->backend->statx(item, ctx->o.stat_mask, buf, &ctx->param);
+    }
+    return ctx->backend->stat(item, buf, &ctx->param);
+}
+
+static void create_remove_dirs (mdtest_ctx_t * ctx, const char *path, bool create, uint64_t itemNum) {
+    char curr_item[MAX_LEN], name[NAME_MAX + 1];
     const char *operation = create ? "create" : "remove";
 
-    if (( rank == 0 )                                         &&
-        ( verbose >= 3 )                                      &&
+    if (( ctx->rank == 0 )                                         &&
+        ( ctx->o.verbose >= 3 )                                      &&
         (itemNum % ITEM_COUNT==0 && (itemNum != 0))) {
 
-        fprintf(out_logfile, "V-3: %s dir: "LLU"\n", operation, itemNum);
-        fflush(out_logfile);
+        fprintf(ctx->out, "V-3: %s dir: "LLU"\n", operation, itemNum);
+        fflush(ctx->out);
     }
 
     //create dirs
-    sprintf(curr_item, "%s/dir.%s%" PRIu64, path, create ? mk_name : rm_name, itemNum);
-    if (rank == 0 && verbose >= 3) {
-        fprintf(out_logfile, "V-3: create_remove_items_helper (dirs %s): curr_item is \"%s\"\n", operation, curr_item);
-        fflush(out_logfile);
+    sprintf(curr_item, "%s/%s", path, item_name(ctx, name, "dir.", create ? ctx->mk_name : ctx->rm_name, itemNum));
+    if (ctx->rank == 0 && ctx->o.verbose >= 3) {
+        fprintf(ctx->out, "V-3: create_remove_items_helper (dirs %s): curr_item is \"%s\"\n", operation, curr_item);
+        fflush(ctx->out);
     }
 
+    uint64_t start = latency_now(ctx);
     if (create) {
-        if (backend->mkdir(curr_item, DIRMODE, &param) == -1) {
+        if (ctx->backend->mkdir(curr_item, DIRMODE, &ctx->param) == -1) {
             FAIL("unable to create directory");
         }
     } else {
-        if (backend->rmdir(curr_item, &param) == -1) {
+        if (ctx->backend->rmdir(curr_item, &ctx->param) == -1) {
             FAIL("unable to remove directory");
         }
     }
+    latency_record(ctx, create ? MDTEST_DIR_CREATE_NUM : MDTEST_DIR_REMOVE_NUM, start);
 }
 
-static void remove_file (const char *path, uint64_t itemNum) {
-    char curr_item[MAX_LEN];
+static void remove_file (mdtest_ctx_t * ctx, const char *path, uint64_t itemNum) {
+    char curr_item[MAX_LEN], name[NAME_MAX + 1];
 
-    if (( rank == 0 )                                       &&
-        ( verbose >= 3 )                                    &&
+    if (( ctx->rank == 0 )                                       &&
+        ( ctx->o.verbose >= 3 )                                    &&
         (itemNum % ITEM_COUNT==0 && (itemNum != 0))) {
 
-        fprintf(out_logfile, "V-3: remove file: "LLU"\n", itemNum);
-        fflush(out_logfile);
+        fprintf(ctx->out, "V-3: remove file: "LLU"\n", itemNum);
+        fflush(ctx->out);
     }
 
     //remove files
-    sprintf(curr_item, "%s/file.%s"LLU"", path, rm_name, itemNum);
-    if (rank == 0 && verbose >= 3) {
-        fprintf(out_logfile, "V-3: create_remove_items_helper (non-dirs remove): curr_item is \"%s\"\n", curr_item);
-        fflush(out_logfile);
+    sprintf(curr_item, "%s/%s", path, item_name(ctx, name, "file.", ctx->rm_name, itemNum));
+    if (ctx->rank == 0 && ctx->o.verbose >= 3) {
+        fprintf(ctx->out, "V-3: create_remove_items_helper (non-dirs remove): curr_item is \"%s\"\n", curr_item);
+        fflush(ctx->out);
     }
 
-    if (!(shared_file && rank != 0)) {
-        backend->delete (curr_item, &param);
+    if (!(ctx->o.shared_file && ctx->rank != 0)) {
+        uint64_t start = latency_now(ctx);
+        ctx->backend->delete (curr_item, &ctx->param);
+        if (! ctx->o.mixed_workload) {
+            latency_record(ctx, MDTEST_FILE_REMOVE_NUM, start);
+        }
     }
 }
 
-static void create_file (const char *path, uint64_t itemNum) {
-    char curr_item[MAX_LEN];
+static void create_file (mdtest_ctx_t * ctx, const char *path, uint64_t itemNum) {
+    char curr_item[MAX_LEN], name[NAME_MAX + 1];
     void *aiori_fh;
+    uint64_t start, step;
 
-    if (( rank == 0 )                                             &&
-        ( verbose >= 3 )                                          &&
+    if (( ctx->rank == 0 )                                             &&
+        ( ctx->o.verbose >= 3 )                                          &&
         (itemNum % ITEM_COUNT==0 && (itemNum != 0))) {
 
-        fprintf(out_logfile, "V-3: create file: "LLU"\n", itemNum);
-        fflush(out_logfile);
+        fprintf(ctx->out, "V-3: create file: "LLU"\n", itemNum);
+        fflush(ctx->out);
     }
 
     //create files
-    sprintf(curr_item, "%s/file.%s"LLU"", path, mk_name, itemNum);
-    if (rank == 0 && verbose >= 3) {
-        fprintf(out_logfile, "V-3: create_remove_items_helper (non-dirs create): curr_item is \"%s\"\n", curr_item);
-        fflush(out_logfile);
+    sprintf(curr_item, "%s/%s", path, item_name(ctx, name, "file.", ctx->mk_name, itemNum));
+    if (ctx->rank == 0 && ctx->o.verbose >= 3) {
+        fprintf(ctx->out, "V-3: create_remove_items_helper (non-dirs create): curr_item is \"%s\"\n", curr_item);
+        fflush(ctx->out);
+    }
+
+    if (ctx->o.verify_data && ctx->o.write_bytes > 0) {
+        signature_fill(ctx->write_buffer, ctx->o.write_bytes, item_key(ctx->mk_name, itemNum));
+    }
+
+    start = step = latency_now(ctx);
+    if (ctx->o.small_file) {
+        int fd = open(curr_item, ctx->small_create_flags, FILEMODE);
+        if (fd == -1) {
+            FAIL("unable to create file");
+        }
+        step = latency_record(ctx, MDTEST_FILE_CREATE_OPEN_NUM, step);
+
+        if (ctx->o.write_bytes > 0) {
+            if (pwrite(fd, ctx->write_buffer, ctx->write_io_size, 0) != (ssize_t) ctx->write_io_size) {
+                FAIL("unable to write file");
+            }
+            /* O_DIRECT writes whole blocks, cut the file to the requested size */
+            if (ctx->write_io_size != ctx->o.write_bytes && ftruncate(fd, ctx->o.write_bytes) != 0) {
+                FAIL("unable to truncate file");
+            }
+            if ((ctx->o.sync_mode == MDTEST_SYNC_FSYNC && fsync(fd) != 0) ||
+                (ctx->o.sync_mode == MDTEST_SYNC_FDATASYNC && fdatasync(fd) != 0)) {
+                FAIL("unable to sync file");
+            }
+            step = latency_record(ctx, MDTEST_FILE_CREATE_WRITE_NUM, step);
+        }
+
+        if (close(fd) != 0) {
+            FAIL("unable to close file");
+        }
+        latency_record(ctx, MDTEST_FILE_CREATE_CLOSE_NUM, step);
+        if (! ctx->o.mixed_workload) {
+            latency_record(ctx, MDTEST_FILE_CREATE_NUM, start);
+        }
+        return;
     }
 
-    if (collective_creates) {
-        param.openFlags = IOR_WRONLY;
+    if (ctx->o.collective_creates) {
+        ctx->param.openFlags = IOR_WRONLY;
 
-        if (rank == 0 && verbose >= 3) {
-            fprintf(out_logfile,  "V-3: create_remove_items_helper (collective): open...\n" );
-            fflush( out_logfile );
+        if (ctx->rank == 0 && ctx->o.verbose >= 3) {
+            fprintf(ctx->out,  "V-3: create_remove_items_helper (collective): open...\n" );
+            fflush( ctx->out );
         }
 
-        aiori_fh = backend->open (curr_item, &param);
+        aiori_fh = ctx->backend->open (curr_item, &ctx->param);
         if (NULL == aiori_fh) {
             FAIL("unable to open file");
         }
@@ -440,120 +1036,167 @@ static void create_file (const char *path, uint64_t itemNum) {
          * !collective_creates
          */
     } else {
-        param.openFlags = IOR_CREAT | IOR_WRONLY;
-        param.filePerProc = !shared_file;
+        ctx->param.openFlags = IOR_CREAT | IOR_WRONLY;
+        ctx->param.filePerProc = !ctx->o.shared_file;
 
-        if (rank == 0 && verbose >= 3) {
-            fprintf(out_logfile,  "V-3: create_remove_items_helper (non-collective, shared): open...\n" );
-            fflush( out_logfile );
+        if (ctx->rank == 0 && ctx->o.verbose >= 3) {
+            fprintf(ctx->out,  "V-3: create_remove_items_helper (non-collective, shared): open...\n" );
+            fflush( ctx->out );
         }
 
-        aiori_fh = backend->create (curr_item, &param);
+        aiori_fh = ctx->backend->create (curr_item, &ctx->param);
         if (NULL == aiori_fh) {
             FAIL("unable to create file");
         }
     }
+    step = latency_record(ctx, MDTEST_FILE_CREATE_OPEN_NUM, step);
 
-    if (write_bytes > 0) {
-        if (rank == 0 && verbose >= 3) {
-            fprintf(out_logfile,  "V-3: create_remove_items_helper: write...\n" );
-            fflush( out_logfile );
+    if (ctx->o.write_bytes > 0) {
+        if (ctx->rank == 0 && ctx->o.verbose >= 3) {
+            fprintf(ctx->out,  "V-3: create_remove_items_helper: write...\n" );
+            fflush( ctx->out );
         }
 
         /*
          * According to Bill Loewe, writes are only done one time, so they are always at
          * offset 0 (zero).
          */
-        param.offset = 0;
-        param.fsyncPerWrite = sync_file;
-        if ( write_bytes != (size_t) backend->xfer (WRITE, aiori_fh, (IOR_size_t *) write_buffer, write_bytes, &param)) {
+        ctx->param.offset = 0;
+        ctx->param.fsyncPerWrite = (ctx->o.sync_mode == MDTEST_SYNC_FSYNC);
+        if ( ctx->o.write_bytes != (size_t) ctx->backend->xfer (WRITE, aiori_fh, (IOR_size_t *) ctx->write_buffer, ctx->o.write_bytes, &ctx->param)) {
             FAIL("unable to write file");
         }
+        step = latency_record(ctx, MDTEST_FILE_CREATE_WRITE_NUM, step);
     }
 
-    if (rank == 0 && verbose >= 3) {
-        fprintf(out_logfile,  "V-3: create_remove_items_helper: close...\n" );
-        fflush( out_logfile );
+    if (ctx->rank == 0 && ctx->o.verbose >= 3) {
+        fprintf(ctx->out,  "V-3: create_remove_items_helper: close...\n" );
+        fflush( ctx->out );
     }
 
-    backend->close (aiori_fh, &param);
+    ctx->backend->close (aiori_fh, &ctx->param);
+    latency_record(ctx, MDTEST_FILE_CREATE_CLOSE_NUM, step);
+    if (! ctx->o.mixed_workload) {
+        latency_record(ctx, MDTEST_FILE_CREATE_NUM, start);
+    }
+}
+
+static void read_file (mdtest_ctx_t * ctx, const char *item, uint64_t key) {
+    void *aiori_fh;
+
+    if (ctx->o.small_file) {
+        int fd = open(item, ctx->small_open_flags);
+        if (fd == -1) {
+            FAIL("unable to open file");
+        }
+        if (ctx->o.read_bytes > 0 && pread(fd, ctx->read_buffer, ctx->read_io_size, 0) < (ssize_t) ctx->o.read_bytes) {
+            FAIL("unable to read file");
+        }
+        close(fd);
+        if (ctx->o.verify_data && ctx->o.read_bytes > 0) {
+            verify_item(ctx, item, key);
+        }
+        return;
+    }
+
+    /* open file for reading */
+    ctx->param.openFlags = O_RDONLY;
+    aiori_fh = ctx->backend->open ((char *) item, &ctx->param);
+    if (NULL == aiori_fh) {
+        FAIL("unable to open file");
+    }
+
+    /* read file */
+    if (ctx->o.read_bytes > 0) {
+        if (ctx->o.read_bytes != (size_t) ctx->backend->xfer (READ, aiori_fh, (IOR_size_t *) ctx->read_buffer, ctx->o.read_bytes, &ctx->param)) {
+            FAIL("unable to read file");
+        }
+    }
+
+    /* close file */
+    ctx->backend->close (aiori_fh, &ctx->param);
+
+    if (ctx->o.verify_data && ctx->o.read_bytes > 0) {
+        verify_item(ctx, item, key);
+    }
 }
 
 /* helper for creating/removing items */
-void create_remove_items_helper(const int dirs, const int create, const char *path,
+void create_remove_items_helper(mdtest_ctx_t * ctx, const int dirs, const int create, const char *path,
                                 uint64_t itemNum, rank_progress_t * progress) {
 
     char curr_item[MAX_LEN];
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering create_remove_items_helper...\n" );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering create_remove_items_helper...\n" );
+        fflush( ctx->out );
     }
 
     for (uint64_t i = progress->items_start ; i < progress->items_per_dir ; ++i) {
         if (!dirs) {
             if (create) {
-                create_file (path, itemNum + i);
+                create_file (ctx, path, itemNum + i);
             } else {
-                remove_file (path, itemNum + i);
+                remove_file (ctx, path, itemNum + i);
             }
         } else {
-            create_remove_dirs (path, create, itemNum + i);
+            create_remove_dirs (ctx, path, create, itemNum + i);
         }
+        series_tick(ctx);
         if(CHECK_STONE_WALL(progress)){
           progress->items_done = i + 1;
           return;
         }
     }
-    progress->items_done = items_per_dir;
+    progress->items_done = ctx->o.items_per_dir;
 }
 
 /* helper function to do collective operations */
-void collective_helper(const int dirs, const int create, const char* path, uint64_t itemNum, rank_progress_t * progress) {
-    char curr_item[MAX_LEN];
+void collective_helper(mdtest_ctx_t * ctx, const int dirs, const int create, const char* path, uint64_t itemNum, rank_progress_t * progress) {
+    char curr_item[MAX_LEN], name[NAME_MAX + 1];
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering collective_helper...\n" );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering collective_helper...\n" );
+        fflush( ctx->out );
     }
-    for (uint64_t i = 0 ; i < items_per_dir ; ++i) {
+    for (uint64_t i = 0 ; i < ctx->o.items_per_dir ; ++i) {
         if (dirs) {
-            create_remove_dirs (path, create, itemNum + i);
+            create_remove_dirs (ctx, path, create, itemNum + i);
             continue;
         }
 
-        sprintf(curr_item, "%s/file.%s"LLU"", path, create ? mk_name : rm_name, itemNum+i);
-        if (rank == 0 && verbose >= 3) {
-            fprintf(out_logfile, "V-3: create file: %s\n", curr_item);
-            fflush(out_logfile);
+        sprintf(curr_item, "%s/%s", path, item_name(ctx, name, "file.", create ? ctx->mk_name : ctx->rm_name, itemNum+i));
+        if (ctx->rank == 0 && ctx->o.verbose >= 3) {
+            fprintf(ctx->out, "V-3: create file: %s\n", curr_item);
+            fflush(ctx->out);
         }
 
         if (create) {
             void *aiori_fh;
 
             //create files
-            param.openFlags = IOR_WRONLY | IOR_CREAT;
-            aiori_fh = backend->create (curr_item, &param);
+            ctx->param.openFlags = IOR_WRONLY | IOR_CREAT;
+            aiori_fh = ctx->backend->create (curr_item, &ctx->param);
             if (NULL == aiori_fh) {
                 FAIL("unable to create file");
             }
 
-            backend->close (aiori_fh, &param);
-        } else if (!(shared_file && rank != 0)) {
+            ctx->backend->close (aiori_fh, &ctx->param);
+        } else if (!(ctx->o.shared_file && ctx->rank != 0)) {
             //remove files
-            backend->delete (curr_item, &param);
+            ctx->backend->delete (curr_item, &ctx->param);
         }
         if(CHECK_STONE_WALL(progress)){
           progress->items_done = i + 1;
           return;
         }
     }
-    progress->items_done = items_per_dir;
+    progress->items_done = ctx->o.items_per_dir;
 }
 
 /* recusive function to create and remove files/directories from the
    directory tree */
-void create_remove_items(int currDepth, const int dirs, const int create, const int collective,
+void create_remove_items(mdtest_ctx_t * ctx, int currDepth, const int dirs, const int create, const int collective,
                          const char *path, uint64_t dirNum, rank_progress_t * progress) {
     unsigned i;
     char dir[MAX_LEN];
@@ -561,66 +1204,66 @@ void create_remove_items(int currDepth, const int dirs, const int create, const
     unsigned long long currDir = dirNum;
 
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering create_remove_items, currDepth = %d...\n", currDepth );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering create_remove_items, currDepth = %d...\n", currDepth );
+        fflush( ctx->out );
     }
 
 
     memset(dir, 0, MAX_LEN);
     strcpy(temp_path, path);
 
-    if (rank == 0 && verbose >= 3) {
-        fprintf(out_logfile,  "V-3: create_remove_items (start): temp_path is \"%s\"\n", temp_path );
-        fflush(out_logfile);
+    if (ctx->rank == 0 && ctx->o.verbose >= 3) {
+        fprintf(ctx->out,  "V-3: create_remove_items (start): temp_path is \"%s\"\n", temp_path );
+        fflush(ctx->out);
     }
 
     if (currDepth == 0) {
         /* create items at this depth */
-        if (!leaf_only || (depth == 0 && leaf_only)) {
+        if (!ctx->o.leaf_only || (ctx->o.depth == 0 && ctx->o.leaf_only)) {
             if (collective) {
-                collective_helper(dirs, create, temp_path, 0, progress);
+                collective_helper(ctx, dirs, create, temp_path, 0, progress);
             } else {
-                create_remove_items_helper(dirs, create, temp_path, 0, progress);
+                create_remove_items_helper(ctx, dirs, create, temp_path, 0, progress);
             }
         }
 
-        if (depth > 0) {
-            create_remove_items(++currDepth, dirs, create,
+        if (ctx->o.depth > 0) {
+            create_remove_items(ctx, ++currDepth, dirs, create,
                                 collective, temp_path, ++dirNum, progress);
         }
 
-    } else if (currDepth <= depth) {
+    } else if (currDepth <= ctx->o.depth) {
         /* iterate through the branches */
-        for (i=0; i<branch_factor; i++) {
+        for (i=0; i<ctx->o.branch_factor; i++) {
 
             /* determine the current branch and append it to the path */
-            sprintf(dir, "%s.%llu/", base_tree_name, currDir);
+            sprintf(dir, "%s.%llu/", ctx->base_tree_name, currDir);
             strcat(temp_path, "/");
             strcat(temp_path, dir);
 
-            if (rank == 0 && verbose >= 3) {
-                fprintf(out_logfile,  "V-3: create_remove_items (for loop): temp_path is \"%s\"\n", temp_path );
-                fflush(out_logfile);
+            if (ctx->rank == 0 && ctx->o.verbose >= 3) {
+                fprintf(ctx->out,  "V-3: create_remove_items (for loop): temp_path is \"%s\"\n", temp_path );
+                fflush(ctx->out);
             }
 
             /* create the items in this branch */
-            if (!leaf_only || (leaf_only && currDepth == depth)) {
+            if (!ctx->o.leaf_only || (ctx->o.leaf_only && currDepth == ctx->o.depth)) {
                 if (collective) {
-                    collective_helper(dirs, create, temp_path, currDir*items_per_dir, progress);
+                    collective_helper(ctx, dirs, create, temp_path, currDir*ctx->o.items_per_dir, progress);
                 } else {
-                    create_remove_items_helper(dirs, create, temp_path, currDir*items_per_dir, progress);
+                    create_remove_items_helper(ctx, dirs, create, temp_path, currDir*ctx->o.items_per_dir, progress);
                 }
             }
 
             /* make the recursive call for the next level below this branch */
-            create_remove_items(
+            create_remove_items(ctx, 
                 ++currDepth,
                 dirs,
                 create,
                 collective,
                 temp_path,
-                ( currDir * ( unsigned long long )branch_factor ) + 1,
+                ( currDir * ( unsigned long long )ctx->o.branch_factor ) + 1,
                 progress
                );
             currDepth--;
@@ -633,22 +1276,22 @@ void create_remove_items(int currDepth, const int dirs, const int create, const
 }
 
 /* stats all of the items created as specified by the input parameters */
-void mdtest_stat(const int random, const int dirs, const char *path, rank_progress_t * progress) {
+void mdtest_stat(mdtest_ctx_t * ctx, const int random, const int dirs, const char *path, rank_progress_t * progress) {
     struct stat buf;
     uint64_t parent_dir, item_num = 0;
     char item[MAX_LEN], temp[MAX_LEN];
     uint64_t stop;
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering mdtest_stat...\n" );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering mdtest_stat...\n" );
+        fflush( ctx->out );
     }
 
     /* determine the number of items to stat*/
-    if (leaf_only) {
-        stop = items_per_dir * (uint64_t) pow( branch_factor, depth );
+    if (ctx->o.leaf_only) {
+        stop = ctx->o.items_per_dir * (uint64_t) pow( ctx->o.branch_factor, ctx->o.depth );
     } else {
-        stop = items;
+        stop = ctx->o.items;
     }
 
     /* iterate over all of the item IDs */
@@ -665,45 +1308,45 @@ void mdtest_stat(const int random, const int dirs, const char *path, rank_progre
 
         /* determine the item number to stat */
         if (random) {
-            item_num = rand_array[i];
+            item_num = ctx->rand_array[i];
         } else {
             item_num = i;
         }
 
         /* make adjustments if in leaf only mode*/
-        if (leaf_only) {
-            item_num += items_per_dir *
-                (num_dirs_in_tree - ( unsigned long long )pow( branch_factor, depth ));
+        if (ctx->o.leaf_only) {
+            item_num += ctx->o.items_per_dir *
+                (ctx->num_dirs_in_tree - ( unsigned long long )pow( ctx->o.branch_factor, ctx->o.depth ));
         }
 
         /* create name of file/dir to stat */
         if (dirs) {
-            if (rank == 0 && verbose >= 3 && (i%ITEM_COUNT == 0) && (i != 0)) {
-                fprintf(out_logfile, "V-3: stat dir: "LLU"\n", i);
-                fflush(out_logfile);
+            if (ctx->rank == 0 && ctx->o.verbose >= 3 && (i%ITEM_COUNT == 0) && (i != 0)) {
+                fprintf(ctx->out, "V-3: stat dir: "LLU"\n", i);
+                fflush(ctx->out);
             }
-            sprintf(item, "dir.%s"LLU"", stat_name, item_num);
+            item_name(ctx, item, "dir.", ctx->stat_name, item_num);
         } else {
-            if (rank == 0 && verbose >= 3 && (i%ITEM_COUNT == 0) && (i != 0)) {
-                fprintf(out_logfile, "V-3: stat file: "LLU"\n", i);
-                fflush(out_logfile);
+            if (ctx->rank == 0 && ctx->o.verbose >= 3 && (i%ITEM_COUNT == 0) && (i != 0)) {
+                fprintf(ctx->out, "V-3: stat file: "LLU"\n", i);
+                fflush(ctx->out);
             }
-            sprintf(item, "file.%s"LLU"", stat_name, item_num);
+            item_name(ctx, item, "file.", ctx->stat_name, item_num);
         }
 
         /* determine the path to the file/dir to be stat'ed */
-        parent_dir = item_num / items_per_dir;
+        parent_dir = item_num / ctx->o.items_per_dir;
 
         if (parent_dir > 0) {        //item is not in tree's root directory
 
             /* prepend parent directory to item's path */
-            sprintf(temp, "%s."LLU"/%s", base_tree_name, parent_dir, item);
+            sprintf(temp, "%s."LLU"/%s", ctx->base_tree_name, parent_dir, item);
             strcpy(item, temp);
 
             //still not at the tree's root dir
-            while (parent_dir > branch_factor) {
-                parent_dir = (uint64_t) ((parent_dir-1) / branch_factor);
-                sprintf(temp, "%s."LLU"/%s", base_tree_name, parent_dir, item);
+            while (parent_dir > ctx->o.branch_factor) {
+                parent_dir = (uint64_t) ((parent_dir-1) / ctx->o.branch_factor);
+                sprintf(temp, "%s."LLU"/%s", ctx->base_tree_name, parent_dir, item);
                 strcpy(item, temp);
             }
         }
@@ -713,58 +1356,57 @@ void mdtest_stat(const int random, const int dirs, const char *path, rank_progre
         strcpy( item, temp );
 
         /* below temp used to be hiername */
-        if (rank == 0 && verbose >= 3) {
+        if (ctx->rank == 0 && ctx->o.verbose >= 3) {
             if (dirs) {
-                fprintf(out_logfile, "V-3: mdtest_stat dir : %s\n", item);
+                fprintf(ctx->out, "V-3: mdtest_stat dir : %s\n", item);
             } else {
-                fprintf(out_logfile, "V-3: mdtest_stat file: %s\n", item);
+                fprintf(ctx->out, "V-3: mdtest_stat file: %s\n", item);
             }
-            fflush(out_logfile);
+            fflush(ctx->out);
         }
 
-        if (-1 == backend->stat (item, &buf, &param)) {
+        uint64_t start = latency_now(ctx);
+        if (-1 == stat_item (ctx, item, &buf)) {
             if (dirs) {
-                if ( verbose >= 3 ) {
-                    fprintf( out_logfile, "V-3: Stat'ing directory \"%s\"\n", item );
-                    fflush( out_logfile );
+                if ( ctx->o.verbose >= 3 ) {
+                    fprintf( ctx->out, "V-3: Stat'ing directory \"%s\"\n", item );
+                    fflush( ctx->out );
                 }
                 FAIL("unable to stat directory");
             } else {
-                if ( verbose >= 3 ) {
-                    fprintf( out_logfile, "V-3: Stat'ing file \"%s\"\n", item );
-                    fflush( out_logfile );
+                if ( ctx->o.verbose >= 3 ) {
+                    fprintf( ctx->out, "V-3: Stat'ing file \"%s\"\n", item );
+                    fflush( ctx->out );
                 }
                 FAIL("unable to stat file");
             }
         }
+        latency_record(ctx, dirs ? MDTEST_DIR_STAT_NUM : MDTEST_FILE_STAT_NUM, start);
+        series_tick(ctx);
     }
 }
 
 
 /* reads all of the items created as specified by the input parameters */
-void mdtest_read(int random, int dirs, char *path) {
+void mdtest_read(mdtest_ctx_t * ctx, int random, int dirs, char *path) {
     uint64_t stop, parent_dir, item_num = 0;
     char item[MAX_LEN], temp[MAX_LEN];
-    void *aiori_fh;
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering mdtest_read...\n" );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering mdtest_read...\n" );
+        fflush( ctx->out );
     }
 
     /* allocate read buffer */
-    if (read_bytes > 0) {
-        read_buffer = (char *)malloc(read_bytes);
-        if (read_buffer == NULL) {
-            FAIL("out of memory");
-        }
+    if (ctx->o.read_bytes > 0 && ctx->read_buffer == NULL) {
+        ctx->read_buffer = alloc_io_buffer(ctx, ctx->read_io_size);
     }
 
     /* determine the number of items to read */
-    if (leaf_only) {
-        stop = items_per_dir * ( unsigned long long )pow( branch_factor, depth );
+    if (ctx->o.leaf_only) {
+        stop = ctx->o.items_per_dir * ( unsigned long long )pow( ctx->o.branch_factor, ctx->o.depth );
     } else {
-        stop = items;
+        stop = ctx->o.items;
     }
 
     /* iterate over all of the item IDs */
@@ -783,39 +1425,39 @@ void mdtest_read(int random, int dirs, char *path) {
 
         /* determine the item number to read */
         if (random) {
-            item_num = rand_array[i];
+            item_num = ctx->rand_array[i];
         } else {
             item_num = i;
         }
 
         /* make adjustments if in leaf only mode*/
-        if (leaf_only) {
-            item_num += items_per_dir *
-                (num_dirs_in_tree - (uint64_t) pow (branch_factor, depth));
+        if (ctx->o.leaf_only) {
+            item_num += ctx->o.items_per_dir *
+                (ctx->num_dirs_in_tree - (uint64_t) pow (ctx->o.branch_factor, ctx->o.depth));
         }
 
         /* create name of file to read */
         if (!dirs) {
-            if (rank == 0 && verbose >= 3 && (i%ITEM_COUNT == 0) && (i != 0)) {
-                fprintf(out_logfile, "V-3: read file: "LLU"\n", i);
-                fflush(out_logfile);
+            if (ctx->rank == 0 && ctx->o.verbose >= 3 && (i%ITEM_COUNT == 0) && (i != 0)) {
+                fprintf(ctx->out, "V-3: read file: "LLU"\n", i);
+                fflush(ctx->out);
             }
-            sprintf(item, "file.%s"LLU"", read_name, item_num);
+            item_name(ctx, item, "file.", ctx->read_name, item_num);
         }
 
         /* determine the path to the file/dir to be read'ed */
-        parent_dir = item_num / items_per_dir;
+        parent_dir = item_num / ctx->o.items_per_dir;
 
         if (parent_dir > 0) {        //item is not in tree's root directory
 
             /* prepend parent directory to item's path */
-            sprintf(temp, "%s."LLU"/%s", base_tree_name, parent_dir, item);
+            sprintf(temp, "%s."LLU"/%s", ctx->base_tree_name, parent_dir, item);
             strcpy(item, temp);
 
             /* still not at the tree's root dir */
-            while (parent_dir > branch_factor) {
-                parent_dir = (unsigned long long) ((parent_dir-1) / branch_factor);
-                sprintf(temp, "%s."LLU"/%s", base_tree_name, parent_dir, item);
+            while (parent_dir > ctx->o.branch_factor) {
+                parent_dir = (unsigned long long) ((parent_dir-1) / ctx->o.branch_factor);
+                sprintf(temp, "%s."LLU"/%s", ctx->base_tree_name, parent_dir, item);
                 strcpy(item, temp);
             }
         }
@@ -825,544 +1467,929 @@ void mdtest_read(int random, int dirs, char *path) {
         strcpy( item, temp );
 
         /* below temp used to be hiername */
-        if (rank == 0 && verbose >= 3) {
+        if (ctx->rank == 0 && ctx->o.verbose >= 3) {
             if (!dirs) {
-                fprintf(out_logfile, "V-3: mdtest_read file: %s\n", item);
+                fprintf(ctx->out, "V-3: mdtest_read file: %s\n", item);
             }
-            fflush(out_logfile);
+            fflush(ctx->out);
         }
 
-        /* open file for reading */
-        param.openFlags = O_RDONLY;
-        aiori_fh = backend->open (item, &param);
-        if (NULL == aiori_fh) {
-            FAIL("unable to open file");
-        }
+        uint64_t start = latency_now(ctx);
+        read_file (ctx, item, item_key(ctx->read_name, item_num));
+        latency_record(ctx, MDTEST_FILE_READ_NUM, start);
+        series_tick(ctx);
+    }
+}
 
-        /* read file */
-        if (read_bytes > 0) {
-            if (read_bytes != (size_t) backend->xfer (READ, aiori_fh, (IOR_size_t *) read_buffer, read_bytes, &param)) {
-                FAIL("unable to read file");
-            }
-        }
+/* set the names of the items and directories process i works on */
+static void set_task_names(mdtest_ctx_t * ctx, int i, const int ntasks) {
+    if (!ctx->o.shared_file) {
+        sprintf(ctx->mk_name, "mdtest.%d.", (i+(0*ctx->o.nstride))%ntasks);
+        sprintf(ctx->stat_name, "mdtest.%d.", (i+(1*ctx->o.nstride))%ntasks);
+        sprintf(ctx->read_name, "mdtest.%d.", (i+(2*ctx->o.nstride))%ntasks);
+        sprintf(ctx->rm_name, "mdtest.%d.", (i+(3*ctx->o.nstride))%ntasks);
+    }
+    if (ctx->o.unique_dir_per_task) {
+        sprintf(ctx->unique_mk_dir, "%s/mdtest_tree.%d.0", ctx->testdir,
+                (i+(0*ctx->o.nstride))%ntasks);
+        sprintf(ctx->unique_chdir_dir, "%s/mdtest_tree.%d.0", ctx->testdir,
+                (i+(1*ctx->o.nstride))%ntasks);
+        sprintf(ctx->unique_stat_dir, "%s/mdtest_tree.%d.0", ctx->testdir,
+                (i+(2*ctx->o.nstride))%ntasks);
+        sprintf(ctx->unique_read_dir, "%s/mdtest_tree.%d.0", ctx->testdir,
+                (i+(3*ctx->o.nstride))%ntasks);
+        sprintf(ctx->unique_rm_dir, "%s/mdtest_tree.%d.0", ctx->testdir,
+                (i+(4*ctx->o.nstride))%ntasks);
+        sprintf(ctx->unique_rm_uni_dir, "%s", ctx->testdir);
+    }
+}
 
-        /* close file */
-        backend->close (aiori_fh, &param);
+/*
+ * Group the processes for collective creates: every group has one
+ * aggregator (its first process) that creates and removes the items of all
+ * processes of the group.  By default there is one group per node,
+ * otherwise collective_aggregators groups of consecutive ranks.
+ */
+static void setup_aggregators(mdtest_ctx_t * ctx) {
+    int color, group_rank, ntasks;
+
+    if (ctx->aggregator_comm != MPI_COMM_NULL) {
+        MPI_Comm_free(& ctx->aggregator_comm);
+        free(ctx->aggregator_owners);
+    }
+
+    MPI_Comm_size(ctx->comm, & ntasks);
+    if (ctx->o.collective_aggregators > 0) {
+        int groups = ctx->o.collective_aggregators < ntasks ? ctx->o.collective_aggregators : ntasks;
+        color = (int) ((long long) ctx->rank * groups / ntasks);
+        MPI_Comm_split(ctx->comm, color, ctx->rank, & ctx->aggregator_comm);
+    } else {
+#if MPI_VERSION >= 3
+        MPI_Comm_split_type(ctx->comm, MPI_COMM_TYPE_SHARED, ctx->rank, MPI_INFO_NULL, & ctx->aggregator_comm);
+#else
+        color = ctx->rank / count_tasks_per_node(ctx);
+        MPI_Comm_split(ctx->comm, color, ctx->rank, & ctx->aggregator_comm);
+#endif
+    }
+
+    MPI_Comm_rank(ctx->aggregator_comm, & group_rank);
+    MPI_Comm_size(ctx->aggregator_comm, & ctx->aggregator_owner_count);
+    ctx->is_aggregator = (group_rank == 0);
+
+    ctx->aggregator_owners = (int *) malloc(ctx->aggregator_owner_count * sizeof(int));
+    if (ctx->aggregator_owners == NULL) {
+        FAIL("out of memory");
+    }
+    MPI_Allgather(& ctx->rank, 1, MPI_INT, ctx->aggregator_owners, 1, MPI_INT, ctx->aggregator_comm);
+
+    if (ctx->o.verbose >= 2 && ctx->is_aggregator) {
+        fprintf(ctx->out, "V-2: rank %d aggregates the collective operations of %d processes\n", ctx->rank, ctx->aggregator_owner_count);
+        fflush(ctx->out);
     }
 }
 
-/* This method should be called by rank 0.  It subsequently does all of
-   the creates and removes for the other ranks */
-void collective_create_remove(const int create, const int dirs, const int ntasks, const char *path, rank_progress_t * progress) {
+/* This method should be called by all ranks.  The aggregators
+   subsequently do all of the creates and removes for the ranks of their
+   group, the call returns immediately on the other ranks. */
+void collective_create_remove(mdtest_ctx_t * ctx, const int create, const int dirs, const int ntasks, const char *path, rank_progress_t * progress) {
     char temp[MAX_LEN];
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering collective_create_remove...\n" );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering collective_create_remove...\n" );
+        fflush( ctx->out );
     }
 
-    /* rank 0 does all of the creates and removes for all of the ranks */
-    for (int i = 0 ; i < ntasks ; ++i) {
+    if (!ctx->is_aggregator) {
+        return;
+    }
+
+    /* the aggregator does all of the creates and removes for its group */
+    for (int o = 0 ; o < ctx->aggregator_owner_count ; ++o) {
+        int i = ctx->aggregator_owners[o];
+
         memset(temp, 0, MAX_LEN);
 
-        strcpy(temp, testdir);
+        strcpy(temp, ctx->testdir);
         strcat(temp, "/");
 
         /* set the base tree name appropriately */
-        if (unique_dir_per_task) {
-            sprintf(base_tree_name, "mdtest_tree.%d", i);
+        if (ctx->o.unique_dir_per_task) {
+            sprintf(ctx->base_tree_name, "mdtest_tree.%d", i);
         } else {
-            sprintf(base_tree_name, "mdtest_tree");
+            sprintf(ctx->base_tree_name, "mdtest_tree");
         }
 
         /* Setup to do I/O to the appropriate test dir */
-        strcat(temp, base_tree_name);
+        strcat(temp, ctx->base_tree_name);
         strcat(temp, ".0");
 
         /* set all item names appropriately */
-        if (!shared_file) {
-            sprintf(mk_name, "mdtest.%d.", (i+(0*nstride))%ntasks);
-            sprintf(stat_name, "mdtest.%d.", (i+(1*nstride))%ntasks);
-            sprintf(read_name, "mdtest.%d.", (i+(2*nstride))%ntasks);
-            sprintf(rm_name, "mdtest.%d.", (i+(3*nstride))%ntasks);
-        }
-        if (unique_dir_per_task) {
-            sprintf(unique_mk_dir, "%s/mdtest_tree.%d.0", testdir,
-                    (i+(0*nstride))%ntasks);
-            sprintf(unique_chdir_dir, "%s/mdtest_tree.%d.0", testdir,
-                    (i+(1*nstride))%ntasks);
-            sprintf(unique_stat_dir, "%s/mdtest_tree.%d.0", testdir,
-                    (i+(2*nstride))%ntasks);
-            sprintf(unique_read_dir, "%s/mdtest_tree.%d.0", testdir,
-                    (i+(3*nstride))%ntasks);
-            sprintf(unique_rm_dir, "%s/mdtest_tree.%d.0", testdir,
-                    (i+(4*nstride))%ntasks);
-            sprintf(unique_rm_uni_dir, "%s", testdir);
-        }
+        set_task_names(ctx, i, ntasks);
 
         /* Now that everything is set up as it should be, do the create or remove */
-        if (rank == 0 && verbose >= 3) {
-            fprintf(out_logfile, "V-3: collective_create_remove (create_remove_items): temp is \"%s\"\n", temp);
-            fflush( out_logfile );
+        if (ctx->rank == 0 && ctx->o.verbose >= 3) {
+            fprintf(ctx->out, "V-3: collective_create_remove (create_remove_items): temp is \"%s\"\n", temp);
+            fflush( ctx->out );
         }
 
-        create_remove_items(0, dirs, create, 1, temp, 0, progress);
+        create_remove_items(ctx, 0, dirs, create, 1, temp, 0, progress);
     }
 
     /* reset all of the item names */
-    if (unique_dir_per_task) {
-        sprintf(base_tree_name, "mdtest_tree.0");
+    if (ctx->o.unique_dir_per_task) {
+        sprintf(ctx->base_tree_name, "mdtest_tree.%d", ctx->rank);
+    } else {
+        sprintf(ctx->base_tree_name, "mdtest_tree");
+    }
+    set_task_names(ctx, ctx->rank, ntasks);
+}
+
+/* running totals of a listing phase */
+typedef struct {
+    mdtest_ctx_t *ctx;
+    const char *dir;
+    uint64_t entries;
+    uint64_t bytes;
+} list_state_t;
+
+static int list_entry(const ior_aiori_dirent_t *entry, void *arg) {
+    list_state_t *state = (list_state_t *) arg;
+    mdtest_ctx_t *ctx = state->ctx;
+    char item[MAX_LEN];
+    struct stat buf;
+
+    state->entries++;
+
+    /* readdirplus: look at the attributes of every entry, too */
+    if (ctx->o.list_plus) {
+        sprintf(item, "%s/%s", state->dir, entry->name);
+        if (stat_item(ctx, item, &buf) == -1) {
+            if (ctx->o.verbose >= 3) {
+                fprintf(ctx->out, "V-3: Stat'ing listed entry \"%s\"\n", item);
+                fflush(ctx->out);
+            }
+            FAIL("unable to stat listed entry");
+        }
+    }
+    return 0;
+}
+
+/*
+ * list a directory of the tree and, recursively, the directories below it;
+ * prefix is the name of the tree without the node number
+ */
+static void list_tree(mdtest_ctx_t * ctx, const char *dir, const char *prefix, uint64_t node, list_state_t *state) {
+    char child[MAX_LEN];
+    uint64_t bytes = 0;
+
+    if (ctx->rank == 0 && ctx->o.verbose >= 3) {
+        fprintf(ctx->out, "V-3: list_tree: listing \"%s\"\n", dir);
+        fflush(ctx->out);
+    }
+
+    state->dir = dir;
+    if (ctx->backend->readdir(dir, ctx->o.list_buffer_size, list_entry, state, &bytes, &ctx->param) != 0) {
+        FAIL("unable to list directory");
+    }
+    state->bytes += bytes;
+
+    for (unsigned i = 1; i <= ctx->o.branch_factor; i++) {
+        uint64_t c = node * ctx->o.branch_factor + i;
+
+        if (c >= ctx->num_dirs_in_tree) {
+            break;
+        }
+        sprintf(child, "%s/%s."LLU, dir, prefix, c);
+        list_tree(ctx, child, prefix, c, state);
+    }
+}
+
+/*
+ * Listing phase: every process enumerates all directories of its tree, that
+ * is its own one with -u and the shared one otherwise.  The rate is the
+ * number of entries returned per second.
+ */
+static void mdtest_list(mdtest_ctx_t * ctx, const int iteration, const int dirs, const char *path) {
+    list_state_t state = {ctx, NULL, 0, 0};
+    uint64_t local[2], total[2];
+    int num = dirs ? MDTEST_DIR_LIST_NUM : MDTEST_FILE_LIST_NUM;
+    char temp_path[MAX_LEN];
+    char prefix[MAX_LEN];
+    char *dot;
+    double start, t;
+
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering mdtest_list...\n" );
+        fflush( ctx->out );
+    }
+
+    if (ctx->o.unique_dir_per_task) {
+        unique_dir_access(ctx, STAT_SUB_DIR, temp_path);
     } else {
-        sprintf(base_tree_name, "mdtest_tree");
-    }
-    if (!shared_file) {
-        sprintf(mk_name, "mdtest.%d.", (0+(0*nstride))%ntasks);
-        sprintf(stat_name, "mdtest.%d.", (0+(1*nstride))%ntasks);
-        sprintf(read_name, "mdtest.%d.", (0+(2*nstride))%ntasks);
-        sprintf(rm_name, "mdtest.%d.", (0+(3*nstride))%ntasks);
-    }
-    if (unique_dir_per_task) {
-        sprintf(unique_mk_dir, "%s/mdtest_tree.%d.0", testdir,
-                (0+(0*nstride))%ntasks);
-        sprintf(unique_chdir_dir, "%s/mdtest_tree.%d.0", testdir,
-                (0+(1*nstride))%ntasks);
-        sprintf(unique_stat_dir, "%s/mdtest_tree.%d.0", testdir,
-                (0+(2*nstride))%ntasks);
-        sprintf(unique_read_dir, "%s/mdtest_tree.%d.0", testdir,
-                (0+(3*nstride))%ntasks);
-        sprintf(unique_rm_dir, "%s/mdtest_tree.%d.0", testdir,
-                (0+(4*nstride))%ntasks);
-        sprintf(unique_rm_uni_dir, "%s", testdir);
-    }
-}
-
-void directory_test(const int iteration, const int ntasks, const char *path, rank_progress_t * progress) {
+        strcpy( temp_path, path );
+    }
+
+    /* the root is <prefix>.0, with -N it is the tree of another process */
+    strcpy(prefix, strrchr(temp_path, '/') ? strrchr(temp_path, '/') + 1 : temp_path);
+    dot = strrchr(prefix, '.');
+    if (dot != NULL) {
+        *dot = '\0';
+    }
+
+    start = MPI_Wtime();
+    list_tree(ctx, temp_path, prefix, 0, & state);
+    if (ctx->o.barriers) {
+        MPI_Barrier(ctx->comm);
+    }
+    t = MPI_Wtime() - start;
+
+    local[0] = state.entries;
+    local[1] = state.bytes;
+    MPI_Allreduce(local, total, 2, MPI_UINT64_T, MPI_SUM, ctx->comm);
+
+    ctx->summary_table[iteration].rate[num] = total[0] / t;
+    ctx->summary_table[iteration].time[num] = t;
+    ctx->summary_table[iteration].items[num] = total[0];
+    ctx->summary_table[iteration].bytes[num] = total[1];
+
+    if (ctx->o.verbose >= 1 && ctx->rank == 0) {
+        fprintf(ctx->out, "V-1:   %s listing %s: %14.3f sec, %14.3f entries/sec, %.1f bytes/entry\n",
+                dirs ? "Directory" : "File", dirs ? "" : "     ", t, ctx->summary_table[iteration].rate[num],
+                total[0] ? (double) total[1] / total[0] : 0.0);
+        fflush(ctx->out);
+    }
+}
+
+void directory_test(mdtest_ctx_t * ctx, const int iteration, const int ntasks, const char *path, rank_progress_t * progress) {
     int size;
     double t[5] = {0};
     char temp_path[MAX_LEN];
 
-    MPI_Comm_size(testComm, &size);
+    MPI_Comm_size(ctx->comm, &size);
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering directory_test...\n" );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering directory_test...\n" );
+        fflush( ctx->out );
     }
 
-    MPI_Barrier(testComm);
+    MPI_Barrier(ctx->comm);
     t[0] = MPI_Wtime();
 
     /* create phase */
-    if(create_only) {
-        if (unique_dir_per_task) {
-            unique_dir_access(MK_UNI_DIR, temp_path);
-            if (!time_unique_dir_overhead) {
-                offset_timers(t, 0);
+    if(ctx->o.create_only) {
+        if (ctx->o.unique_dir_per_task) {
+            unique_dir_access(ctx, MK_UNI_DIR, temp_path);
+            if (!ctx->o.time_unique_dir_overhead) {
+                offset_timers(ctx, t, 0);
             }
         } else {
             strcpy( temp_path, path );
         }
 
-        if (verbose >= 3 && rank == 0) {
-            fprintf(out_logfile,  "V-3: directory_test: create path is \"%s\"\n", temp_path );
-            fflush( out_logfile );
+        if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+            fprintf(ctx->out,  "V-3: directory_test: create path is \"%s\"\n", temp_path );
+            fflush( ctx->out );
         }
 
         /* "touch" the files */
-        if (collective_creates) {
-            if (rank == 0) {
-                collective_create_remove(1, 1, ntasks, temp_path, progress);
-            }
+        series_begin(ctx, MDTEST_DIR_CREATE_NUM);
+        if (ctx->o.collective_creates) {
+            collective_create_remove(ctx, 1, 1, ntasks, temp_path, progress);
         } else {
             /* create directories */
-            create_remove_items(0, 1, 1, 0, temp_path, 0, progress);
+            create_remove_items(ctx, 0, 1, 1, 0, temp_path, 0, progress);
         }
+        series_end(ctx);
     }
 
-    if (barriers) {
-        MPI_Barrier(testComm);
+    if (ctx->o.barriers) {
+        MPI_Barrier(ctx->comm);
     }
     t[1] = MPI_Wtime();
 
     /* stat phase */
-    if (stat_only) {
-        if (unique_dir_per_task) {
-            unique_dir_access(STAT_SUB_DIR, temp_path);
-            if (!time_unique_dir_overhead) {
-                offset_timers(t, 1);
+    if (ctx->o.stat_only) {
+        if (ctx->o.unique_dir_per_task) {
+            unique_dir_access(ctx, STAT_SUB_DIR, temp_path);
+            if (!ctx->o.time_unique_dir_overhead) {
+                offset_timers(ctx, t, 1);
             }
         } else {
             strcpy( temp_path, path );
         }
 
-        if (verbose >= 3 && rank == 0) {
-            fprintf(out_logfile,  "V-3: directory_test: stat path is \"%s\"\n", temp_path );
-            fflush( out_logfile );
+        if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+            fprintf(ctx->out,  "V-3: directory_test: stat path is \"%s\"\n", temp_path );
+            fflush( ctx->out );
         }
 
         /* stat directories */
-        if (random_seed > 0) {
-            mdtest_stat(1, 1, temp_path, progress);
+        series_begin(ctx, MDTEST_DIR_STAT_NUM);
+        if (ctx->o.random_seed > 0) {
+            mdtest_stat(ctx, 1, 1, temp_path, progress);
         } else {
-            mdtest_stat(0, 1, temp_path, progress);
+            mdtest_stat(ctx, 0, 1, temp_path, progress);
         }
+        series_end(ctx);
     }
 
-    if (barriers) {
-        MPI_Barrier(testComm);
+    if (ctx->o.barriers) {
+        MPI_Barrier(ctx->comm);
     }
     t[2] = MPI_Wtime();
 
+    /* listing phase, timed on its own */
+    if (ctx->o.list_phase && ctx->o.stat_only) {
+        mdtest_list(ctx, iteration, 1, path);
+        t[2] = MPI_Wtime();
+    }
+
     /* read phase */
-    if (read_only) {
-        if (unique_dir_per_task) {
-            unique_dir_access(READ_SUB_DIR, temp_path);
-            if (!time_unique_dir_overhead) {
-                offset_timers(t, 2);
+    if (ctx->o.read_only) {
+        if (ctx->o.unique_dir_per_task) {
+            unique_dir_access(ctx, READ_SUB_DIR, temp_path);
+            if (!ctx->o.time_unique_dir_overhead) {
+                offset_timers(ctx, t, 2);
             }
         } else {
             strcpy( temp_path, path );
         }
 
-        if (verbose >= 3 && rank == 0) {
-            fprintf(out_logfile,  "V-3: directory_test: read path is \"%s\"\n", temp_path );
-            fflush( out_logfile );
+        if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+            fprintf(ctx->out,  "V-3: directory_test: read path is \"%s\"\n", temp_path );
+            fflush( ctx->out );
         }
 
         /* read directories */
-        if (random_seed > 0) {
+        if (ctx->o.random_seed > 0) {
             ;        /* N/A */
         } else {
             ;        /* N/A */
         }
     }
 
-    if (barriers) {
-        MPI_Barrier(testComm);
+    if (ctx->o.barriers) {
+        MPI_Barrier(ctx->comm);
     }
     t[3] = MPI_Wtime();
 
-    if (remove_only) {
-        if (unique_dir_per_task) {
-            unique_dir_access(RM_SUB_DIR, temp_path);
-            if (!time_unique_dir_overhead) {
-                offset_timers(t, 3);
+    if (ctx->o.remove_only) {
+        if (ctx->o.unique_dir_per_task) {
+            unique_dir_access(ctx, RM_SUB_DIR, temp_path);
+            if (!ctx->o.time_unique_dir_overhead) {
+                offset_timers(ctx, t, 3);
             }
         } else {
             strcpy( temp_path, path );
         }
 
-        if (verbose >= 3 && rank == 0) {
-            fprintf(out_logfile,  "V-3: directory_test: remove directories path is \"%s\"\n", temp_path );
-            fflush( out_logfile );
+        if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+            fprintf(ctx->out,  "V-3: directory_test: remove directories path is \"%s\"\n", temp_path );
+            fflush( ctx->out );
         }
 
         double start_timer = GetTimeStamp();
         /* remove directories */
-        if (collective_creates) {
-            if (rank == 0) {
-                collective_create_remove(0, 1, ntasks, temp_path, progress);
-            }
+        series_begin(ctx, MDTEST_DIR_REMOVE_NUM);
+        if (ctx->o.collective_creates) {
+            collective_create_remove(ctx, 0, 1, ntasks, temp_path, progress);
         } else {
-            create_remove_items(0, 1, 0, 0, temp_path, 0, progress);
+            create_remove_items(ctx, 0, 1, 0, 0, temp_path, 0, progress);
         }
+        series_end(ctx);
     }
 
-    if (barriers) {
-        MPI_Barrier(testComm);
+    if (ctx->o.barriers) {
+        MPI_Barrier(ctx->comm);
     }
     t[4] = MPI_Wtime();
 
-    if (remove_only) {
-        if (unique_dir_per_task) {
-            unique_dir_access(RM_UNI_DIR, temp_path);
+    if (ctx->o.remove_only) {
+        if (ctx->o.unique_dir_per_task) {
+            unique_dir_access(ctx, RM_UNI_DIR, temp_path);
         } else {
             strcpy( temp_path, path );
         }
 
-        if (verbose >= 3 && rank == 0) {
-            fprintf(out_logfile,  "V-3: directory_test: remove unique directories path is \"%s\"\n", temp_path );
-            fflush( out_logfile );
+        if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+            fprintf(ctx->out,  "V-3: directory_test: remove unique directories path is \"%s\"\n", temp_path );
+            fflush( ctx->out );
         }
     }
 
-    if (unique_dir_per_task && !time_unique_dir_overhead) {
-        offset_timers(t, 4);
+    if (ctx->o.unique_dir_per_task && !ctx->o.time_unique_dir_overhead) {
+        offset_timers(ctx, t, 4);
     }
 
     /* calculate times */
-    if (create_only) {
-        summary_table[iteration].rate[0] = items*size/(t[1] - t[0]);
-        summary_table[iteration].time[0] = t[1] - t[0];
-        summary_table[iteration].items[0] = items*size;
-        summary_table[iteration].stonewall_last_item[0] = items;
-    }
-    if (stat_only) {
-        summary_table[iteration].rate[1] = items*size/(t[2] - t[1]);
-        summary_table[iteration].time[1] = t[2] - t[1];
-        summary_table[iteration].items[1] = items*size;
-        summary_table[iteration].stonewall_last_item[1] = items;
-    }
-    if (read_only) {
-        summary_table[iteration].rate[2] = items*size/(t[3] - t[2]);
-        summary_table[iteration].time[2] = t[3] - t[2];
-        summary_table[iteration].items[2] = items*size;
-        summary_table[iteration].stonewall_last_item[2] = items;
-    }
-    if (remove_only) {
-        summary_table[iteration].rate[3] = items*size/(t[4] - t[3]);
-        summary_table[iteration].time[3] = t[4] - t[3];
-        summary_table[iteration].items[3] = items*size;
-        summary_table[iteration].stonewall_last_item[3] = items;
-    }
-
-    if (verbose >= 1 && rank == 0) {
-        fprintf(out_logfile, "V-1:   Directory creation: %14.3f sec, %14.3f ops/sec\n",
-               t[1] - t[0], summary_table[iteration].rate[0]);
-        fprintf(out_logfile, "V-1:   Directory stat    : %14.3f sec, %14.3f ops/sec\n",
-               t[2] - t[1], summary_table[iteration].rate[1]);
+    if (ctx->o.create_only) {
+        ctx->summary_table[iteration].rate[0] = ctx->o.items*size/(t[1] - t[0]);
+        ctx->summary_table[iteration].time[0] = t[1] - t[0];
+        ctx->summary_table[iteration].items[0] = ctx->o.items*size;
+        ctx->summary_table[iteration].stonewall_last_item[0] = ctx->o.items;
+    }
+    if (ctx->o.stat_only) {
+        ctx->summary_table[iteration].rate[1] = ctx->o.items*size/(t[2] - t[1]);
+        ctx->summary_table[iteration].time[1] = t[2] - t[1];
+        ctx->summary_table[iteration].items[1] = ctx->o.items*size;
+        ctx->summary_table[iteration].stonewall_last_item[1] = ctx->o.items;
+    }
+    if (ctx->o.read_only) {
+        ctx->summary_table[iteration].rate[2] = ctx->o.items*size/(t[3] - t[2]);
+        ctx->summary_table[iteration].time[2] = t[3] - t[2];
+        ctx->summary_table[iteration].items[2] = ctx->o.items*size;
+        ctx->summary_table[iteration].stonewall_last_item[2] = ctx->o.items;
+    }
+    if (ctx->o.remove_only) {
+        ctx->summary_table[iteration].rate[3] = ctx->o.items*size/(t[4] - t[3]);
+        ctx->summary_table[iteration].time[3] = t[4] - t[3];
+        ctx->summary_table[iteration].items[3] = ctx->o.items*size;
+        ctx->summary_table[iteration].stonewall_last_item[3] = ctx->o.items;
+    }
+
+    if (ctx->o.verbose >= 1 && ctx->rank == 0) {
+        fprintf(ctx->out, "V-1:   Directory creation: %14.3f sec, %14.3f ops/sec\n",
+               t[1] - t[0], ctx->summary_table[iteration].rate[0]);
+        fprintf(ctx->out, "V-1:   Directory stat    : %14.3f sec, %14.3f ops/sec\n",
+               t[2] - t[1], ctx->summary_table[iteration].rate[1]);
 /* N/A
    fprintf(out_logfile, "V-1:   Directory read    : %14.3f sec, %14.3f ops/sec\n",
    t[3] - t[2], summary_table[iteration].rate[2]);
 */
-        fprintf(out_logfile, "V-1:   Directory removal : %14.3f sec, %14.3f ops/sec\n",
-               t[4] - t[3], summary_table[iteration].rate[3]);
-        fflush(out_logfile);
+        fprintf(ctx->out, "V-1:   Directory removal : %14.3f sec, %14.3f ops/sec\n",
+               t[4] - t[3], ctx->summary_table[iteration].rate[3]);
+        fflush(ctx->out);
     }
+
+    series_write(ctx, iteration, path);
 }
 
-void file_test(const int iteration, const int ntasks, const char *path, rank_progress_t * progress) {
+void file_test(mdtest_ctx_t * ctx, const int iteration, const int ntasks, const char *path, rank_progress_t * progress) {
     int size;
     double t[5] = {0};
     char temp_path[MAX_LEN];
-    MPI_Comm_size(testComm, &size);
+    MPI_Comm_size(ctx->comm, &size);
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering file_test...\n" );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering file_test...\n" );
+        fflush( ctx->out );
     }
 
-    MPI_Barrier(testComm);
+    MPI_Barrier(ctx->comm);
     t[0] = MPI_Wtime();
 
     /* create phase */
-    if (create_only && ! CHECK_STONE_WALL(progress)) {
-        if (unique_dir_per_task) {
-            unique_dir_access(MK_UNI_DIR, temp_path);
-            if (!time_unique_dir_overhead) {
-                offset_timers(t, 0);
+    if (ctx->o.create_only && ! CHECK_STONE_WALL(progress)) {
+        if (ctx->o.unique_dir_per_task) {
+            unique_dir_access(ctx, MK_UNI_DIR, temp_path);
+            if (!ctx->o.time_unique_dir_overhead) {
+                offset_timers(ctx, t, 0);
             }
         } else {
             strcpy( temp_path, path );
         }
 
-        if (verbose >= 3 && rank == 0) {
-            fprintf(out_logfile,  "V-3: file_test: create path is \"%s\"\n", temp_path );
-            fflush( out_logfile );
+        if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+            fprintf(ctx->out,  "V-3: file_test: create path is \"%s\"\n", temp_path );
+            fflush( ctx->out );
         }
 
         /* "touch" the files */
-        if (collective_creates) {
-            if (rank == 0) {
-                collective_create_remove(1, 0, ntasks, temp_path, progress);
-            }
-            MPI_Barrier(testComm);
+        series_begin(ctx, MDTEST_FILE_CREATE_NUM);
+        if (ctx->o.collective_creates) {
+            collective_create_remove(ctx, 1, 0, ntasks, temp_path, progress);
+            /* hand the files over to their owners, they only wait for their own aggregator */
+            MPI_Barrier(ctx->aggregator_comm);
         }
 
         /* create files */
-        create_remove_items(0, 0, 1, 0, temp_path, 0, progress);
-        if(stone_wall_timer_seconds){
-          if (verbose >= 1 ) {
-            fprintf( out_logfile, "V-1: rank %d stonewall hit with %lld items\n", rank, progress->items_done );
-            fflush( out_logfile );
+        create_remove_items(ctx, 0, 0, 1, 0, temp_path, 0, progress);
+        if(ctx->o.stone_wall_timer_seconds){
+          if (ctx->o.verbose >= 1 ) {
+            fprintf( ctx->out, "V-1: rank %d stonewall hit with %lld items\n", ctx->rank, progress->items_done );
+            fflush( ctx->out );
           }
           long long unsigned max_iter = 0;
-          MPI_Allreduce(& progress->items_done, & max_iter, 1, MPI_INT, MPI_MAX, testComm);
-          summary_table[iteration].stonewall_time[MDTEST_FILE_CREATE_NUM] = MPI_Wtime() - t[0];
+          MPI_Allreduce(& progress->items_done, & max_iter, 1, MPI_INT, MPI_MAX, ctx->comm);
+          ctx->summary_table[iteration].stonewall_time[MDTEST_FILE_CREATE_NUM] = MPI_Wtime() - t[0];
 
           // continue to the maximum...
           long long min_accessed = 0;
-          MPI_Reduce(& progress->items_done, & min_accessed, 1, MPI_LONG_LONG_INT, MPI_MIN, 0, testComm);
+          MPI_Reduce(& progress->items_done, & min_accessed, 1, MPI_LONG_LONG_INT, MPI_MIN, 0, ctx->comm);
 
           long long sum_accessed = 0;
-          MPI_Reduce(& progress->items_done, & sum_accessed, 1, MPI_LONG_LONG_INT, MPI_SUM, 0, testComm);
+          MPI_Reduce(& progress->items_done, & sum_accessed, 1, MPI_LONG_LONG_INT, MPI_SUM, 0, ctx->comm);
 
-          if (rank == 0 && items != sum_accessed / size) {
-            summary_table[iteration].stonewall_item_sum[MDTEST_FILE_CREATE_NUM] = sum_accessed;
-            summary_table[iteration].stonewall_item_min[MDTEST_FILE_CREATE_NUM] = min_accessed * size;
-            fprintf( out_logfile, "V-1: continue stonewall hit min: %lld max: %lld avg: %.1f \n", min_accessed, max_iter, ((double) sum_accessed) / size);
-            fflush( out_logfile );
+          if (ctx->rank == 0 && ctx->o.items != sum_accessed / size) {
+            ctx->summary_table[iteration].stonewall_item_sum[MDTEST_FILE_CREATE_NUM] = sum_accessed;
+            ctx->summary_table[iteration].stonewall_item_min[MDTEST_FILE_CREATE_NUM] = min_accessed * size;
+            fprintf( ctx->out, "V-1: continue stonewall hit min: %lld max: %lld avg: %.1f \n", min_accessed, max_iter, ((double) sum_accessed) / size);
+            fflush( ctx->out );
           }
 
           progress->stone_wall_timer_seconds = 0;
           progress->items_start = progress->items_done;
           progress->items_per_dir = max_iter;
-          create_remove_items(0, 0, 1, 0, temp_path, 0, progress);
-          progress->stone_wall_timer_seconds = stone_wall_timer_seconds;
-          items = max_iter;
+          create_remove_items(ctx, 0, 0, 1, 0, temp_path, 0, progress);
+          progress->stone_wall_timer_seconds = ctx->o.stone_wall_timer_seconds;
+          ctx->o.items = max_iter;
           progress->items_done = max_iter;
         }
+        series_end(ctx);
     }
 
-    if (barriers) {
-      MPI_Barrier(testComm);
+    if (ctx->o.barriers) {
+      MPI_Barrier(ctx->comm);
     }
     t[1] = MPI_Wtime();
 
     /* stat phase */
-    if (stat_only && ! CHECK_STONE_WALL(progress)) {
-        if (unique_dir_per_task) {
-            unique_dir_access(STAT_SUB_DIR, temp_path);
-            if (!time_unique_dir_overhead) {
-                offset_timers(t, 1);
+    if (ctx->o.stat_only && ! CHECK_STONE_WALL(progress)) {
+        if (ctx->o.unique_dir_per_task) {
+            unique_dir_access(ctx, STAT_SUB_DIR, temp_path);
+            if (!ctx->o.time_unique_dir_overhead) {
+                offset_timers(ctx, t, 1);
             }
         } else {
             strcpy( temp_path, path );
         }
 
-        if (verbose >= 3 && rank == 0) {
-            fprintf(out_logfile,  "V-3: file_test: stat path is \"%s\"\n", temp_path );
-            fflush( out_logfile );
+        if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+            fprintf(ctx->out,  "V-3: file_test: stat path is \"%s\"\n", temp_path );
+            fflush( ctx->out );
         }
 
         /* stat files */
-        if (random_seed > 0) {
-                mdtest_stat(1,0,temp_path, progress);
+        series_begin(ctx, MDTEST_FILE_STAT_NUM);
+        if (ctx->o.random_seed > 0) {
+                mdtest_stat(ctx, 1,0,temp_path, progress);
         } else {
-                mdtest_stat(0,0,temp_path, progress);
+                mdtest_stat(ctx, 0,0,temp_path, progress);
         }
+        series_end(ctx);
     }
 
-    if (barriers) {
-        MPI_Barrier(testComm);
+    if (ctx->o.barriers) {
+        MPI_Barrier(ctx->comm);
     }
     t[2] = MPI_Wtime();
 
+    /* listing phase, timed on its own */
+    if (ctx->o.list_phase && ctx->o.stat_only && ! CHECK_STONE_WALL(progress)) {
+        mdtest_list(ctx, iteration, 0, path);
+        t[2] = MPI_Wtime();
+    }
+
     /* read phase */
-    if (read_only && ! CHECK_STONE_WALL(progress)) {
-        if (unique_dir_per_task) {
-            unique_dir_access(READ_SUB_DIR, temp_path);
-            if (!time_unique_dir_overhead) {
-                offset_timers(t, 2);
+    if (ctx->o.read_only && ! CHECK_STONE_WALL(progress)) {
+        if (ctx->o.unique_dir_per_task) {
+            unique_dir_access(ctx, READ_SUB_DIR, temp_path);
+            if (!ctx->o.time_unique_dir_overhead) {
+                offset_timers(ctx, t, 2);
             }
         } else {
             strcpy( temp_path, path );
         }
 
-        if (verbose >= 3 && rank == 0) {
-            fprintf(out_logfile,  "V-3: file_test: read path is \"%s\"\n", temp_path );
-            fflush( out_logfile );
+        if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+            fprintf(ctx->out,  "V-3: file_test: read path is \"%s\"\n", temp_path );
+            fflush( ctx->out );
         }
 
         /* read files */
-        if (random_seed > 0) {
-                mdtest_read(1,0,temp_path);
+        series_begin(ctx, MDTEST_FILE_READ_NUM);
+        if (ctx->o.random_seed > 0) {
+                mdtest_read(ctx, 1,0,temp_path);
         } else {
-                mdtest_read(0,0,temp_path);
+                mdtest_read(ctx, 0,0,temp_path);
         }
+        series_end(ctx);
     }
 
-    if (barriers) {
-        MPI_Barrier(testComm);
+    if (ctx->o.barriers) {
+        MPI_Barrier(ctx->comm);
     }
     t[3] = MPI_Wtime();
 
-    if (remove_only && ! CHECK_STONE_WALL(progress)) {
-        if (unique_dir_per_task) {
-            unique_dir_access(RM_SUB_DIR, temp_path);
-            if (!time_unique_dir_overhead) {
-                offset_timers(t, 3);
+    if (ctx->o.remove_only && ! CHECK_STONE_WALL(progress)) {
+        if (ctx->o.unique_dir_per_task) {
+            unique_dir_access(ctx, RM_SUB_DIR, temp_path);
+            if (!ctx->o.time_unique_dir_overhead) {
+                offset_timers(ctx, t, 3);
             }
         } else {
             strcpy( temp_path, path );
         }
 
-        if (verbose >= 3 && rank == 0) {
-            fprintf(out_logfile,  "V-3: file_test: rm directories path is \"%s\"\n", temp_path );
-            fflush( out_logfile );
-        }
+        if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+            fprintf(ctx->out,  "V-3: file_test: rm directories path is \"%s\"\n", temp_path );
+            fflush( ctx->out );
+        }
+
+        series_begin(ctx, MDTEST_FILE_REMOVE_NUM);
+        if (ctx->o.collective_creates) {
+            collective_create_remove(ctx, 0, 0, ntasks, temp_path, progress);
+        } else {
+            create_remove_items(ctx, 0, 0, 0, 0, temp_path, 0, progress);
+        }
+        series_end(ctx);
+    }
+
+    if (ctx->o.barriers) {
+        MPI_Barrier(ctx->comm);
+    }
+    t[4] = MPI_Wtime();
+    if (ctx->o.remove_only && ! CHECK_STONE_WALL(progress)) {
+        if (ctx->o.unique_dir_per_task) {
+            unique_dir_access(ctx, RM_UNI_DIR, temp_path);
+        } else {
+            strcpy( temp_path, path );
+        }
+
+        if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+            fprintf(ctx->out,  "V-3: file_test: rm unique directories path is \"%s\"\n", temp_path );
+            fflush( ctx->out );
+        }
+    }
+
+    if (ctx->o.unique_dir_per_task && !ctx->o.time_unique_dir_overhead) {
+        offset_timers(ctx, t, 4);
+    }
+
+    /* calculate times */
+    if (ctx->o.create_only) {
+        ctx->summary_table[iteration].rate[4] = ctx->o.items*size/(t[1] - t[0]);
+        ctx->summary_table[iteration].time[4] = t[1] - t[0];
+        ctx->summary_table[iteration].items[4] = ctx->o.items*size;
+        ctx->summary_table[iteration].stonewall_last_item[4] = ctx->o.items;
+    }
+    if (ctx->o.stat_only) {
+        ctx->summary_table[iteration].rate[5] = ctx->o.items*size/(t[2] - t[1]);
+        ctx->summary_table[iteration].time[5] = t[2] - t[1];
+        ctx->summary_table[iteration].items[5] = ctx->o.items*size;
+        ctx->summary_table[iteration].stonewall_last_item[5] = ctx->o.items;
+    }
+    if (ctx->o.read_only) {
+        ctx->summary_table[iteration].rate[6] = ctx->o.items*size/(t[3] - t[2]);
+        ctx->summary_table[iteration].time[6] = t[3] - t[2];
+        ctx->summary_table[iteration].items[6] = ctx->o.items*size;
+        ctx->summary_table[iteration].stonewall_last_item[6] = ctx->o.items;
+    }
+    if (ctx->o.remove_only) {
+        ctx->summary_table[iteration].rate[7] = ctx->o.items*size/(t[4] - t[3]);
+        ctx->summary_table[iteration].time[7] = t[4] - t[3];
+        ctx->summary_table[iteration].items[7] = ctx->o.items*size;
+        ctx->summary_table[iteration].stonewall_last_item[7] = ctx->o.items;
+    }
+
+    if (ctx->o.verbose >= 1 && ctx->rank == 0) {
+        fprintf(ctx->out, "V-1:   File creation     : %14.3f sec, %14.3f ops/sec\n",
+               t[1] - t[0], ctx->summary_table[iteration].rate[4]);
+        fprintf(ctx->out, "V-1:   File stat         : %14.3f sec, %14.3f ops/sec\n",
+               t[2] - t[1], ctx->summary_table[iteration].rate[5]);
+        fprintf(ctx->out, "V-1:   File read         : %14.3f sec, %14.3f ops/sec\n",
+               t[3] - t[2], ctx->summary_table[iteration].rate[6]);
+        fprintf(ctx->out, "V-1:   File removal      : %14.3f sec, %14.3f ops/sec\n",
+               t[4] - t[3], ctx->summary_table[iteration].rate[7]);
+        fflush(ctx->out);
+    }
+
+    series_write(ctx, iteration, path);
+}
+
+/* per interval statistics of the mixed workload for one operation type */
+typedef struct {
+    long long ops;
+    double latency_sum;
+    double latency_max;
+} mixed_sample_t;
+
+enum {MIXED_CREATE, MIXED_STAT, MIXED_READ, MIXED_REMOVE, MIXED_OP_COUNT};
+
+static const char *mixed_op_name[MIXED_OP_COUNT] = {"create", "stat", "read", "remove"};
+
+/*
+ * Steady-state mixed workload: each rank keeps a working set of
+ * mixed_working_set files in its directory and, in rounds, creates new files,
+ * stats or reads existing ones and removes the oldest, interleaved according
+ * to mixed_ratio.  Throughput and latency are sampled every mixed_interval
+ * seconds.
+ */
+void mixed_test(mdtest_ctx_t * ctx, const int iteration, const char *path, rank_progress_t * progress) {
+    int size;
+    int op, round_len = 0;
+    int round_ops[MIXED_OP_COUNT * 100];
+    uint64_t oldest = 0, next = 0, round = 0;
+    long long op_count[MIXED_OP_COUNT] = {0};
+    long long op_sum[MIXED_OP_COUNT];
+    mixed_sample_t *samples = NULL;
+    int sample_count = 0, max_samples = 0;
+    unsigned int seed = ctx->o.random_seed > 0 ? ctx->o.random_seed : ctx->rank + 1;
+    char item[MAX_LEN], name[NAME_MAX + 1];
+    struct stat buf;
+    double t_start, t_end, runtime, max_runtime;
+
+    MPI_Comm_size(ctx->comm, &size);
+
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering mixed_test...\n" );
+        fflush( ctx->out );
+    }
+
+    if (ctx->o.read_bytes > 0 && ctx->read_buffer == NULL) {
+        ctx->read_buffer = alloc_io_buffer(ctx, ctx->read_io_size);
+    }
+
+    /* the sequence of operations of one round, shuffled before each round */
+    for (op = 0; op < MIXED_OP_COUNT; op++) {
+        for (int i = 0; i < ctx->o.mixed_ratio[op]; i++) {
+            round_ops[round_len++] = op;
+        }
+    }
+
+    /* populate the working set, this is not timed */
+    for (next = 0; next < ctx->o.mixed_working_set; next++) {
+        create_file (ctx, path, next);
+    }
+
+    MPI_Barrier(ctx->comm);
+    t_start = GetTimeStamp();
+
+    while ((ctx->o.mixed_rounds == 0 || round < ctx->o.mixed_rounds) && ! CHECK_STONE_WALL(progress)) {
+        for (int i = round_len - 1; i > 0; i--) {
+            int k = rand_r(& seed) % (i + 1);
+            int tmp = round_ops[k];
+            round_ops[k] = round_ops[i];
+            round_ops[i] = tmp;
+        }
+
+        for (int i = 0; i < round_len; i++) {
+            double t_op;
+
+            op = round_ops[i];
+            if (op != MIXED_CREATE && next == oldest) {
+                /* the working set is exhausted */
+                continue;
+            }
+
+            t_op = GetTimeStamp();
+            uint64_t lat_start = latency_now(ctx);
+            switch (op) {
+            case MIXED_CREATE:
+                create_file (ctx, path, next);
+                next++;
+                break;
+            case MIXED_STAT:
+                sprintf(item, "%s/%s", path, item_name(ctx, name, "file.", ctx->mk_name, oldest + rand_r(& seed) % (next - oldest)));
+                if (-1 == stat_item (ctx, item, &buf)) {
+                    FAIL("unable to stat file");
+                }
+                break;
+            case MIXED_READ: {
+                uint64_t num = oldest + rand_r(& seed) % (next - oldest);
+                sprintf(item, "%s/%s", path, item_name(ctx, name, "file.", ctx->mk_name, num));
+                read_file (ctx, item, item_key(ctx->mk_name, num));
+                break;
+            }
+            case MIXED_REMOVE:
+                remove_file (ctx, path, oldest);
+                oldest++;
+                break;
+            }
+            latency_record(ctx, MDTEST_MIXED_CREATE_NUM + op, lat_start);
+            double now = GetTimeStamp();
+            double latency = now - t_op;
+
+            int pos = (int) ((now - t_start) / ctx->o.mixed_interval);
+            if (pos >= max_samples) {
+                int new_max = max_samples == 0 ? 64 : max_samples * 2;
+                while (new_max <= pos) {
+                    new_max *= 2;
+                }
+                samples = realloc(samples, new_max * MIXED_OP_COUNT * sizeof(mixed_sample_t));
+                if (samples == NULL) {
+                    FAIL("out of memory");
+                }
+                memset(& samples[max_samples * MIXED_OP_COUNT], 0, (new_max - max_samples) * MIXED_OP_COUNT * sizeof(mixed_sample_t));
+                max_samples = new_max;
+            }
+            if (pos >= sample_count) {
+                sample_count = pos + 1;
+            }
+            mixed_sample_t *sample = & samples[pos * MIXED_OP_COUNT + op];
+            sample->ops++;
+            sample->latency_sum += latency;
+            if (latency > sample->latency_max) {
+                sample->latency_max = latency;
+            }
+            op_count[op]++;
+        }
+        round++;
+    }
+    t_end = GetTimeStamp();
+    runtime = t_end - t_start;
+
+    if (ctx->o.verbose >= 1) {
+        fprintf(ctx->out, "V-1: rank %d mixed workload completed "LLU" rounds\n", ctx->rank, round);
+        fflush(ctx->out);
+    }
+
+    MPI_Barrier(ctx->comm);
 
-        if (collective_creates) {
-            if (rank == 0) {
-                collective_create_remove(0, 0, ntasks, temp_path, progress);
-            }
-        } else {
-            create_remove_items(0, 0, 0, 0, temp_path, 0, progress);
-        }
+    /* drain the working set, this is not timed */
+    for ( ; oldest < next; oldest++) {
+        remove_file (ctx, path, oldest);
     }
 
-    if (barriers) {
-        MPI_Barrier(testComm);
+    MPI_Allreduce(op_count, op_sum, MIXED_OP_COUNT, MPI_LONG_LONG_INT, MPI_SUM, ctx->comm);
+    MPI_Allreduce(& runtime, & max_runtime, 1, MPI_DOUBLE, MPI_MAX, ctx->comm);
+
+    for (op = 0; op < MIXED_OP_COUNT; op++) {
+        ctx->summary_table[iteration].rate[MDTEST_MIXED_CREATE_NUM + op] = op_sum[op] / max_runtime;
+        ctx->summary_table[iteration].time[MDTEST_MIXED_CREATE_NUM + op] = max_runtime;
+        ctx->summary_table[iteration].items[MDTEST_MIXED_CREATE_NUM + op] = op_sum[op];
     }
-    t[4] = MPI_Wtime();
-    if (remove_only && ! CHECK_STONE_WALL(progress)) {
-        if (unique_dir_per_task) {
-            unique_dir_access(RM_UNI_DIR, temp_path);
-        } else {
-            strcpy( temp_path, path );
+
+    /* aggregate the time series, all ranks started their clock after the same barrier */
+    int total_samples = 0;
+    MPI_Allreduce(& sample_count, & total_samples, 1, MPI_INT, MPI_MAX, ctx->comm);
+    if (total_samples > max_samples) {
+        samples = realloc(samples, total_samples * MIXED_OP_COUNT * sizeof(mixed_sample_t));
+        if (samples == NULL) {
+            FAIL("out of memory");
         }
+        memset(& samples[max_samples * MIXED_OP_COUNT], 0, (total_samples - max_samples) * MIXED_OP_COUNT * sizeof(mixed_sample_t));
+    }
 
-        if (verbose >= 3 && rank == 0) {
-            fprintf(out_logfile,  "V-3: file_test: rm unique directories path is \"%s\"\n", temp_path );
-            fflush( out_logfile );
+    int n = total_samples * MIXED_OP_COUNT;
+    long long *ops = malloc(n * sizeof(long long));
+    double *lat_sum = malloc(n * sizeof(double));
+    double *lat_max = malloc(n * sizeof(double));
+    long long *all_ops = malloc(n * sizeof(long long));
+    double *all_lat_sum = malloc(n * sizeof(double));
+    double *all_lat_max = malloc(n * sizeof(double));
+    if (n > 0 && (ops == NULL || lat_sum == NULL || lat_max == NULL || all_ops == NULL || all_lat_sum == NULL || all_lat_max == NULL)) {
+        FAIL("out of memory");
+    }
+    for (int i = 0; i < n; i++) {
+        ops[i] = samples[i].ops;
+        lat_sum[i] = samples[i].latency_sum;
+        lat_max[i] = samples[i].latency_max;
+    }
+    MPI_Reduce(ops, all_ops, n, MPI_LONG_LONG_INT, MPI_SUM, 0, ctx->comm);
+    MPI_Reduce(lat_sum, all_lat_sum, n, MPI_DOUBLE, MPI_SUM, 0, ctx->comm);
+    MPI_Reduce(lat_max, all_lat_max, n, MPI_DOUBLE, MPI_MAX, 0, ctx->comm);
+
+    if (ctx->rank == 0) {
+        fprintf(ctx->out, "\nMixed workload (working set "LLU" per rank, ratio %d:%d:%d:%d), interval %.2f s:\n",
+                ctx->o.mixed_working_set, ctx->o.mixed_ratio[0], ctx->o.mixed_ratio[1], ctx->o.mixed_ratio[2], ctx->o.mixed_ratio[3], ctx->o.mixed_interval);
+        fprintf(ctx->out, "   Time(s)");
+        for (op = 0; op < MIXED_OP_COUNT; op++) {
+            fprintf(ctx->out, " %8s ops/s  avg(ms)  max(ms)", mixed_op_name[op]);
+        }
+        fprintf(ctx->out, "\n");
+        for (int s = 0; s < total_samples; s++) {
+            fprintf(ctx->out, "%10.2f", (s + 1) * ctx->o.mixed_interval);
+            for (op = 0; op < MIXED_OP_COUNT; op++) {
+                int i = s * MIXED_OP_COUNT + op;
+                double avg = all_ops[i] > 0 ? all_lat_sum[i] / all_ops[i] : 0;
+                fprintf(ctx->out, " %14.1f %8.3f %8.3f", all_ops[i] / ctx->o.mixed_interval, avg * 1000, all_lat_max[i] * 1000);
+            }
+            fprintf(ctx->out, "\n");
         }
+        fflush(ctx->out);
     }
 
-    if (unique_dir_per_task && !time_unique_dir_overhead) {
-        offset_timers(t, 4);
+    free(ops);
+    free(lat_sum);
+    free(lat_max);
+    free(all_ops);
+    free(all_lat_sum);
+    free(all_lat_max);
+    free(samples);
+
+    if (ctx->o.verbose >= 1 && ctx->rank == 0) {
+        for (op = 0; op < MIXED_OP_COUNT; op++) {
+            fprintf(ctx->out, "V-1:   Mixed %-11s: %14.3f sec, %14.3f ops/sec\n", mixed_op_name[op],
+                    max_runtime, ctx->summary_table[iteration].rate[MDTEST_MIXED_CREATE_NUM + op]);
+        }
+        fflush(ctx->out);
     }
+}
 
-    /* calculate times */
-    if (create_only) {
-        summary_table[iteration].rate[4] = items*size/(t[1] - t[0]);
-        summary_table[iteration].time[4] = t[1] - t[0];
-        summary_table[iteration].items[4] = items*size;
-        summary_table[iteration].stonewall_last_item[4] = items;
-    }
-    if (stat_only) {
-        summary_table[iteration].rate[5] = items*size/(t[2] - t[1]);
-        summary_table[iteration].time[5] = t[2] - t[1];
-        summary_table[iteration].items[5] = items*size;
-        summary_table[iteration].stonewall_last_item[5] = items;
-    }
-    if (read_only) {
-        summary_table[iteration].rate[6] = items*size/(t[3] - t[2]);
-        summary_table[iteration].time[6] = t[3] - t[2];
-        summary_table[iteration].items[6] = items*size;
-        summary_table[iteration].stonewall_last_item[6] = items;
-    }
-    if (remove_only) {
-        summary_table[iteration].rate[7] = items*size/(t[4] - t[3]);
-        summary_table[iteration].time[7] = t[4] - t[3];
-        summary_table[iteration].items[7] = items*size;
-        summary_table[iteration].stonewall_last_item[7] = items;
-    }
-
-    if (verbose >= 1 && rank == 0) {
-        fprintf(out_logfile, "V-1:   File creation     : %14.3f sec, %14.3f ops/sec\n",
-               t[1] - t[0], summary_table[iteration].rate[4]);
-        fprintf(out_logfile, "V-1:   File stat         : %14.3f sec, %14.3f ops/sec\n",
-               t[2] - t[1], summary_table[iteration].rate[5]);
-        fprintf(out_logfile, "V-1:   File read         : %14.3f sec, %14.3f ops/sec\n",
-               t[3] - t[2], summary_table[iteration].rate[6]);
-        fprintf(out_logfile, "V-1:   File removal      : %14.3f sec, %14.3f ops/sec\n",
-               t[4] - t[3], summary_table[iteration].rate[7]);
-        fflush(out_logfile);
-    }
-}
-
-void print_help (void) {
+void print_help (FILE * out) {
     int j;
 
-    fprintf(out_logfile,
+    fprintf(out,
         "Usage: mdtest [-b branching_factor] [-B] [-c] [-C] [-d testdir] [-D] [-e number_of_bytes_to_read]\n"
         "              [-E] [-f first] [-F] [-h] [-i iterations] [-I items_per_dir] [-l last] [-L]\n"
-        "              [-n number_of_items] [-N stride_length] [-p seconds] [-r]\n"
+        "              [-n number_of_items] [-N stride_length] [-O key=value] [-p seconds] [-r]\n"
         "              [-R[seed]] [-s stride] [-S] [-t] [-T] [-u] [-v] [-a API]\n"
-        "              [-V verbosity_value] [-w number_of_bytes_to_write] [-W seconds] [-y] [-z depth] -Z\n"
+        "              [-V verbosity_value] [-w number_of_bytes_to_write] [-W seconds] [-X] [-y] [-z depth] -Z\n"
         "\t-a: API for I/O [POSIX|MPIIO|HDF5|HDFS|S3|S3_EMC|NCMPI]\n"
         "\t-b: branching factor of hierarchical directory structure\n"
         "\t-B: no barriers between phases\n"
-        "\t-c: collective creates: task 0 does all creates\n"
+        "\t-c: collective creates: one aggregator task per node does all creates and removes of the node\n"
         "\t-C: only create files/dirs\n"
         "\t-d: the directory in which the tests will run\n"
         "\t-D: perform test on directories only (no files)\n"
@@ -1377,6 +2404,7 @@ void print_help (void) {
         "\t-L: files only at leaf level of tree\n"
         "\t-n: every process will creat/stat/read/remove # directories and files\n"
         "\t-N: stride # between neighbor tasks for file/dir operation (local=0)\n"
+        "\t-O: extended options as comma separated key=value pairs, see below\n"
         "\t-p: pre-iteration delay (in seconds)\n"
         "\t-r: only remove files or directories left behind by previous runs\n"
         "\t-R: randomly stat files (optional argument for random seed)\n"
@@ -1389,9 +2417,32 @@ void print_help (void) {
         "\t-V: verbosity value\n"
         "\t-w: bytes to write to each file after it is created\n"
         "\t-W: number in seconds; stonewall timer, write as many seconds and ensure all processes did the same number of operations\n"
+        "\t-X: steady-state mixed workload of interleaved create/stat/read/remove instead of the individual phases\n"
         "\t-y: sync file after writing\n"
         "\t-z: depth of hierarchical directory structure\n"
         "\t-Z: print time instead of rate\n"
+        "Extended options (-O):\n"
+        "\tmixedWorkingSet=K: files each rank keeps in its directory for -X\n"
+        "\tmixedRatio=C:S:R:D: ratio of create:stat:read:remove operations per round for -X (default 1:1:1:1)\n"
+        "\tmixedRounds=N: rounds to run for -X, 0 runs until the stonewall timer (-W) is hit\n"
+        "\tmixedInterval=S: sampling interval in seconds for the -X time series (default 1)\n"
+        "\tcollectiveAggregators=N: number of aggregator tasks for -c, 0 uses one per node (default)\n"
+        "\tlist=1: list all directories of the tree after the stat phase\n"
+        "\tlistPlus=1: stat every listed entry (readdirplus)\n"
+        "\tlistBufferSize=B: bytes of the buffer used to read directories (default 32768)\n"
+        "\tstatMask=A[+A...]: only request these attributes when stat'ing: type, mode, size, mtime, ctime, all\n"
+        "\tstatDontSync=1: allow stat to return cached attributes (AT_STATX_DONT_SYNC)\n"
+        "\tlatency=1: measure the latency of every operation and report percentiles\n"
+        "\tnameScheme=S: names of the items: sequential (default), hex (random fixed-length hex),\n"
+        "\t\tlong (padded close to NAME_MAX) or prefix (long prefix shared by all names)\n"
+        "\tnameLength=N: hex digits for hex (default 16), name length for long, prefix length for prefix (default 200)\n"
+        "\tsmallFile=1: create, write and read files with plain POSIX calls and preset flags (POSIX API only)\n"
+        "\tdirectIO=1: use O_DIRECT with aligned buffers for the file data, implies smallFile\n"
+        "\tioAlignment=B: alignment of the buffers and transfers with directIO (default 4096)\n"
+        "\tsyncMode=M: none, fsync, fdatasync or dsync (O_DSYNC) after writing a file, implies smallFile except fsync\n"
+        "\tverify=1: write a signature unique to every file and verify it when reading\n"
+        "\trateSeries=PREFIX: write the item rate over time of every phase to PREFIX-<phase>.<iteration>.csv\n"
+        "\trateInterval=S: sampling interval in seconds for rateSeries (default 1)\n"
         );
 
     MPI_Initialized(&j);
@@ -1401,230 +2452,281 @@ void print_help (void) {
     exit(0);
 }
 
-void summarize_results(int iterations) {
-    char access[MAX_LEN];
-    int i, j, k;
+/*
+ * Running statistics of a set of values, merged with the parallel variant of
+ * Welford's algorithm so that the summary is computed by a reduction and no
+ * process has to hold the values of all processes.
+ */
+typedef struct {
+    double count;
+    double min;
+    double max;
+    double mean;
+    double m2;
+} mdtest_stat_t;
+
+static void stat_init(mdtest_stat_t * s) {
+    s->count = 0;
+    s->min = 0;
+    s->max = 0;
+    s->mean = 0;
+    s->m2 = 0;
+}
+
+static void stat_add(mdtest_stat_t * s, double value) {
+    double delta = value - s->mean;
+
+    if (s->count == 0 || value < s->min) {
+        s->min = value;
+    }
+    if (s->count == 0 || value > s->max) {
+        s->max = value;
+    }
+    s->count += 1;
+    s->mean += delta / s->count;
+    s->m2 += delta * (value - s->mean);
+}
+
+static void stat_merge(mdtest_stat_t * to, const mdtest_stat_t * from) {
+    double count, delta;
+
+    if (from->count == 0) {
+        return;
+    }
+    if (to->count == 0) {
+        *to = *from;
+        return;
+    }
+    count = to->count + from->count;
+    delta = from->mean - to->mean;
+    to->m2 += from->m2 + delta * delta * to->count * from->count / count;
+    to->mean += delta * from->count / count;
+    to->min = from->min < to->min ? from->min : to->min;
+    to->max = from->max > to->max ? from->max : to->max;
+    to->count = count;
+}
+
+static double stat_sd(const mdtest_stat_t * s) {
+    return s->count > 0 ? sqrt(s->m2 / s->count) : 0;
+}
+
+static void stat_reduce_op(void * in, void * inout, int * len, MPI_Datatype * type) {
+    mdtest_stat_t * from = (mdtest_stat_t *) in;
+    mdtest_stat_t * to = (mdtest_stat_t *) inout;
+    (void) type;
+
+    for (int i = 0; i < *len; i++) {
+        stat_merge(& to[i], & from[i]);
+    }
+}
+
+static const char * summary_label(int i) {
+    switch (i) {
+    case 0: return "Directory creation:";
+    case 1: return "Directory stat    :";
+    case 2: return "Directory read    :";
+    case 3: return "Directory removal :";
+    case 4: return "File creation     :";
+    case 5: return "File stat         :";
+    case 6: return "File read         :";
+    case 7: return "File removal      :";
+    case 8: return "Tree creation     :";
+    case 9: return "Tree removal      :";
+    case 10: return "Mixed create      :";
+    case 11: return "Mixed stat        :";
+    case 12: return "Mixed read        :";
+    case 13: return "Mixed removal     :";
+    case 14: return "Directory listing :";
+    case 15: return "File listing      :";
+    case MDTEST_FILE_CREATE_OPEN_NUM: return "  File create open:";
+    case MDTEST_FILE_CREATE_WRITE_NUM: return " File create write:";
+    case MDTEST_FILE_CREATE_CLOSE_NUM: return " File create close:";
+    default: return "ERR";
+    }
+}
+
+/* append the latency percentiles of all iterations in ms, if measured */
+static void summary_print_latency(mdtest_ctx_t * ctx, int i) {
+    mdtest_latency_t l;
+
+    if (ctx->o.measure_latency) {
+        latency_percentiles(& ctx->latency_total[i], & l);
+        if (l.ops > 0) {
+            fprintf(ctx->out, " %11.3f %11.3f %11.3f %11.3f", l.p50 * 1e3, l.p99 * 1e3, l.p999 * 1e3, l.max * 1e3);
+        }
+    }
+    fprintf(ctx->out, "\n");
+}
+
+static void summary_print_line(mdtest_ctx_t * ctx, int i, const mdtest_stat_t * s) {
+    fprintf(ctx->out, "   %s ", summary_label(i));
+    fprintf(ctx->out, "%14.3f ", s->max);
+    fprintf(ctx->out, "%14.3f ", s->min);
+    fprintf(ctx->out, "%14.3f ", s->mean);
+    fprintf(ctx->out, "%14.3f", stat_sd(s));
+    summary_print_latency(ctx, i);
+}
+
+void summarize_results(mdtest_ctx_t * ctx, int iterations) {
+    int i, j;
     int start, stop, tableSize = MDTEST_LAST_NUM;
-    double min, max, mean, sd, sum = 0, var = 0, curr = 0;
+    mdtest_stat_t stats[MDTEST_LAST_NUM];
 
-    double all[iterations * size * tableSize];
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering summarize_results...\n" );
+        fflush( ctx->out );
+    }
 
+    /* if files only access, skip entries 0-3 (the dir tests) */
+    if (ctx->o.files_only && !ctx->o.dirs_only) {
+        start = 4;
+    } else {
+        start = 0;
+    }
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering summarize_results...\n" );
-        fflush( out_logfile );
+    /* if directories only access, skip entries 4-7 (the file tests) */
+    if (ctx->o.dirs_only && !ctx->o.files_only) {
+        stop = 4;
+    } else {
+        stop = 8;
     }
 
-    MPI_Barrier(testComm);
-    for(int i=0; i < iterations; i++){
-      if(print_time){
-        MPI_Gather(& summary_table[i].time[0], tableSize, MPI_DOUBLE, & all[i*tableSize*size], tableSize, MPI_DOUBLE, 0, testComm);
-      }else{
-        MPI_Gather(& summary_table[i].rate[0], tableSize, MPI_DOUBLE, & all[i*tableSize*size], tableSize, MPI_DOUBLE, 0, testComm);
-      }
+    /* special case: if no directory or file tests, skip all */
+    if (!ctx->o.dirs_only && !ctx->o.files_only) {
+        start = stop = 0;
     }
 
-    if (rank == 0) {
+    for (i = 0; i < tableSize; i++) {
+        stat_init(& stats[i]);
+    }
 
-        fprintf(out_logfile, "\nSUMMARY %s: (of %d iterations)\n", print_time ? "time": "rate", iterations);
-        fprintf(out_logfile,
-            "   Operation                      Max            Min           Mean        Std Dev\n");
-        fprintf(out_logfile,
-            "   ---------                      ---            ---           ----        -------\n");
-        fflush(out_logfile);
+    MPI_Barrier(ctx->comm);
 
-        /* if files only access, skip entries 0-3 (the dir tests) */
-        if (files_only && !dirs_only) {
-            start = 4;
-        } else {
-            start = 0;
+    /* calculate aggregates */
+    if (ctx->o.barriers) {
+        double local[iterations * tableSize];
+        double maxes[iterations * tableSize];
+
+        /* Because each proc times itself, in the case of barriers we
+         * have to backwards calculate the time to simulate the use
+         * of barriers, i.e., the slowest process of each iteration counts.
+         */
+        for (j = 0; j < iterations; j++) {
+            double * values = ctx->o.print_time ? ctx->summary_table[j].time : ctx->summary_table[j].rate;
+            memcpy(& local[j * tableSize], values, tableSize * sizeof(double));
         }
+        MPI_Reduce(local, maxes, iterations * tableSize, MPI_DOUBLE, MPI_MAX, 0, ctx->comm);
 
-        /* if directories only access, skip entries 4-7 (the file tests) */
-        if (dirs_only && !files_only) {
-            stop = 4;
-        } else {
-            stop = 8;
+        if (ctx->rank == 0) {
+            for (i = 0; i < tableSize; i++) {
+                for (j = 0; j < iterations; j++) {
+                    stat_add(& stats[i], maxes[j * tableSize + i]);
+                }
+            }
         }
+    } else {
+        mdtest_stat_t local[tableSize];
+        MPI_Datatype stat_type;
+        MPI_Op stat_op;
 
-        /* special case: if no directory or file tests, skip all */
-        if (!dirs_only && !files_only) {
-            start = stop = 0;
+        for (i = 0; i < tableSize; i++) {
+            stat_init(& local[i]);
+            for (j = 0; j < iterations; j++) {
+                stat_add(& local[i], ctx->o.print_time ? ctx->summary_table[j].time[i] : ctx->summary_table[j].rate[i]);
+            }
         }
 
-        /* calculate aggregates */
-        if (barriers) {
-            double maxes[iterations];
+        MPI_Type_contiguous(sizeof(mdtest_stat_t) / sizeof(double), MPI_DOUBLE, & stat_type);
+        MPI_Type_commit(& stat_type);
+        MPI_Op_create(stat_reduce_op, 1, & stat_op);
+        MPI_Reduce(local, stats, tableSize, stat_type, stat_op, 0, ctx->comm);
+        MPI_Op_free(& stat_op);
+        MPI_Type_free(& stat_type);
+    }
 
+    if (ctx->rank != 0) {
+        return;
+    }
 
-            /* Because each proc times itself, in the case of barriers we
-             * have to backwards calculate the time to simulate the use
-             * of barriers.
-             */
-            for (i = start; i < stop; i++) {
-                for (j=0; j<iterations; j++) {
-                    maxes[j] = all[j*tableSize + i];
-                    for (k=0; k<size; k++) {
-                        curr = all[(k*tableSize*iterations) + (j*tableSize) + i];
-                        if (maxes[j] < curr) {
-                            maxes[j] = curr;
-                        }
-                    }
-                }
+    fprintf(ctx->out, "\nSUMMARY %s: (of %d iterations)\n", ctx->o.print_time ? "time": "rate", iterations);
+    fprintf(ctx->out,
+        "   Operation                      Max            Min           Mean        Std Dev%s\n",
+        ctx->o.measure_latency ? "    p50 (ms)    p99 (ms)  p99.9 (ms)    max (ms)" : "");
+    fprintf(ctx->out,
+        "   ---------                      ---            ---           ----        -------%s\n",
+        ctx->o.measure_latency ? "    --------    --------  ----------    --------" : "");
 
-                min = max = maxes[0];
-                for (j=0; j<iterations; j++) {
-                    if (min > maxes[j]) {
-                        min = maxes[j];
-                    }
-                    if (max < maxes[j]) {
-                        max = maxes[j];
-                    }
-                    sum += maxes[j];
-                }
-                mean = sum / iterations;
-                for (j=0; j<iterations; j++) {
-                    var += pow((mean - maxes[j]), 2);
-                }
-                var = var / iterations;
-                sd = sqrt(var);
-                switch (i) {
-                case 0: strcpy(access, "Directory creation:"); break;
-                case 1: strcpy(access, "Directory stat    :"); break;
-                    /* case 2: strcpy(access, "Directory read    :"); break; */
-                case 2: ;                                      break; /* N/A */
-                case 3: strcpy(access, "Directory removal :"); break;
-                case 4: strcpy(access, "File creation     :"); break;
-                case 5: strcpy(access, "File stat         :"); break;
-                case 6: strcpy(access, "File read         :"); break;
-                case 7: strcpy(access, "File removal      :"); break;
-                default: strcpy(access, "ERR");                 break;
-                }
-                if (i != 2) {
-                    fprintf(out_logfile, "   %s ", access);
-                    fprintf(out_logfile, "%14.3f ", max);
-                    fprintf(out_logfile, "%14.3f ", min);
-                    fprintf(out_logfile, "%14.3f ", mean);
-                    fprintf(out_logfile, "%14.3f\n", sd);
-                    fflush(out_logfile);
-                }
-                sum = var = 0;
+    for (i = start; i < stop; i++) {
+        /* N/A: directory read */
+        if (i != 2) {
+            summary_print_line(ctx, i, & stats[i]);
+        }
+        /* break a file creation down into its steps */
+        if (i == MDTEST_FILE_CREATE_NUM && ctx->o.measure_latency) {
+            for (j = MDTEST_FILE_CREATE_OPEN_NUM; j <= MDTEST_FILE_CREATE_CLOSE_NUM; j++) {
+                fprintf(ctx->out, "   %s %59s", summary_label(j), "");
+                summary_print_latency(ctx, j);
+            }
+        }
+    }
 
+    if (ctx->o.list_phase && ctx->o.stat_only) {
+        for (i = MDTEST_DIR_LIST_NUM; i <= MDTEST_FILE_LIST_NUM; i++) {
+            if ((i == MDTEST_DIR_LIST_NUM && start > 0) || (i == MDTEST_FILE_LIST_NUM && stop <= 4)) {
+                continue;
             }
+            summary_print_line(ctx, i, & stats[i]);
+        }
+    }
 
-        } else {
-            for (i = start; i < stop; i++) {
-                min = max = all[i];
-                for (k=0; k < size; k++) {
-                    for (j = 0; j < iterations; j++) {
-                        curr = all[(k*tableSize*iterations)
-                                   + (j*tableSize) + i];
-                        if (min > curr) {
-                            min = curr;
-                        }
-                        if (max < curr) {
-                            max =  curr;
-                        }
-                        sum += curr;
-                    }
-                }
-                mean = sum / (iterations * size);
-                for (k=0; k<size; k++) {
-                    for (j = 0; j < iterations; j++) {
-                        var += pow((mean -  all[(k*tableSize*iterations)
-                                                + (j*tableSize) + i]), 2);
-                    }
-                }
-                var = var / (iterations * size);
-                sd = sqrt(var);
-                switch (i) {
-                case 0: strcpy(access, "Directory creation:"); break;
-                case 1: strcpy(access, "Directory stat    :"); break;
-                    /* case 2: strcpy(access, "Directory read    :"); break; */
-                case 2: ;                                      break; /* N/A */
-                case 3: strcpy(access, "Directory removal :"); break;
-                case 4: strcpy(access, "File creation     :"); break;
-                case 5: strcpy(access, "File stat         :"); break;
-                case 6: strcpy(access, "File read         :"); break;
-                case 7: strcpy(access, "File removal      :"); break;
-                default: strcpy(access, "ERR");                 break;
-                }
-                if (i != 2) {
-                    fprintf(out_logfile, "   %s ", access);
-                    fprintf(out_logfile, "%14.3f ", max);
-                    fprintf(out_logfile, "%14.3f ", min);
-                    fprintf(out_logfile, "%14.3f ", mean);
-                    fprintf(out_logfile, "%14.3f\n", sd);
-                    fflush(out_logfile);
-                }
-                sum = var = 0;
+    /* calculate tree create/remove and mixed workload rates, these are computed identically on all processes */
+    for (i = 8; i <= MDTEST_MIXED_REMOVE_NUM; i++) {
+        mdtest_stat_t s;
 
-            }
+        if (i >= MDTEST_MIXED_CREATE_NUM && ! ctx->o.mixed_workload) {
+            break;
+        }
+        stat_init(& s);
+        for (j = 0; j < iterations; j++) {
+            stat_add(& s, ctx->o.print_time ? ctx->summary_table[j].time[i] : ctx->summary_table[j].rate[i]);
         }
+        summary_print_line(ctx, i, & s);
+    }
 
-        /* calculate tree create/remove rates */
-        for (i = 8; i < tableSize; i++) {
-            min = max = all[i];
-            for (j = 0; j < iterations; j++) {
-                if(print_time){
-                  curr = summary_table[j].time[i];
-                }else{
-                  curr = summary_table[j].rate[i];
-                }
+    /* the directory entry size is a property of the file system, report it along with the listing rates */
+    if (ctx->o.list_phase && ctx->o.stat_only) {
+        for (i = MDTEST_DIR_LIST_NUM; i <= MDTEST_FILE_LIST_NUM; i++) {
+            uint64_t entries = 0, bytes = 0;
 
-                if (min > curr) {
-                    min = curr;
-                }
-                if (max < curr) {
-                    max =  curr;
-                }
-                sum += curr;
-            }
-            mean = sum / (iterations);
             for (j = 0; j < iterations; j++) {
-                if(print_time){
-                  curr = summary_table[j].time[i];
-                }else{
-                  curr = summary_table[j].rate[i];
-                }
-
-                var += pow((mean -  curr), 2);
+                entries += ctx->summary_table[j].items[i];
+                bytes += ctx->summary_table[j].bytes[i];
             }
-            var = var / (iterations);
-            sd = sqrt(var);
-            switch (i) {
-            case 8: strcpy(access, "Tree creation     :"); break;
-            case 9: strcpy(access, "Tree removal      :"); break;
-            default: strcpy(access, "ERR");                 break;
+            if (entries > 0) {
+                fprintf(ctx->out, "   %s %14.1f bytes/entry\n", summary_label(i), (double) bytes / entries);
             }
-            fprintf(out_logfile, "   %s ", access);
-            fprintf(out_logfile, "%14.3f ", max);
-            fprintf(out_logfile, "%14.3f ", min);
-            fprintf(out_logfile, "%14.3f ", mean);
-            fprintf(out_logfile, "%14.3f\n", sd);
-            fflush(out_logfile);
-            sum = var = 0;
         }
     }
+    fflush(ctx->out);
 }
 
 /* Checks to see if the test setup is valid.  If it isn't, fail. */
-void valid_tests() {
+void valid_tests(mdtest_ctx_t * ctx) {
 
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering valid_tests...\n" );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering valid_tests...\n" );
+        fflush( ctx->out );
     }
 
     /* if dirs_only and files_only were both left unset, set both now */
-    if (!dirs_only && !files_only) {
-        dirs_only = files_only = 1;
+    if (!ctx->o.dirs_only && !ctx->o.files_only) {
+        ctx->o.dirs_only = ctx->o.files_only = 1;
     }
 
     /* if shared file 'S' access, no directory tests */
-    if (shared_file) {
-        dirs_only = 0;
+    if (ctx->o.shared_file) {
+        ctx->o.dirs_only = 0;
     }
 
     /* check for no barriers with shifting processes for different phases.
@@ -1632,57 +2734,138 @@ void valid_tests() {
        race conditions that may cause errors stat'ing or deleting after
        creates.
     */
-    if (( barriers == 0 ) && ( nstride != 0 ) && ( rank == 0 )) {
+    if (( ctx->o.barriers == 0 ) && ( ctx->o.nstride != 0 ) && ( ctx->rank == 0 )) {
         FAIL( "Possible race conditions will occur: -B not compatible with -N");
     }
 
     /* check for collective_creates incompatibilities */
-    if (shared_file && collective_creates && rank == 0) {
+    if (ctx->o.shared_file && ctx->o.collective_creates && ctx->rank == 0) {
         FAIL("-c not compatible with -S");
     }
-    if (path_count > 1 && collective_creates && rank == 0) {
+    if (ctx->path_count > 1 && ctx->o.collective_creates && ctx->rank == 0) {
         FAIL("-c not compatible with multiple test directories");
     }
-    if (collective_creates && !barriers) {
+    if (ctx->o.list_plus) {
+        ctx->o.list_phase = 1;
+    }
+    if (ctx->o.name_length < 0 ||
+        (ctx->o.name_scheme == MDTEST_NAME_HEX && ctx->o.name_length != 0 && (ctx->o.name_length < 16 || ctx->o.name_length > NAME_MAX - 8)) ||
+        (ctx->o.name_scheme == MDTEST_NAME_LONG && ctx->o.name_length > NAME_MAX) ||
+        (ctx->o.name_scheme == MDTEST_NAME_PREFIX && ctx->o.name_length > NAME_MAX - 48)) {
+        FAIL("nameLength is out of range for the nameScheme");
+    }
+    /* preset the flags of the small-file path once */
+    if (ctx->o.sync_file && ctx->o.sync_mode == MDTEST_SYNC_NONE) {
+        ctx->o.sync_mode = MDTEST_SYNC_FSYNC;
+    }
+    if (ctx->o.direct_io || ctx->o.sync_mode == MDTEST_SYNC_FDATASYNC || ctx->o.sync_mode == MDTEST_SYNC_DSYNC) {
+        ctx->o.small_file = 1;
+    }
+    if (ctx->o.small_file && strcasecmp(ctx->o.backend_name, "POSIX") != 0) {
+        FAIL("smallFile, directIO, syncMode=fdatasync and syncMode=dsync require the POSIX API");
+    }
+    if (ctx->o.io_alignment < 8 || (ctx->o.io_alignment & (ctx->o.io_alignment - 1)) != 0) {
+        FAIL("ioAlignment must be a power of two and at least 8");
+    }
+    if (ctx->o.verify_data && ctx->o.read_bytes > ctx->o.write_bytes) {
+        FAIL("verify needs -e to be at most -w");
+    }
+    ctx->small_create_flags = (ctx->o.collective_creates ? 0 : O_CREAT) | O_WRONLY;
+    ctx->small_open_flags = O_RDONLY;
+#ifdef O_DIRECT
+    if (ctx->o.direct_io) {
+        ctx->small_create_flags |= O_DIRECT;
+        ctx->small_open_flags |= O_DIRECT;
+    }
+#else
+    if (ctx->o.direct_io) {
+        FAIL("directIO is not supported on this platform");
+    }
+#endif
+    if (ctx->o.sync_mode == MDTEST_SYNC_DSYNC) {
+        ctx->small_create_flags |= O_DSYNC;
+    }
+    ctx->write_io_size = ctx->o.direct_io ? (ctx->o.write_bytes + ctx->o.io_alignment - 1) / ctx->o.io_alignment * ctx->o.io_alignment : ctx->o.write_bytes;
+    ctx->read_io_size = ctx->o.direct_io ? (ctx->o.read_bytes + ctx->o.io_alignment - 1) / ctx->o.io_alignment * ctx->o.io_alignment : ctx->o.read_bytes;
+
+    if (ctx->o.rate_series_interval <= 0) {
+        FAIL("rateInterval must be positive");
+    }
+    if (ctx->o.stat_mask == IOR_STATX_DONT_SYNC) {
+        ctx->o.stat_mask |= IOR_STATX_ALL;
+    }
+    if (ctx->o.list_buffer_size > 0 && ctx->o.list_buffer_size < 1024) {
+        FAIL("listBufferSize must be at least 1024 bytes");
+    }
+    if (ctx->o.collective_aggregators < 0) {
+        FAIL("collectiveAggregators must not be negative");
+    }
+    if (ctx->o.collective_creates && !ctx->o.barriers) {
         FAIL("-c not compatible with -B");
     }
 
     /* check for shared file incompatibilities */
-    if (unique_dir_per_task && shared_file && rank == 0) {
+    if (ctx->o.unique_dir_per_task && ctx->o.shared_file && ctx->rank == 0) {
         FAIL("-u not compatible with -S");
     }
 
     /* check multiple directory paths and strided option */
-    if (path_count > 1 && nstride > 0) {
+    if (ctx->path_count > 1 && ctx->o.nstride > 0) {
         FAIL("cannot have multiple directory paths with -N strides between neighbor tasks");
     }
 
     /* check for shared directory and multiple directories incompatibility */
-    if (path_count > 1 && unique_dir_per_task != 1) {
+    if (ctx->path_count > 1 && ctx->o.unique_dir_per_task != 1) {
         FAIL("shared directory mode is not compatible with multiple directory paths");
     }
 
     /* check if more directory paths than ranks */
-    if (path_count > size) {
+    if (ctx->path_count > ctx->size) {
         FAIL("cannot have more directory paths than MPI tasks");
     }
 
     /* check depth */
-    if (depth < 0) {
+    if (ctx->o.depth < 0) {
             FAIL("depth must be greater than or equal to zero");
     }
     /* check branch_factor */
-    if (branch_factor < 1 && depth > 0) {
+    if (ctx->o.branch_factor < 1 && ctx->o.depth > 0) {
             FAIL("branch factor must be greater than or equal to zero");
     }
     /* check for valid number of items */
-    if ((items > 0) && (items_per_dir > 0)) {
+    if ((ctx->o.items > 0) && (ctx->o.items_per_dir > 0)) {
             FAIL("only specify the number of items or the number of items per directory");
     }
 
+    /* check the mixed workload */
+    if (ctx->o.mixed_workload) {
+        int sum = 0;
+        for (int i = 0; i < 4; i++) {
+            if (ctx->o.mixed_ratio[i] < 0 || ctx->o.mixed_ratio[i] > 100) {
+                FAIL("mixedRatio entries must be between 0 and 100");
+            }
+            sum += ctx->o.mixed_ratio[i];
+        }
+        if (sum == 0) {
+            FAIL("mixedRatio must contain at least one operation");
+        }
+        if (ctx->o.mixed_rounds == 0 && ctx->o.stone_wall_timer_seconds == 0) {
+            FAIL("-X requires either -W or the mixedRounds option");
+        }
+        if (ctx->o.mixed_interval <= 0) {
+            FAIL("mixedInterval must be positive");
+        }
+        if (ctx->o.shared_file || ctx->o.collective_creates || ctx->o.nstride != 0) {
+            FAIL("-X not compatible with -S, -c or -N");
+        }
+        /* the mixed workload operates on files only */
+        ctx->o.dirs_only = 0;
+        ctx->o.files_only = 1;
+    }
+
 }
 
-void show_file_system_size(char *file_system) {
+void show_file_system_size(mdtest_ctx_t * ctx, char *file_system) {
     char          file_system_unit_str[MAX_LEN] = "GiB";
     char          inode_unit_str[MAX_LEN]       = "Mi";
     int64_t       file_system_unit_val          = 1024 * 1024 * 1024;
@@ -1697,12 +2880,12 @@ void show_file_system_size(char *file_system) {
     ior_aiori_statfs_t stat_buf;
     int ret;
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering show_file_system_size...\n" );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering show_file_system_size...\n" );
+        fflush( ctx->out );
     }
 
-    ret = backend->statfs (file_system, &stat_buf, &param);
+    ret = ctx->backend->statfs (file_system, &stat_buf, &ctx->param);
     if (0 != ret) {
         FAIL("unable to stat file system");
     }
@@ -1727,32 +2910,32 @@ void show_file_system_size(char *file_system) {
         * 100;
 
     /* show results */
-    fprintf(out_logfile, "FS: %.1f %s   Used FS: %2.1f%%   ",
+    fprintf(ctx->out, "FS: %.1f %s   Used FS: %2.1f%%   ",
             total_file_system_size_hr, file_system_unit_str,
             used_file_system_percentage);
-    fprintf(out_logfile, "Inodes: %.1f %s   Used Inodes: %2.1f%%\n",
+    fprintf(ctx->out, "Inodes: %.1f %s   Used Inodes: %2.1f%%\n",
             (double)total_inodes / (double)inode_unit_val,
             inode_unit_str, used_inode_percentage);
-    fflush(out_logfile);
+    fflush(ctx->out);
 
     return;
 }
 
-void display_freespace(char *testdirpath)
+void display_freespace(mdtest_ctx_t * ctx, char *testdirpath)
 {
     char dirpath[MAX_LEN] = {0};
     int  i;
     int  directoryFound   = 0;
 
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering display_freespace...\n" );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering display_freespace...\n" );
+        fflush( ctx->out );
     }
 
-    if (verbose >= 3 && rank == 0) {
-        fprintf(out_logfile,  "V-3: testdirpath is \"%s\"\n", testdirpath );
-        fflush( out_logfile );
+    if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+        fprintf(ctx->out,  "V-3: testdirpath is \"%s\"\n", testdirpath );
+        fflush( ctx->out );
     }
 
     strcpy(dirpath, testdirpath);
@@ -1772,91 +2955,91 @@ void display_freespace(char *testdirpath)
         strcpy(dirpath, ".");
     }
 
-    if (verbose >= 3 && rank == 0) {
-        fprintf(out_logfile,  "V-3: Before show_file_system_size, dirpath is \"%s\"\n", dirpath );
-        fflush( out_logfile );
+    if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+        fprintf(ctx->out,  "V-3: Before show_file_system_size, dirpath is \"%s\"\n", dirpath );
+        fflush( ctx->out );
     }
 
-    show_file_system_size(dirpath);
+    show_file_system_size(ctx, dirpath);
 
-    if (verbose >= 3 && rank == 0) {
-        fprintf(out_logfile,  "V-3: After show_file_system_size, dirpath is \"%s\"\n", dirpath );
-        fflush( out_logfile );
+    if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+        fprintf(ctx->out,  "V-3: After show_file_system_size, dirpath is \"%s\"\n", dirpath );
+        fflush( ctx->out );
     }
 
     return;
 }
 
-void create_remove_directory_tree(int create,
+void create_remove_directory_tree(mdtest_ctx_t * ctx, int create,
                                   int currDepth, char* path, int dirNum, rank_progress_t * progress) {
 
     unsigned i;
     char dir[MAX_LEN];
 
 
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf( out_logfile, "V-1: Entering create_remove_directory_tree, currDepth = %d...\n", currDepth );
-        fflush( out_logfile );
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering create_remove_directory_tree, currDepth = %d...\n", currDepth );
+        fflush( ctx->out );
     }
 
     if (currDepth == 0) {
-        sprintf(dir, "%s/%s.%d/", path, base_tree_name, dirNum);
+        sprintf(dir, "%s/%s.%d/", path, ctx->base_tree_name, dirNum);
 
         if (create) {
-            if (rank == 0 && verbose >= 2) {
-                fprintf(out_logfile, "V-2: Making directory \"%s\"\n", dir);
-                fflush(out_logfile);
+            if (ctx->rank == 0 && ctx->o.verbose >= 2) {
+                fprintf(ctx->out, "V-2: Making directory \"%s\"\n", dir);
+                fflush(ctx->out);
             }
 
-            if (-1 == backend->mkdir (dir, DIRMODE, &param)) {
+            if (-1 == ctx->backend->mkdir (dir, DIRMODE, &ctx->param)) {
                 //FAIL("Unable to create directory");
             }
         }
 
-        create_remove_directory_tree(create, ++currDepth, dir, ++dirNum, progress);
+        create_remove_directory_tree(ctx, create, ++currDepth, dir, ++dirNum, progress);
 
         if (!create) {
-            if (rank == 0 && verbose >= 2) {
-                fprintf(out_logfile, "V-2: Remove directory \"%s\"\n", dir);
-                fflush(out_logfile);
+            if (ctx->rank == 0 && ctx->o.verbose >= 2) {
+                fprintf(ctx->out, "V-2: Remove directory \"%s\"\n", dir);
+                fflush(ctx->out);
             }
 
-            if (-1 == backend->rmdir(dir, &param)) {
+            if (-1 == ctx->backend->rmdir(dir, &ctx->param)) {
                 FAIL("Unable to remove directory");
             }
         }
-    } else if (currDepth <= depth) {
+    } else if (currDepth <= ctx->o.depth) {
 
         char temp_path[MAX_LEN];
         strcpy(temp_path, path);
         int currDir = dirNum;
 
-        for (i=0; i<branch_factor; i++) {
-            sprintf(dir, "%s.%d/", base_tree_name, currDir);
+        for (i=0; i<ctx->o.branch_factor; i++) {
+            sprintf(dir, "%s.%d/", ctx->base_tree_name, currDir);
             strcat(temp_path, dir);
 
             if (create) {
-                if (rank == 0 && verbose >= 2) {
-                    fprintf(out_logfile, "V-2: Making directory \"%s\"\n", temp_path);
-                    fflush(out_logfile);
+                if (ctx->rank == 0 && ctx->o.verbose >= 2) {
+                    fprintf(ctx->out, "V-2: Making directory \"%s\"\n", temp_path);
+                    fflush(ctx->out);
                 }
 
-                if (-1 == backend->mkdir(temp_path, DIRMODE, &param)) {
+                if (-1 == ctx->backend->mkdir(temp_path, DIRMODE, &ctx->param)) {
                     FAIL("Unable to create directory");
                 }
             }
 
-            create_remove_directory_tree(create, ++currDepth,
-                                         temp_path, (branch_factor*currDir)+1, progress);
+            create_remove_directory_tree(ctx, create, ++currDepth,
+                                         temp_path, (ctx->o.branch_factor*currDir)+1, progress);
             currDepth--;
 
             if (!create) {
-                if (rank == 0 && verbose >= 2) {
-                    fprintf(out_logfile, "V-2: Remove directory \"%s\"\n", temp_path);
-                    fflush(out_logfile);
+                if (ctx->rank == 0 && ctx->o.verbose >= 2) {
+                    fprintf(ctx->out, "V-2: Remove directory \"%s\"\n", temp_path);
+                    fflush(ctx->out);
                 }
 
-                if (-1 == backend->rmdir(temp_path, &param)) {
+                if (-1 == ctx->backend->rmdir(temp_path, &ctx->param)) {
                     FAIL("Unable to remove directory");
                 }
             }
@@ -1867,348 +3050,422 @@ void create_remove_directory_tree(int create,
     }
 }
 
-static void mdtest_iteration(int i, int j, MPI_Group testgroup, mdtest_results_t * summary_table, rank_progress_t * progress){
+/* construct the path of the directory with the given number in the shared tree */
+static void tree_node_path(mdtest_ctx_t * ctx, const char *path, uint64_t node, char *out) {
+    char dir[MAX_LEN];
+
+    if (node == 0) {
+        sprintf(out, "%s/%s.0/", path, ctx->base_tree_name);
+        return;
+    }
+    tree_node_path(ctx, path, (node - 1) / ctx->o.branch_factor, out);
+    sprintf(dir, "%s."LLU"/", ctx->base_tree_name, node);
+    strcat(out, dir);
+}
+
+/*
+ * Create or remove the shared directory tree with all processes.  The upper
+ * levels are processed level by level with a barrier between levels until a
+ * level has at least as many directories as there are processes; the
+ * subtrees rooted at that level are then distributed round-robin and
+ * processed by their owner without further synchronization.
+ */
+void create_remove_directory_tree_parallel(mdtest_ctx_t * ctx, int create, char *path, rank_progress_t * progress) {
+    char node_path[MAX_LEN];
+    uint64_t level_first = 0, level_count = 1;
+    int split_level = 0;
+
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf( ctx->out, "V-1: Entering create_remove_directory_tree_parallel...\n" );
+        fflush( ctx->out );
+    }
+
+    /* determine the level at which subtrees are handed out */
+    while (split_level < ctx->o.depth && level_count < (uint64_t) ctx->size) {
+        level_first += level_count;
+        level_count *= ctx->o.branch_factor;
+        split_level++;
+    }
+
+    if (create) {
+        uint64_t first = 0, count = 1;
+
+        for (int level = 0; level < split_level; level++) {
+            for (uint64_t node = first + ctx->rank; node < first + count; node += ctx->size) {
+                tree_node_path(ctx, path, node, node_path);
+                if (ctx->o.verbose >= 2) {
+                    fprintf(ctx->out, "V-2: Making directory \"%s\"\n", node_path);
+                    fflush(ctx->out);
+                }
+                if (-1 == ctx->backend->mkdir (node_path, DIRMODE, &ctx->param) && node != 0) {
+                    FAIL("Unable to create directory");
+                }
+            }
+            MPI_Barrier(ctx->comm);
+            first += count;
+            count *= ctx->o.branch_factor;
+        }
+    }
+
+    for (uint64_t node = level_first + ctx->rank; node < level_first + level_count; node += ctx->size) {
+        tree_node_path(ctx, path, node, node_path);
+        if (create) {
+            if (ctx->o.verbose >= 2) {
+                fprintf(ctx->out, "V-2: Making directory \"%s\"\n", node_path);
+                fflush(ctx->out);
+            }
+            if (-1 == ctx->backend->mkdir (node_path, DIRMODE, &ctx->param) && node != 0) {
+                FAIL("Unable to create directory");
+            }
+        }
+        if (split_level < ctx->o.depth) {
+            create_remove_directory_tree(ctx, create, split_level + 1, node_path, ctx->o.branch_factor * node + 1, progress);
+        }
+        if (!create) {
+            if (ctx->o.verbose >= 2) {
+                fprintf(ctx->out, "V-2: Remove directory \"%s\"\n", node_path);
+                fflush(ctx->out);
+            }
+            if (-1 == ctx->backend->rmdir(node_path, &ctx->param)) {
+                FAIL("Unable to remove directory");
+            }
+        }
+    }
+
+    if (!create) {
+        for (int level = split_level - 1; level >= 0; level--) {
+            level_count /= ctx->o.branch_factor;
+            level_first -= level_count;
+            MPI_Barrier(ctx->comm);
+            for (uint64_t node = level_first + ctx->rank; node < level_first + level_count; node += ctx->size) {
+                tree_node_path(ctx, path, node, node_path);
+                if (ctx->o.verbose >= 2) {
+                    fprintf(ctx->out, "V-2: Remove directory \"%s\"\n", node_path);
+                    fflush(ctx->out);
+                }
+                if (-1 == ctx->backend->rmdir(node_path, &ctx->param)) {
+                    FAIL("Unable to remove directory");
+                }
+            }
+        }
+    }
+}
+
+static void mdtest_iteration(mdtest_ctx_t * ctx, int i, int j, MPI_Group testgroup, mdtest_results_t * summary_table, rank_progress_t * progress){
   /* start and end times of directory tree create/remove */
   double startCreate, endCreate;
+  uint64_t tree_dirs;
   int k, c;
 
-  if (rank == 0 && verbose >= 1) {
-      fprintf(out_logfile, "V-1: main: * iteration %d *\n", j+1);
-      fflush(out_logfile);
+  if (ctx->rank == 0 && ctx->o.verbose >= 1) {
+      fprintf(ctx->out, "V-1: main: * iteration %d *\n", j+1);
+      fflush(ctx->out);
   }
 
-  int pos = sprintf(testdir, "%s", testdirpath);
-  if ( testdir[strlen( testdir ) - 1] != '/' ) {
-      pos += sprintf(& testdir[pos], "/");
+  int pos = sprintf(ctx->testdir, "%s", ctx->testdirpath);
+  if ( ctx->testdir[strlen( ctx->testdir ) - 1] != '/' ) {
+      pos += sprintf(& ctx->testdir[pos], "/");
   }
-  pos += sprintf(& testdir[pos], "%s", TEST_DIR);
-  pos += sprintf(& testdir[pos], ".%d", j);
+  pos += sprintf(& ctx->testdir[pos], "%s", TEST_DIR);
+  pos += sprintf(& ctx->testdir[pos], ".%d", j);
 
-  if (verbose >= 2 && rank == 0) {
-      fprintf(out_logfile,  "V-2: main (for j loop): making testdir, \"%s\"\n", testdir );
-      fflush( out_logfile );
+  if (ctx->o.verbose >= 2 && ctx->rank == 0) {
+      fprintf(ctx->out,  "V-2: main (for j loop): making testdir, \"%s\"\n", ctx->testdir );
+      fflush( ctx->out );
   }
-  if ((rank < path_count) && backend->access(testdir, F_OK, &param) != 0) {
-      if (backend->mkdir(testdir, DIRMODE, &param) != 0) {
+  if ((ctx->rank < ctx->path_count) && ctx->backend->access(ctx->testdir, F_OK, &ctx->param) != 0) {
+      if (ctx->backend->mkdir(ctx->testdir, DIRMODE, &ctx->param) != 0) {
           FAIL("Unable to create test directory");
       }
   }
 
   /* create hierarchical directory structure */
-  MPI_Barrier(testComm);
-  if (create_only) {
+  MPI_Barrier(ctx->comm);
+  if (ctx->o.create_only) {
       startCreate = MPI_Wtime();
-      if (unique_dir_per_task) {
-          if (collective_creates && (rank == 0)) {
-              /*
-               * This is inside two loops, one of which already uses "i" and the other uses "j".
-               * I don't know how this ever worked. I'm changing this loop to use "k".
-               */
-              for (k=0; k<size; k++) {
-                  sprintf(base_tree_name, "mdtest_tree.%d", k);
-
-                  if (verbose >= 3 && rank == 0) {
-                      fprintf(out_logfile,
+      if (ctx->o.unique_dir_per_task) {
+          if (ctx->o.collective_creates && ctx->is_aggregator) {
+              /* the aggregator builds the trees of all processes of its group */
+              for (k=0; k<ctx->aggregator_owner_count; k++) {
+                  sprintf(ctx->base_tree_name, "mdtest_tree.%d", ctx->aggregator_owners[k]);
+
+                  if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+                      fprintf(ctx->out,
                           "V-3: main (create hierarchical directory loop-collective): Calling create_remove_directory_tree with \"%s\"\n",
-                          testdir );
-                      fflush( out_logfile );
+                          ctx->testdir );
+                      fflush( ctx->out );
                   }
 
                   /*
                    * Let's pass in the path to the directory we most recently made so that we can use
                    * full paths in the other calls.
                    */
-                  create_remove_directory_tree(1, 0, testdir, 0, progress);
+                  create_remove_directory_tree(ctx, 1, 0, ctx->testdir, 0, progress);
                   if(CHECK_STONE_WALL(progress)){
-                    size = k;
                     break;
                   }
               }
-          } else if (!collective_creates) {
-              if (verbose >= 3 && rank == 0) {
-                  fprintf(out_logfile,
+              sprintf(ctx->base_tree_name, "mdtest_tree.%d", ctx->rank);
+          } else if (!ctx->o.collective_creates) {
+              if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+                  fprintf(ctx->out,
                       "V-3: main (create hierarchical directory loop-!collective_creates): Calling create_remove_directory_tree with \"%s\"\n",
-                      testdir );
-                  fflush( out_logfile );
+                      ctx->testdir );
+                  fflush( ctx->out );
               }
 
               /*
                * Let's pass in the path to the directory we most recently made so that we can use
                * full paths in the other calls.
                */
-              create_remove_directory_tree(1, 0, testdir, 0, progress);
+              create_remove_directory_tree(ctx, 1, 0, ctx->testdir, 0, progress);
           }
       } else {
-          if (rank == 0) {
-              if (verbose >= 3 && rank == 0) {
-                  fprintf(out_logfile,
-                      "V-3: main (create hierarchical directory loop-!unque_dir_per_task): Calling create_remove_directory_tree with \"%s\"\n",
-                      testdir );
-                  fflush( out_logfile );
-              }
-
-              /*
-               * Let's pass in the path to the directory we most recently made so that we can use
-               * full paths in the other calls.
-               */
-              create_remove_directory_tree(1, 0 , testdir, 0, progress);
+          if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+              fprintf(ctx->out,
+                  "V-3: main (create hierarchical directory loop-!unique_dir_per_task): Calling create_remove_directory_tree_parallel with \"%s\"\n",
+                  ctx->testdir );
+              fflush( ctx->out );
           }
+
+          /* all processes work on the shared tree */
+          create_remove_directory_tree_parallel(ctx, 1, ctx->testdir, progress);
       }
-      MPI_Barrier(testComm);
+      MPI_Barrier(ctx->comm);
       endCreate = MPI_Wtime();
-      summary_table->rate[8] =
-          num_dirs_in_tree / (endCreate - startCreate);
-      summary_table->time[8] = (endCreate - startCreate);
-      summary_table->items[8] = num_dirs_in_tree;
-      summary_table->stonewall_last_item[8] = num_dirs_in_tree;
-      if (verbose >= 1 && rank == 0) {
-          fprintf(out_logfile, "V-1: main:   Tree creation     : %14.3f sec, %14.3f ops/sec\n",
-                 (endCreate - startCreate), summary_table->rate[8]);
-          fflush(out_logfile);
+      /* with unique directories every process has its own tree */
+      tree_dirs = ctx->o.unique_dir_per_task ? ctx->num_dirs_in_tree * ctx->size : ctx->num_dirs_in_tree;
+      summary_table->rate[MDTEST_TREE_CREATE_NUM] = tree_dirs / (endCreate - startCreate);
+      summary_table->time[MDTEST_TREE_CREATE_NUM] = (endCreate - startCreate);
+      summary_table->items[MDTEST_TREE_CREATE_NUM] = tree_dirs;
+      summary_table->stonewall_last_item[MDTEST_TREE_CREATE_NUM] = tree_dirs;
+      if (ctx->o.verbose >= 1 && ctx->rank == 0) {
+          fprintf(ctx->out, "V-1: main:   Tree creation     : %14.3f sec, %14.3f ops/sec\n",
+                 (endCreate - startCreate), summary_table->rate[MDTEST_TREE_CREATE_NUM]);
+          fflush(ctx->out);
       }
   }
-  sprintf(unique_mk_dir, "%s/%s.0", testdir, base_tree_name);
-  sprintf(unique_chdir_dir, "%s/%s.0", testdir, base_tree_name);
-  sprintf(unique_stat_dir, "%s/%s.0", testdir, base_tree_name);
-  sprintf(unique_read_dir, "%s/%s.0", testdir, base_tree_name);
-  sprintf(unique_rm_dir, "%s/%s.0", testdir, base_tree_name);
-  sprintf(unique_rm_uni_dir, "%s", testdir);
-
-  if (!unique_dir_per_task) {
-      if (verbose >= 3 && rank == 0) {
-          fprintf(out_logfile,  "V-3: main: Using unique_mk_dir, \"%s\"\n", unique_mk_dir );
-          fflush( out_logfile );
+  sprintf(ctx->unique_mk_dir, "%s/%s.0", ctx->testdir, ctx->base_tree_name);
+  sprintf(ctx->unique_chdir_dir, "%s/%s.0", ctx->testdir, ctx->base_tree_name);
+  sprintf(ctx->unique_stat_dir, "%s/%s.0", ctx->testdir, ctx->base_tree_name);
+  sprintf(ctx->unique_read_dir, "%s/%s.0", ctx->testdir, ctx->base_tree_name);
+  sprintf(ctx->unique_rm_dir, "%s/%s.0", ctx->testdir, ctx->base_tree_name);
+  sprintf(ctx->unique_rm_uni_dir, "%s", ctx->testdir);
+
+  if (!ctx->o.unique_dir_per_task) {
+      if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+          fprintf(ctx->out,  "V-3: main: Using unique_mk_dir, \"%s\"\n", ctx->unique_mk_dir );
+          fflush( ctx->out );
       }
   }
 
-  if (rank < i) {
-      if (!shared_file) {
-          sprintf(mk_name, "mdtest.%d.", (rank+(0*nstride))%i);
-          sprintf(stat_name, "mdtest.%d.", (rank+(1*nstride))%i);
-          sprintf(read_name, "mdtest.%d.", (rank+(2*nstride))%i);
-          sprintf(rm_name, "mdtest.%d.", (rank+(3*nstride))%i);
+  if (ctx->rank < i) {
+      if (!ctx->o.shared_file) {
+          sprintf(ctx->mk_name, "mdtest.%d.", (ctx->rank+(0*ctx->o.nstride))%i);
+          sprintf(ctx->stat_name, "mdtest.%d.", (ctx->rank+(1*ctx->o.nstride))%i);
+          sprintf(ctx->read_name, "mdtest.%d.", (ctx->rank+(2*ctx->o.nstride))%i);
+          sprintf(ctx->rm_name, "mdtest.%d.", (ctx->rank+(3*ctx->o.nstride))%i);
       }
-      if (unique_dir_per_task) {
-          sprintf(unique_mk_dir, "%s/mdtest_tree.%d.0", testdir,
-                  (rank+(0*nstride))%i);
-          sprintf(unique_chdir_dir, "%s/mdtest_tree.%d.0", testdir,
-                  (rank+(1*nstride))%i);
-          sprintf(unique_stat_dir, "%s/mdtest_tree.%d.0", testdir,
-                  (rank+(2*nstride))%i);
-          sprintf(unique_read_dir, "%s/mdtest_tree.%d.0", testdir,
-                  (rank+(3*nstride))%i);
-          sprintf(unique_rm_dir, "%s/mdtest_tree.%d.0", testdir,
-                  (rank+(4*nstride))%i);
-          sprintf(unique_rm_uni_dir, "%s", testdir);
+      if (ctx->o.unique_dir_per_task) {
+          sprintf(ctx->unique_mk_dir, "%s/mdtest_tree.%d.0", ctx->testdir,
+                  (ctx->rank+(0*ctx->o.nstride))%i);
+          sprintf(ctx->unique_chdir_dir, "%s/mdtest_tree.%d.0", ctx->testdir,
+                  (ctx->rank+(1*ctx->o.nstride))%i);
+          sprintf(ctx->unique_stat_dir, "%s/mdtest_tree.%d.0", ctx->testdir,
+                  (ctx->rank+(2*ctx->o.nstride))%i);
+          sprintf(ctx->unique_read_dir, "%s/mdtest_tree.%d.0", ctx->testdir,
+                  (ctx->rank+(3*ctx->o.nstride))%i);
+          sprintf(ctx->unique_rm_dir, "%s/mdtest_tree.%d.0", ctx->testdir,
+                  (ctx->rank+(4*ctx->o.nstride))%i);
+          sprintf(ctx->unique_rm_uni_dir, "%s", ctx->testdir);
       }
-      strcpy(top_dir, unique_mk_dir);
+      strcpy(ctx->top_dir, ctx->unique_mk_dir);
 
-      if (verbose >= 3 && rank == 0) {
-          fprintf(out_logfile,  "V-3: main: Copied unique_mk_dir, \"%s\", to topdir\n", unique_mk_dir );
-          fflush( out_logfile );
+      if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+          fprintf(ctx->out,  "V-3: main: Copied unique_mk_dir, \"%s\", to topdir\n", ctx->unique_mk_dir );
+          fflush( ctx->out );
       }
 
-      if (dirs_only && !shared_file) {
-          if (pre_delay) {
-              delay_secs(pre_delay);
+      if (ctx->o.mixed_workload) {
+          if (ctx->o.pre_delay) {
+              delay_secs(ctx, ctx->o.pre_delay);
+          }
+          mixed_test(ctx, j, ctx->unique_mk_dir, progress);
+      } else if (ctx->o.dirs_only && !ctx->o.shared_file) {
+          if (ctx->o.pre_delay) {
+              delay_secs(ctx, ctx->o.pre_delay);
           }
-          directory_test(j, i, unique_mk_dir, progress);
+          directory_test(ctx, j, i, ctx->unique_mk_dir, progress);
       }
-      if (files_only) {
-          if (pre_delay) {
-              delay_secs(pre_delay);
+      if (ctx->o.files_only && !ctx->o.mixed_workload) {
+          if (ctx->o.pre_delay) {
+              delay_secs(ctx, ctx->o.pre_delay);
           }
-          file_test(j, i, unique_mk_dir, progress);
+          file_test(ctx, j, i, ctx->unique_mk_dir, progress);
       }
   }
 
   /* remove directory structure */
-  if (!unique_dir_per_task) {
-      if (verbose >= 3 && rank == 0) {
-          fprintf(out_logfile,  "V-3: main: Using testdir, \"%s\"\n", testdir );
-          fflush( out_logfile );
+  if (!ctx->o.unique_dir_per_task) {
+      if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+          fprintf(ctx->out,  "V-3: main: Using testdir, \"%s\"\n", ctx->testdir );
+          fflush( ctx->out );
       }
   }
 
-  MPI_Barrier(testComm);
+  MPI_Barrier(ctx->comm);
   if(CHECK_STONE_WALL(progress)){
     return;
   }
-  if (remove_only) {
+  if (ctx->o.remove_only) {
       startCreate = MPI_Wtime();
-      if (unique_dir_per_task) {
-          if (collective_creates && (rank == 0)) {
-              /*
-               * This is inside two loops, one of which already uses "i" and the other uses "j".
-               * I don't know how this ever worked. I'm changing this loop to use "k".
-               */
-              for (k=0; k<size; k++) {
-                  sprintf(base_tree_name, "mdtest_tree.%d", k);
-
-                  if (verbose >= 3 && rank == 0) {
-                      fprintf(out_logfile,
+      if (ctx->o.unique_dir_per_task) {
+          if (ctx->o.collective_creates && ctx->is_aggregator) {
+              /* the aggregator builds the trees of all processes of its group */
+              for (k=0; k<ctx->aggregator_owner_count; k++) {
+                  sprintf(ctx->base_tree_name, "mdtest_tree.%d", ctx->aggregator_owners[k]);
+
+                  if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+                      fprintf(ctx->out,
                           "V-3: main (remove hierarchical directory loop-collective): Calling create_remove_directory_tree with \"%s\"\n",
-                          testdir );
-                      fflush( out_logfile );
+                          ctx->testdir );
+                      fflush( ctx->out );
                   }
 
                   /*
                    * Let's pass in the path to the directory we most recently made so that we can use
                    * full paths in the other calls.
                    */
-                  create_remove_directory_tree(0, 0, testdir, 0, progress);
+                  create_remove_directory_tree(ctx, 0, 0, ctx->testdir, 0, progress);
                   if(CHECK_STONE_WALL(progress)){
-                    size = k;
                     break;
                   }
               }
-          } else if (!collective_creates) {
-              if (verbose >= 3 && rank == 0) {
-                  fprintf(out_logfile,
+              sprintf(ctx->base_tree_name, "mdtest_tree.%d", ctx->rank);
+          } else if (!ctx->o.collective_creates) {
+              if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+                  fprintf(ctx->out,
                       "V-3: main (remove hierarchical directory loop-!collective): Calling create_remove_directory_tree with \"%s\"\n",
-                      testdir );
-                  fflush( out_logfile );
+                      ctx->testdir );
+                  fflush( ctx->out );
               }
 
               /*
                * Let's pass in the path to the directory we most recently made so that we can use
                * full paths in the other calls.
                */
-              create_remove_directory_tree(0, 0, testdir, 0, progress);
+              create_remove_directory_tree(ctx, 0, 0, ctx->testdir, 0, progress);
           }
       } else {
-          if (rank == 0) {
-              if (verbose >= 3 && rank == 0) {
-                  fprintf(out_logfile,
-                      "V-3: main (remove hierarchical directory loop-!unique_dir_per_task): Calling create_remove_directory_tree with \"%s\"\n",
-                      testdir );
-                  fflush( out_logfile );
-              }
-
-              /*
-               * Let's pass in the path to the directory we most recently made so that we can use
-               * full paths in the other calls.
-               */
-              create_remove_directory_tree(0, 0 , testdir, 0, progress);
+          if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+              fprintf(ctx->out,
+                  "V-3: main (remove hierarchical directory loop-!unique_dir_per_task): Calling create_remove_directory_tree_parallel with \"%s\"\n",
+                  ctx->testdir );
+              fflush( ctx->out );
           }
+
+          /* all processes work on the shared tree */
+          create_remove_directory_tree_parallel(ctx, 0, ctx->testdir, progress);
       }
 
-      MPI_Barrier(testComm);
+      MPI_Barrier(ctx->comm);
       endCreate = MPI_Wtime();
-      summary_table->rate[9] = num_dirs_in_tree / (endCreate - startCreate);
-      summary_table->time[9] = endCreate - startCreate;
-      summary_table->items[9] = num_dirs_in_tree;
-      summary_table->stonewall_last_item[8] = num_dirs_in_tree;
-      if (verbose >= 1 && rank == 0) {
-          fprintf(out_logfile, "V-1: main   Tree removal      : %14.3f sec, %14.3f ops/sec\n",
-                 (endCreate - startCreate), summary_table->rate[9]);
-          fflush(out_logfile);
+      tree_dirs = ctx->o.unique_dir_per_task ? ctx->num_dirs_in_tree * ctx->size : ctx->num_dirs_in_tree;
+      summary_table->rate[MDTEST_TREE_REMOVE_NUM] = tree_dirs / (endCreate - startCreate);
+      summary_table->time[MDTEST_TREE_REMOVE_NUM] = endCreate - startCreate;
+      summary_table->items[MDTEST_TREE_REMOVE_NUM] = tree_dirs;
+      summary_table->stonewall_last_item[MDTEST_TREE_REMOVE_NUM] = tree_dirs;
+      if (ctx->o.verbose >= 1 && ctx->rank == 0) {
+          fprintf(ctx->out, "V-1: main   Tree removal      : %14.3f sec, %14.3f ops/sec\n",
+                 (endCreate - startCreate), summary_table->rate[MDTEST_TREE_REMOVE_NUM]);
+          fflush(ctx->out);
       }
 
-      if (( rank == 0 ) && ( verbose >=2 )) {
-          fprintf( out_logfile, "V-2: main (at end of for j loop): Removing testdir of \"%s\"\n", testdir );
-          fflush( out_logfile );
+      if (( ctx->rank == 0 ) && ( ctx->o.verbose >=2 )) {
+          fprintf( ctx->out, "V-2: main (at end of for j loop): Removing testdir of \"%s\"\n", ctx->testdir );
+          fflush( ctx->out );
       }
 
-      if ((rank < path_count) && backend->access(testdir, F_OK, &param) == 0) {
+      if ((ctx->rank < ctx->path_count) && ctx->backend->access(ctx->testdir, F_OK, &ctx->param) == 0) {
           //if (( rank == 0 ) && access(testdir, F_OK) == 0) {
-          if (backend->rmdir(testdir, &param) == -1) {
+          if (ctx->backend->rmdir(ctx->testdir, &ctx->param) == -1) {
               FAIL("unable to remove directory");
           }
       }
   } else {
-      summary_table->rate[9] = 0;
+      summary_table->rate[MDTEST_TREE_REMOVE_NUM] = 0;
   }
 }
 
-void mdtest_init_args(){
-   barriers = 1;
-   branch_factor = 1;
-   throttle = 1;
-   create_only = 0;
-   stat_only = 0;
-   read_only = 0;
-   remove_only = 0;
-   leaf_only = 0;
-   depth = 0;
-   num_dirs_in_tree = 0;
-   items_per_dir = 0;
-   random_seed = 0;
-   print_time = 0;
-   shared_file = 0;
-   files_only = 0;
-   dirs_only = 0;
-   pre_delay = 0;
-   unique_dir_per_task = 0;
-   time_unique_dir_overhead = 0;
-   items = 0;
-   collective_creates = 0;
-   write_bytes = 0;
-   stone_wall_timer_seconds = 0;
-   read_bytes = 0;
-   sync_file = 0;
-   path_count = 0;
-   nstride = 0;
+void mdtest_init_options(mdtest_options_t * o) {
+   memset(o, 0, sizeof(*o));
+   /* just use the POSIX backend for now */
+   o->backend_name = "POSIX";
+   o->first = 1;
+   o->last = 0;
+   o->stride = 1;
+   o->iterations = 1;
+   o->barriers = 1;
+   o->branch_factor = 1;
+   o->throttle = 1;
+   o->create_only = 0;
+   o->stat_only = 0;
+   o->read_only = 0;
+   o->remove_only = 0;
+   o->leaf_only = 0;
+   o->depth = 0;
+   o->items_per_dir = 0;
+   o->random_seed = 0;
+   o->print_time = 0;
+   o->shared_file = 0;
+   o->files_only = 0;
+   o->dirs_only = 0;
+   o->pre_delay = 0;
+   o->unique_dir_per_task = 0;
+   o->time_unique_dir_overhead = 0;
+   o->items = 0;
+   o->collective_creates = 0;
+   o->collective_aggregators = 0;
+   o->list_phase = 0;
+   o->list_plus = 0;
+   o->list_buffer_size = 0;
+   o->stat_mask = 0;
+   o->measure_latency = 0;
+   o->name_scheme = MDTEST_NAME_SEQUENTIAL;
+   o->name_length = 0;
+   o->small_file = 0;
+   o->direct_io = 0;
+   o->sync_mode = MDTEST_SYNC_NONE;
+   o->verify_data = 0;
+   o->io_alignment = 4096;
+   o->rate_series_prefix = NULL;
+   o->rate_series_interval = 1.0;
+   o->write_bytes = 0;
+   o->stone_wall_timer_seconds = 0;
+   o->read_bytes = 0;
+   o->sync_file = 0;
+   o->nstride = 0;
+   o->mixed_workload = 0;
+   o->mixed_working_set = 0;
+   o->mixed_ratio[0] = o->mixed_ratio[1] = o->mixed_ratio[2] = o->mixed_ratio[3] = 1;
+   o->mixed_rounds = 0;
+   o->mixed_interval = 1.0;
 }
 
-mdtest_results_t * mdtest_run(int argc, char **argv, MPI_Comm world_com, FILE * world_out) {
-    testComm = world_com;
-    out_logfile = world_out;
-    mpi_comm_world = world_com;
-
-    init_clock();
-
-    mdtest_init_args();
-    int i, j, k;
-    int nodeCount;
-    MPI_Group worldgroup, testgroup;
-    struct {
-        int first;
-        int last;
-        int stride;
-    } range = {0, 0, 1};
-    int first = 1;
-    int last = 0;
-    int stride = 1;
-    int iterations = 1;
+/* set the options given as command line arguments, errors abort the processes of com */
+void mdtest_parse_options(mdtest_options_t * o, int argc, char **argv, MPI_Comm com, FILE * out) {
+    option_t *optList, *thisOpt;
+    int i;
 
     /* Check for -h parameter before MPI_Init so the mdtest binary can be
        called directly, without, for instance, mpirun. */
     for (i = 1; i < argc; i++) {
         if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
-            print_help();
-        }
-    }
-
-    MPI_Comm_rank(testComm, &rank);
-    MPI_Comm_size(testComm, &size);
-
-    pid = getpid();
-    uid = getuid();
-
-    nodeCount = size / count_tasks_per_node();
-
-    if (rank == 0) {
-        fprintf(out_logfile, "-- started at %s --\n\n", print_timestamp());
-        fprintf(out_logfile, "mdtest-%s was launched with %d total task(s) on %d node(s)\n",
-               RELEASE_VERS, size, nodeCount);
-        fflush(out_logfile);
-    }
-
-    if (rank == 0) {
-        fprintf(out_logfile, "Command line used: %s", argv[0]);
-        for (i = 1; i < argc; i++) {
-            fprintf(out_logfile, " \"%s\"", argv[i]);
+            print_help(out);
         }
-        fprintf(out_logfile, "\n");
-        fflush(out_logfile);
     }
 
-    /* Parse command line options */
-
-    verbose = 0;
-    option_t *optList, *thisOpt;
-    optList = GetOptList(argc, argv, "a:b:BcCd:De:Ef:Fhi:I:l:Ln:N:p:rR::s:StTuvV:w:W:yz:Z");
+    optList = GetOptList(argc, argv, "a:b:BcCd:De:Ef:Fhi:I:l:Ln:N:O:p:rR::s:StTuvV:w:W:Xyz:Z");
 
 
     while (optList != NULL) {
@@ -2217,180 +3474,267 @@ mdtest_results_t * mdtest_run(int argc, char **argv, MPI_Comm world_com, FILE *
         optList = optList->next;
         switch (thisOpt->option) {
         case 'a':
-            backend_name = optarg; break;
+            o->backend_name = optarg; break;
         case 'b':
-            branch_factor = atoi(optarg); break;
+            o->branch_factor = atoi(optarg); break;
         case 'B':
-            barriers = 0;                 break;
+            o->barriers = 0;                 break;
         case 'c':
-            collective_creates = 1;       break;
+            o->collective_creates = 1;       break;
         case 'C':
-            create_only = 1;              break;
+            o->create_only = 1;              break;
         case 'd':
-            parse_dirpath(optarg);        break;
+            o->dirpath = optarg;         break;
         case 'D':
-            dirs_only = 1;                break;
+            o->dirs_only = 1;                break;
         case 'e':
-            read_bytes = ( size_t )strtoul( optarg, ( char ** )NULL, 10 );   break;
+            o->read_bytes = ( size_t )strtoul( optarg, ( char ** )NULL, 10 );   break;
             //read_bytes = atoi(optarg);    break;
         case 'E':
-            read_only = 1;                break;
+            o->read_only = 1;                break;
         case 'f':
-            first = atoi(optarg);         break;
+            o->first = atoi(optarg);         break;
         case 'F':
-            files_only = 1;               break;
+            o->files_only = 1;               break;
         case 'h':
-            print_help();                 break;
+            print_help(out);              break;
         case 'i':
-            iterations = atoi(optarg);    break;
+            o->iterations = atoi(optarg);    break;
         case 'I':
-            items_per_dir = (uint64_t) strtoul( optarg, ( char ** )NULL, 10 );   break;
+            o->items_per_dir = (uint64_t) strtoul( optarg, ( char ** )NULL, 10 );   break;
             //items_per_dir = atoi(optarg); break;
         case 'l':
-            last = atoi(optarg);          break;
+            o->last = atoi(optarg);          break;
         case 'L':
-            leaf_only = 1;                break;
+            o->leaf_only = 1;                break;
         case 'n':
-            items = (uint64_t) strtoul( optarg, ( char ** )NULL, 10 );   break;
+            o->items = (uint64_t) strtoul( optarg, ( char ** )NULL, 10 );   break;
             //items = atoi(optarg);         break;
         case 'N':
-            nstride = atoi(optarg);       break;
+            o->nstride = atoi(optarg);       break;
+        case 'O':
+            parse_directives(o, optarg, com, out); break;
         case 'p':
-            pre_delay = atoi(optarg);     break;
+            o->pre_delay = atoi(optarg);     break;
         case 'r':
-            remove_only = 1;              break;
+            o->remove_only = 1;              break;
         case 'R':
-            if (optarg == NULL) {
-                random_seed = time(NULL);
-                MPI_Barrier(testComm);
-                MPI_Bcast(&random_seed, 1, MPI_INT, 0, testComm);
-                random_seed += rank;
-            } else {
-                random_seed = atoi(optarg)+rank;
-            }
+            o->random_seed = optarg == NULL ? -1 : atoi(optarg);
             break;
         case 's':
-            stride = atoi(optarg);        break;
+            o->stride = atoi(optarg);        break;
         case 'S':
-            shared_file = 1;              break;
+            o->shared_file = 1;              break;
         case 't':
-            time_unique_dir_overhead = 1; break;
+            o->time_unique_dir_overhead = 1; break;
         case 'T':
-            stat_only = 1;                break;
+            o->stat_only = 1;                break;
         case 'u':
-            unique_dir_per_task = 1;      break;
+            o->unique_dir_per_task = 1;      break;
         case 'v':
-            verbose += 1;                 break;
+            o->verbose += 1;                 break;
         case 'V':
-            verbose = atoi(optarg);       break;
+            o->verbose = atoi(optarg);       break;
         case 'w':
-            write_bytes = ( size_t )strtoul( optarg, ( char ** )NULL, 10 );   break;
+            o->write_bytes = ( size_t )strtoul( optarg, ( char ** )NULL, 10 );   break;
         case 'W':
-            stone_wall_timer_seconds = atoi( optarg );   break;
+            o->stone_wall_timer_seconds = atoi( optarg );   break;
+        case 'X':
+            o->mixed_workload = 1;           break;
         case 'y':
-            sync_file = 1;                break;
+            o->sync_file = 1;                break;
         case 'z':
-            depth = atoi(optarg);                  break;
+            o->depth = atoi(optarg);                  break;
         case 'Z':
-            print_time = TRUE;                  break;
-        }
-    }
-
-    if(stone_wall_timer_seconds > 0 && branch_factor > 1 || ! barriers){
-      fprintf(out_logfile, "Error, stone wall timer does only work with a branch factor <= 1 and with barriers\n");
-      MPI_Abort(testComm, 1);
-    }
-
-    if (!create_only && !stat_only && !read_only && !remove_only) {
-        create_only = stat_only = read_only = remove_only = 1;
-        if (( rank == 0 ) && ( verbose >= 1 )) {
-            fprintf( out_logfile, "V-1: main: Setting create/stat/read/remove_only to True\n" );
-            fflush( out_logfile );
-        }
-    }
-
-    valid_tests();
-
-    if (( rank == 0 ) && ( verbose >= 1 )) {
-        fprintf (out_logfile, "api                     : %s\n", backend_name);
-        fprintf( out_logfile, "barriers                : %s\n", ( barriers ? "True" : "False" ));
-        fprintf( out_logfile, "collective_creates      : %s\n", ( collective_creates ? "True" : "False" ));
-        fprintf( out_logfile, "create_only             : %s\n", ( create_only ? "True" : "False" ));
-        fprintf( out_logfile, "dirpath(s):\n" );
-        for ( i = 0; i < path_count; i++ ) {
-            fprintf( out_logfile, "\t%s\n", filenames[i] );
-        }
-        fprintf( out_logfile, "dirs_only               : %s\n", ( dirs_only ? "True" : "False" ));
-        fprintf( out_logfile, "read_bytes              : "LLU"\n", read_bytes );
-        fprintf( out_logfile, "read_only               : %s\n", ( read_only ? "True" : "False" ));
-        fprintf( out_logfile, "first                   : %d\n", first );
-        fprintf( out_logfile, "files_only              : %s\n", ( files_only ? "True" : "False" ));
-        fprintf( out_logfile, "iterations              : %d\n", iterations );
-        fprintf( out_logfile, "items_per_dir           : "LLU"\n", items_per_dir );
-        fprintf( out_logfile, "last                    : %d\n", last );
-        fprintf( out_logfile, "leaf_only               : %s\n", ( leaf_only ? "True" : "False" ));
-        fprintf( out_logfile, "items                   : "LLU"\n", items );
-        fprintf( out_logfile, "nstride                 : %d\n", nstride );
-        fprintf( out_logfile, "pre_delay               : %d\n", pre_delay );
-        fprintf( out_logfile, "remove_only             : %s\n", ( leaf_only ? "True" : "False" ));
-        fprintf( out_logfile, "random_seed             : %d\n", random_seed );
-        fprintf( out_logfile, "stride                  : %d\n", stride );
-        fprintf( out_logfile, "shared_file             : %s\n", ( shared_file ? "True" : "False" ));
-        fprintf( out_logfile, "time_unique_dir_overhead: %s\n", ( time_unique_dir_overhead ? "True" : "False" ));
-        fprintf( out_logfile, "stone_wall_timer_seconds: %d\n", stone_wall_timer_seconds);
-        fprintf( out_logfile, "stat_only               : %s\n", ( stat_only ? "True" : "False" ));
-        fprintf( out_logfile, "unique_dir_per_task     : %s\n", ( unique_dir_per_task ? "True" : "False" ));
-        fprintf( out_logfile, "write_bytes             : "LLU"\n", write_bytes );
-        fprintf( out_logfile, "sync_file               : %s\n", ( sync_file ? "True" : "False" ));
-        fprintf( out_logfile, "depth                   : %d\n", depth );
-        fflush( out_logfile );
+            o->print_time = TRUE;                  break;
+        }
+    }
+}
+
+/*
+ * Set up the context of a run with the options o on the processes of com,
+ * the options are copied.
+ */
+mdtest_ctx_t * mdtest_init(const mdtest_options_t * o, MPI_Comm com, FILE * out) {
+    mdtest_ctx_t *ctx = calloc(1, sizeof(*ctx));
+
+    if (ctx == NULL) {
+        fprintf(out, "mdtest: out of memory\n");
+        MPI_Abort(com, 1);
+    }
+    ctx->o = *o;
+    ctx->comm = com;
+    ctx->out = out;
+    ctx->aggregator_comm = MPI_COMM_NULL;
+
+    MPI_Comm_rank(ctx->comm, &ctx->rank);
+    MPI_Comm_size(ctx->comm, &ctx->size);
+
+    ctx->pid = getpid();
+    ctx->uid = getuid();
+
+    if (gethostname(ctx->hostname, MAX_LEN) == -1) {
+        perror("gethostname");
+        MPI_Abort(ctx->comm, 2);
+    }
+    return ctx;
+}
+
+mdtest_results_t * mdtest_run_ctx(mdtest_ctx_t * ctx) {
+    int i, j;
+    int nodeCount;
+    MPI_Group worldgroup, testgroup;
+    struct {
+        int first;
+        int last;
+        int stride;
+    } range = {0, 0, 1};
+
+    /* the backends and the utilities use the process-wide communicator, rank and log */
+    testComm = ctx->comm;
+    mpi_comm_world = ctx->comm;
+    rank = ctx->rank;
+    verbose = ctx->o.verbose;
+    out_logfile = ctx->out;
+
+    init_clock();
+
+    nodeCount = ctx->size / count_tasks_per_node(ctx);
+
+    if (ctx->rank == 0) {
+        fprintf(ctx->out, "-- started at %s --\n\n", print_timestamp(ctx));
+        fprintf(ctx->out, "mdtest-%s was launched with %d total task(s) on %d node(s)\n",
+               RELEASE_VERS, ctx->size, nodeCount);
+        fflush(ctx->out);
+    }
+
+    if (ctx->o.dirpath != NULL) {
+        ctx->dirpath = strdup(ctx->o.dirpath);
+        parse_dirpath(ctx, ctx->dirpath);
+    }
+
+    if (ctx->o.random_seed < 0) {
+        ctx->o.random_seed = time(NULL);
+        MPI_Barrier(ctx->comm);
+        MPI_Bcast(&ctx->o.random_seed, 1, MPI_INT, 0, ctx->comm);
+    }
+    if (ctx->o.random_seed > 0) {
+        ctx->o.random_seed += ctx->rank;
+    }
+
+    if(ctx->o.stone_wall_timer_seconds > 0 && (ctx->o.branch_factor > 1 || ! ctx->o.barriers)){
+      fprintf(ctx->out, "Error, stone wall timer does only work with a branch factor <= 1 and with barriers\n");
+      MPI_Abort(ctx->comm, 1);
+    }
+
+    if (!ctx->o.create_only && !ctx->o.stat_only && !ctx->o.read_only && !ctx->o.remove_only) {
+        ctx->o.create_only = ctx->o.stat_only = ctx->o.read_only = ctx->o.remove_only = 1;
+        if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+            fprintf( ctx->out, "V-1: main: Setting create/stat/read/remove_only to True\n" );
+            fflush( ctx->out );
+        }
+    }
+
+    valid_tests(ctx);
+
+    if (( ctx->rank == 0 ) && ( ctx->o.verbose >= 1 )) {
+        fprintf (ctx->out, "api                     : %s\n", ctx->o.backend_name);
+        fprintf( ctx->out, "barriers                : %s\n", ( ctx->o.barriers ? "True" : "False" ));
+        fprintf( ctx->out, "collective_creates      : %s\n", ( ctx->o.collective_creates ? "True" : "False" ));
+        fprintf( ctx->out, "collective_aggregators  : %d\n", ctx->o.collective_aggregators );
+        fprintf( ctx->out, "list_phase              : %s\n", ( ctx->o.list_phase ? ( ctx->o.list_plus ? "plus" : "True" ) : "False" ));
+        fprintf( ctx->out, "list_buffer_size        : %zu\n", ctx->o.list_buffer_size );
+        fprintf( ctx->out, "stat_mask               : 0x%x\n", ctx->o.stat_mask );
+        fprintf( ctx->out, "measure_latency         : %s\n", ( ctx->o.measure_latency ? "True" : "False" ));
+        fprintf( ctx->out, "name_scheme             : %s\n", name_scheme_names[ctx->o.name_scheme] );
+        fprintf( ctx->out, "small_file              : %s\n", ( ctx->o.small_file ? "True" : "False" ));
+        fprintf( ctx->out, "direct_io               : %s\n", ( ctx->o.direct_io ? "True" : "False" ));
+        fprintf( ctx->out, "sync_mode               : %s\n", sync_mode_names[ctx->o.sync_mode] );
+        fprintf( ctx->out, "verify                  : %s\n", ( ctx->o.verify_data ? "True" : "False" ));
+        fprintf( ctx->out, "rate_series             : %s\n", ( ctx->o.rate_series_prefix ? ctx->o.rate_series_prefix : "none" ));
+        fprintf( ctx->out, "create_only             : %s\n", ( ctx->o.create_only ? "True" : "False" ));
+        fprintf( ctx->out, "dirpath(s):\n" );
+        for ( i = 0; i < ctx->path_count; i++ ) {
+            fprintf( ctx->out, "\t%s\n", ctx->filenames[i] );
+        }
+        fprintf( ctx->out, "dirs_only               : %s\n", ( ctx->o.dirs_only ? "True" : "False" ));
+        fprintf( ctx->out, "read_bytes              : "LLU"\n", ctx->o.read_bytes );
+        fprintf( ctx->out, "read_only               : %s\n", ( ctx->o.read_only ? "True" : "False" ));
+        fprintf( ctx->out, "first                   : %d\n", ctx->o.first );
+        fprintf( ctx->out, "files_only              : %s\n", ( ctx->o.files_only ? "True" : "False" ));
+        fprintf( ctx->out, "iterations              : %d\n", ctx->o.iterations );
+        fprintf( ctx->out, "items_per_dir           : "LLU"\n", ctx->o.items_per_dir );
+        fprintf( ctx->out, "last                    : %d\n", ctx->o.last );
+        fprintf( ctx->out, "leaf_only               : %s\n", ( ctx->o.leaf_only ? "True" : "False" ));
+        fprintf( ctx->out, "items                   : "LLU"\n", ctx->o.items );
+        fprintf( ctx->out, "nstride                 : %d\n", ctx->o.nstride );
+        fprintf( ctx->out, "pre_delay               : %d\n", ctx->o.pre_delay );
+        fprintf( ctx->out, "remove_only             : %s\n", ( ctx->o.leaf_only ? "True" : "False" ));
+        fprintf( ctx->out, "random_seed             : %d\n", ctx->o.random_seed );
+        fprintf( ctx->out, "stride                  : %d\n", ctx->o.stride );
+        fprintf( ctx->out, "shared_file             : %s\n", ( ctx->o.shared_file ? "True" : "False" ));
+        fprintf( ctx->out, "time_unique_dir_overhead: %s\n", ( ctx->o.time_unique_dir_overhead ? "True" : "False" ));
+        fprintf( ctx->out, "stone_wall_timer_seconds: %d\n", ctx->o.stone_wall_timer_seconds);
+        fprintf( ctx->out, "stat_only               : %s\n", ( ctx->o.stat_only ? "True" : "False" ));
+        fprintf( ctx->out, "unique_dir_per_task     : %s\n", ( ctx->o.unique_dir_per_task ? "True" : "False" ));
+        fprintf( ctx->out, "write_bytes             : "LLU"\n", ctx->o.write_bytes );
+        fprintf( ctx->out, "sync_file               : %s\n", ( ctx->o.sync_file ? "True" : "False" ));
+        fprintf( ctx->out, "depth                   : %d\n", ctx->o.depth );
+        fprintf( ctx->out, "mixed_workload          : %s\n", ( ctx->o.mixed_workload ? "True" : "False" ));
+        if (ctx->o.mixed_workload) {
+            fprintf( ctx->out, "mixed_working_set       : "LLU"\n", ctx->o.mixed_working_set );
+            fprintf( ctx->out, "mixed_ratio             : %d:%d:%d:%d\n", ctx->o.mixed_ratio[0], ctx->o.mixed_ratio[1], ctx->o.mixed_ratio[2], ctx->o.mixed_ratio[3] );
+            fprintf( ctx->out, "mixed_rounds            : "LLU"\n", ctx->o.mixed_rounds );
+            fprintf( ctx->out, "mixed_interval          : %.2f\n", ctx->o.mixed_interval );
+        }
+        fflush( ctx->out );
     }
 
     /* setup total number of items and number of items per dir */
-    if (depth <= 0) {
-        num_dirs_in_tree = 1;
+    if (ctx->o.depth <= 0) {
+        ctx->num_dirs_in_tree = 1;
     } else {
-        if (branch_factor < 1) {
-            num_dirs_in_tree = 1;
-        } else if (branch_factor == 1) {
-            num_dirs_in_tree = depth + 1;
+        if (ctx->o.branch_factor < 1) {
+            ctx->num_dirs_in_tree = 1;
+        } else if (ctx->o.branch_factor == 1) {
+            ctx->num_dirs_in_tree = ctx->o.depth + 1;
         } else {
-            num_dirs_in_tree =
-                (1 - pow(branch_factor, depth+1)) / (1 - branch_factor);
+            ctx->num_dirs_in_tree =
+                (1 - pow(ctx->o.branch_factor, ctx->o.depth+1)) / (1 - (double) ctx->o.branch_factor);
         }
     }
-    if (items_per_dir > 0) {
-        items = items_per_dir * num_dirs_in_tree;
+    if (ctx->o.items_per_dir > 0) {
+        ctx->o.items = ctx->o.items_per_dir * ctx->num_dirs_in_tree;
     } else {
-        if (leaf_only) {
-            if (branch_factor <= 1) {
-                items_per_dir = items;
+        if (ctx->o.leaf_only) {
+            if (ctx->o.branch_factor <= 1) {
+                ctx->o.items_per_dir = ctx->o.items;
             } else {
-                items_per_dir = items / pow(branch_factor, depth);
-                items = items_per_dir * pow(branch_factor, depth);
+                ctx->o.items_per_dir = ctx->o.items / pow(ctx->o.branch_factor, ctx->o.depth);
+                ctx->o.items = ctx->o.items_per_dir * pow(ctx->o.branch_factor, ctx->o.depth);
             }
         } else {
-            items_per_dir = items / num_dirs_in_tree;
-            items = items_per_dir * num_dirs_in_tree;
+            ctx->o.items_per_dir = ctx->o.items / ctx->num_dirs_in_tree;
+            ctx->o.items = ctx->o.items_per_dir * ctx->num_dirs_in_tree;
         }
     }
 
     /* initialize rand_array */
-    if (random_seed > 0) {
-        srand(random_seed);
+    if (ctx->o.random_seed > 0) {
+        srand(ctx->o.random_seed);
 
         uint64_t stop = 0;
         uint64_t s;
 
-        if (leaf_only) {
-            stop = items_per_dir * (uint64_t) pow(branch_factor, depth);
+        if (ctx->o.leaf_only) {
+            stop = ctx->o.items_per_dir * (uint64_t) pow(ctx->o.branch_factor, ctx->o.depth);
         } else {
-            stop = items;
+            stop = ctx->o.items;
         }
-        rand_array = (uint64_t *) malloc( stop * sizeof(*rand_array));
+        ctx->rand_array = (uint64_t *) malloc( stop * sizeof(*ctx->rand_array));
 
         for (s=0; s<stop; s++) {
-            rand_array[s] = s;
+            ctx->rand_array[s] = s;
         }
 
         /* shuffle list randomly */
@@ -2415,140 +3759,139 @@ mdtest_results_t * mdtest_run(int argc, char **argv, MPI_Comm world_com, FILE *
              * element, and the kth element to the nth element.
              */
 
-            uint64_t tmp = rand_array[k];
-            rand_array[k] = rand_array[n];
-            rand_array[n] = tmp;
+            uint64_t tmp = ctx->rand_array[k];
+            ctx->rand_array[k] = ctx->rand_array[n];
+            ctx->rand_array[n] = tmp;
         }
     }
 
     /* allocate and initialize write buffer with # */
-    if (write_bytes > 0) {
-        write_buffer = (char *)malloc(write_bytes);
-        if (write_buffer == NULL) {
-            FAIL("out of memory");
-        }
-        memset(write_buffer, 0x23, write_bytes);
+    if (ctx->o.write_bytes > 0) {
+        ctx->write_buffer = alloc_io_buffer(ctx, ctx->write_io_size);
+        memset(ctx->write_buffer, 0x23, ctx->write_io_size);
     }
 
     /* setup directory path to work in */
-    if (path_count == 0) { /* special case where no directory path provided with '-d' option */
-        char * dir = getcwd(testdirpath, MAX_LEN);
-        path_count = 1;
+    if (ctx->path_count == 0) { /* special case where no directory path provided with '-d' option */
+        char * dir = getcwd(ctx->testdirpath, MAX_LEN);
+        ctx->path_count = 1;
     } else {
-        strcpy(testdirpath, filenames[rank%path_count]);
+        strcpy(ctx->testdirpath, ctx->filenames[ctx->rank%ctx->path_count]);
     }
 
-    backend = aiori_select (backend_name);
-    if (NULL == backend) {
+    ctx->backend = aiori_select (ctx->o.backend_name);
+    if (NULL == ctx->backend) {
         FAIL("Could not find suitable backend to use");
     }
 
     /*   if directory does not exist, create it */
-    if ((rank < path_count) && backend->access(testdirpath, F_OK, &param) != 0) {
-        if (backend->mkdir(testdirpath, DIRMODE, &param) != 0) {
+    if ((ctx->rank < ctx->path_count) && ctx->backend->access(ctx->testdirpath, F_OK, &ctx->param) != 0) {
+        if (ctx->backend->mkdir(ctx->testdirpath, DIRMODE, &ctx->param) != 0) {
             FAIL("Unable to create test directory path");
         }
     }
 
     /* display disk usage */
-    if (verbose >= 3 && rank == 0) {
-        fprintf(out_logfile,  "V-3: main (before display_freespace): testdirpath is \"%s\"\n", testdirpath );
-        fflush( out_logfile );
+    if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+        fprintf(ctx->out,  "V-3: main (before display_freespace): testdirpath is \"%s\"\n", ctx->testdirpath );
+        fflush( ctx->out );
     }
 
-    if (rank == 0) display_freespace(testdirpath);
+    if (ctx->rank == 0) display_freespace(ctx, ctx->testdirpath);
 
-    if (verbose >= 3 && rank == 0) {
-        fprintf(out_logfile,  "V-3: main (after display_freespace): testdirpath is \"%s\"\n", testdirpath );
-        fflush( out_logfile );
+    if (ctx->o.verbose >= 3 && ctx->rank == 0) {
+        fprintf(ctx->out,  "V-3: main (after display_freespace): testdirpath is \"%s\"\n", ctx->testdirpath );
+        fflush( ctx->out );
     }
 
-    if (rank == 0) {
-        if (random_seed > 0) {
-            fprintf(out_logfile, "random seed: %d\n", random_seed);
+    if (ctx->rank == 0) {
+        if (ctx->o.random_seed > 0) {
+            fprintf(ctx->out, "random seed: %d\n", ctx->o.random_seed);
         }
     }
 
-    if (gethostname(hostname, MAX_LEN) == -1) {
-        perror("gethostname");
-        MPI_Abort(testComm, 2);
-    }
-
-    if (last == 0) {
-        first = size;
-        last = size;
+    if (ctx->o.last == 0) {
+        ctx->o.first = ctx->size;
+        ctx->o.last = ctx->size;
     }
 
     /* setup summary table for recording results */
-    summary_table = (mdtest_results_t *) malloc(iterations * sizeof(mdtest_results_t));
-    memset(summary_table, 0, sizeof(mdtest_results_t));
-    for(int i=0; i < iterations; i++){
+    ctx->summary_table = (mdtest_results_t *) malloc(ctx->o.iterations * sizeof(mdtest_results_t));
+    memset(ctx->summary_table, 0, sizeof(mdtest_results_t));
+    for(int i=0; i < ctx->o.iterations; i++){
       for(int j=0; j < MDTEST_LAST_NUM; j++){
-        summary_table[i].rate[j] = 0.0;
-        summary_table[i].time[j] = 0.0;
+        ctx->summary_table[i].rate[j] = 0.0;
+        ctx->summary_table[i].time[j] = 0.0;
       }
     }
 
-    if (summary_table == NULL) {
+    if (ctx->summary_table == NULL) {
         FAIL("out of memory");
     }
 
-    if (unique_dir_per_task) {
-        sprintf(base_tree_name, "mdtest_tree.%d", rank);
+    if (ctx->o.unique_dir_per_task) {
+        sprintf(ctx->base_tree_name, "mdtest_tree.%d", ctx->rank);
     } else {
-        sprintf(base_tree_name, "mdtest_tree");
+        sprintf(ctx->base_tree_name, "mdtest_tree");
     }
 
     /* default use shared directory */
-    strcpy(mk_name, "mdtest.shared.");
-    strcpy(stat_name, "mdtest.shared.");
-    strcpy(read_name, "mdtest.shared.");
-    strcpy(rm_name, "mdtest.shared.");
+    strcpy(ctx->mk_name, "mdtest.shared.");
+    strcpy(ctx->stat_name, "mdtest.shared.");
+    strcpy(ctx->read_name, "mdtest.shared.");
+    strcpy(ctx->rm_name, "mdtest.shared.");
 
-    MPI_Comm_group(testComm, &worldgroup);
+    MPI_Comm_group(ctx->comm, &worldgroup);
 
     // keep track of the current status for stonewalling
     rank_progress_t progress;
     memset(& progress, 0 , sizeof(progress));
-    progress.start_time = GetTimeStamp();
-    progress.stone_wall_timer_seconds = stone_wall_timer_seconds;
-    progress.items_per_dir = items_per_dir;
+    StartDeadline(ctx->o.stone_wall_timer_seconds);
+    progress.stone_wall_timer_seconds = ctx->o.stone_wall_timer_seconds;
+    progress.items_per_dir = ctx->o.items_per_dir;
 
     /* Run the tests */
-    for (i = first; i <= last && i <= size; i += stride) {
+    for (i = ctx->o.first; i <= ctx->o.last && i <= ctx->size; i += ctx->o.stride) {
         range.last = i - 1;
         MPI_Group_range_incl(worldgroup, 1, (void *)&range, &testgroup);
-        MPI_Comm_create(testComm, testgroup, &testComm);
-        if (rank == 0) {
-            if (files_only && dirs_only) {
-                fprintf(out_logfile, "\n%d tasks, "LLU" files/directories\n", i, i * items);
-            } else if (files_only) {
-                if (!shared_file) {
-                    fprintf(out_logfile, "\n%d tasks, "LLU" files\n", i, i * items);
+        MPI_Comm_create(ctx->comm, testgroup, &ctx->comm);
+        testComm = ctx->comm;
+        if (ctx->o.collective_creates) {
+            setup_aggregators(ctx);
+        }
+        if (ctx->rank == 0) {
+            if (ctx->o.files_only && ctx->o.dirs_only) {
+                fprintf(ctx->out, "\n%d tasks, "LLU" files/directories\n", i, i * ctx->o.items);
+            } else if (ctx->o.files_only) {
+                if (!ctx->o.shared_file) {
+                    fprintf(ctx->out, "\n%d tasks, "LLU" files\n", i, i * ctx->o.items);
                 }
                 else {
-                    fprintf(out_logfile, "\n%d tasks, 1 file\n", i);
+                    fprintf(ctx->out, "\n%d tasks, 1 file\n", i);
                 }
-            } else if (dirs_only) {
-                fprintf(out_logfile, "\n%d tasks, "LLU" directories\n", i, i * items);
+            } else if (ctx->o.dirs_only) {
+                fprintf(ctx->out, "\n%d tasks, "LLU" directories\n", i, i * ctx->o.items);
             }
         }
-        if (rank == 0 && verbose >= 1) {
-            fprintf(out_logfile, "\n");
-            fprintf(out_logfile, "   Operation               Duration              Rate\n");
-            fprintf(out_logfile, "   ---------               --------              ----\n");
+        if (ctx->rank == 0 && ctx->o.verbose >= 1) {
+            fprintf(ctx->out, "\n");
+            fprintf(ctx->out, "   Operation               Duration              Rate\n");
+            fprintf(ctx->out, "   ---------               --------              ----\n");
         }
 
-        for (j = 0; j < iterations; j++) {
-            mdtest_iteration(i, j, testgroup, & summary_table[j], & progress);
+        for (j = 0; j < ctx->o.iterations; j++) {
+            mdtest_iteration(ctx, i, j, testgroup, & ctx->summary_table[j], & progress);
+            if (ctx->o.measure_latency) {
+                latency_merge(ctx, & ctx->summary_table[j]);
+            }
             if(CHECK_STONE_WALL(& progress)){
-              iterations = j + 1;
+              ctx->o.iterations = j + 1;
               break;
             }
         }
-        items = progress.items_done;
-        summarize_results(iterations);
-        if (i == 1 && stride > 1) {
+        ctx->o.items = progress.items_done;
+        summarize_results(ctx, ctx->o.iterations);
+        if (i == 1 && ctx->o.stride > 1) {
             i = 0;
         }
         if(CHECK_STONE_WALL(& progress)){
@@ -2556,18 +3899,71 @@ mdtest_results_t * mdtest_run(int argc, char **argv, MPI_Comm world_com, FILE *
         }
     }
 
-    if (rank == 0) {
+    if (ctx->o.verify_data) {
+        unsigned long long errors = 0, local_errors = ctx->verify_errors;
+
+        MPI_Reduce(& local_errors, & errors, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, ctx->comm);
+        if (ctx->rank == 0) {
+            fprintf(ctx->out, "\nData verification: %llu files with unexpected content\n", errors);
+        }
+    }
+
+    if (ctx->rank == 0) {
         if(CHECK_STONE_WALL(& progress)){
-          fprintf(out_logfile, "\n-- hit stonewall\n");
+          fprintf(ctx->out, "\n-- hit stonewall\n");
         }
-        fprintf(out_logfile, "\n-- finished at %s --\n", print_timestamp());
-        fflush(out_logfile);
+        fprintf(ctx->out, "\n-- finished at %s --\n", print_timestamp(ctx));
+        fflush(ctx->out);
+    }
+    StopDeadline();
+
+    if (ctx->o.random_seed > 0) {
+        free(ctx->rand_array);
+    }
+    if (ctx->aggregator_comm != MPI_COMM_NULL) {
+        MPI_Comm_free(& ctx->aggregator_comm);
+        free(ctx->aggregator_owners);
+        ctx->aggregator_comm = MPI_COMM_NULL;
+        ctx->aggregator_owners = NULL;
     }
+    return ctx->summary_table;
+}
+
+/* free the context of a run, the results returned by mdtest_run_ctx() are kept */
+void mdtest_free(mdtest_ctx_t * ctx) {
+    free(ctx->write_buffer);
+    free(ctx->read_buffer);
+    free(ctx->filenames);
+    free(ctx->dirpath);
+    for (int i = 0; i < MDTEST_LAST_NUM; i++) {
+        free(ctx->rate_series[i].samples);
+    }
+    free(ctx);
+}
 
-    if (random_seed > 0) {
-        free(rand_array);
+mdtest_results_t * mdtest_run(int argc, char **argv, MPI_Comm world_com, FILE * world_out) {
+    mdtest_options_t o;
+    mdtest_ctx_t *ctx;
+    mdtest_results_t *results;
+    int world_rank, i;
+
+    /* before parsing, it modifies the arguments of -O */
+    MPI_Comm_rank(world_com, &world_rank);
+    if (world_rank == 0) {
+        fprintf(world_out, "Command line used: %s", argv[0]);
+        for (i = 1; i < argc; i++) {
+            fprintf(world_out, " \"%s\"", argv[i]);
+        }
+        fprintf(world_out, "\n");
+        fflush(world_out);
     }
-    return summary_table;
+
+    mdtest_init_options(&o);
+    mdtest_parse_options(&o, argc, argv, world_com, world_out);
+    ctx = mdtest_init(&o, world_com, world_out);
+    results = mdtest_run_ctx(ctx);
+    mdtest_free(ctx);
+    return results;
 }
 
 int main(int argc, char **argv) {
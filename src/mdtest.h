@@ -12,21 +12,147 @@ typedef enum {
   MDTEST_FILE_REMOVE_NUM = 7,
   MDTEST_TREE_CREATE_NUM = 8,
   MDTEST_TREE_REMOVE_NUM = 9,
+  MDTEST_MIXED_CREATE_NUM = 10,
+  MDTEST_MIXED_STAT_NUM = 11,
+  MDTEST_MIXED_READ_NUM = 12,
+  MDTEST_MIXED_REMOVE_NUM = 13,
+  MDTEST_DIR_LIST_NUM = 14,
+  MDTEST_FILE_LIST_NUM = 15,
   MDTEST_LAST_NUM
 } mdtest_test_num_t;
 
+/* latency only: the steps of a file creation */
+#define MDTEST_FILE_CREATE_OPEN_NUM  (MDTEST_LAST_NUM + 0)
+#define MDTEST_FILE_CREATE_WRITE_NUM (MDTEST_LAST_NUM + 1)
+#define MDTEST_FILE_CREATE_CLOSE_NUM (MDTEST_LAST_NUM + 2)
+#define MDTEST_LATENCY_LAST_NUM      (MDTEST_LAST_NUM + 3)
+
+/* number of buckets of the latency histogram */
+#define MDTEST_LATENCY_BUCKETS (41 * 8)
+
+/* latency percentiles of one operation over all processes, in seconds */
+typedef struct
+{
+    uint64_t ops;
+    double p50;
+    double p99;
+    double p999;
+    double max;
+} mdtest_latency_t;
+
 typedef struct
 {
     double rate[MDTEST_LAST_NUM];
     double time[MDTEST_LAST_NUM];
     uint64_t items[MDTEST_LAST_NUM];
+    uint64_t bytes[MDTEST_LAST_NUM]; /* bytes returned by the listing phases */
 
     uint64_t stonewall_last_item[MDTEST_LAST_NUM];
     double stonewall_time[MDTEST_LAST_NUM];
     uint64_t stonewall_item_min[MDTEST_LAST_NUM];
     uint64_t stonewall_item_sum[MDTEST_LAST_NUM];
+
+    mdtest_latency_t latency[MDTEST_LATENCY_LAST_NUM]; /* only with -O latency=1 */
 } mdtest_results_t;
 
+/* how the names of files and directories are generated, see -O nameScheme */
+enum {MDTEST_NAME_SEQUENTIAL, MDTEST_NAME_HEX, MDTEST_NAME_LONG, MDTEST_NAME_PREFIX};
+
+/* what is done after writing a file, see -O syncMode */
+enum {MDTEST_SYNC_NONE, MDTEST_SYNC_FSYNC, MDTEST_SYNC_FDATASYNC, MDTEST_SYNC_DSYNC};
+
+/*
+ * The options of a run, set to the defaults by mdtest_init_options(). The
+ * command line options set the field of the same name, see print_help().
+ * Strings are not copied, they must stay valid until the run is freed.
+ */
+typedef struct
+{
+    const char *backend_name;     /* -a, the backend for all operations */
+    const char *dirpath;          /* -d, directories separated by '@', the working directory if NULL */
+    int first;                    /* -f, -l, -s: numbers of processes to run the test on */
+    int last;
+    int stride;
+    int iterations;               /* -i */
+    int verbose;                  /* -v, -V */
+
+    int barriers;
+    int create_only;
+    int stat_only;
+    int read_only;
+    int remove_only;
+    int leaf_only;
+    unsigned branch_factor;
+    int depth;
+    /*
+     * As we start moving towards Exascale, we could have billions
+     * of files in a directory. Make room for that possibility with
+     * a larger variable.
+     */
+    uint64_t items_per_dir;
+    uint64_t items;
+    int print_time;
+    int random_seed;              /* -R, 0 for no shuffling, -1 to seed from the clock */
+    int shared_file;
+    int files_only;
+    int dirs_only;
+    int pre_delay;
+    int unique_dir_per_task;
+    int time_unique_dir_overhead;
+    int throttle;
+    size_t write_bytes;
+    size_t read_bytes;
+    int stone_wall_timer_seconds;
+    int sync_file;
+    int nstride;                  /* neighbor stride */
+
+    /* the extended options of -O */
+    int collective_creates;
+    int collective_aggregators;   /* 0: one aggregator per node */
+    int list_phase;
+    int list_plus;
+    size_t list_buffer_size;
+    int stat_mask;                /* IOR_STATX_* attributes to stat, 0 for a plain stat */
+    int measure_latency;
+    int name_scheme;              /* MDTEST_NAME_* */
+    int name_length;              /* 0: default length of the scheme */
+    int small_file;               /* POSIX calls with flags preset once instead of the generic AIORI path */
+    int direct_io;
+    int sync_mode;                /* MDTEST_SYNC_* */
+    int verify_data;
+    size_t io_alignment;
+    const char *rate_series_prefix;  /* write the item rate series to files starting with this */
+    double rate_series_interval;
+
+    /* steady-state mixed metadata workload, see mixed_test() */
+    int mixed_workload;
+    uint64_t mixed_working_set;
+    int mixed_ratio[4];           /* create : stat : read : remove */
+    uint64_t mixed_rounds;
+    double mixed_interval;
+} mdtest_options_t;
+
+/* the state of a run, it is private to mdtest.c */
+typedef struct mdtest_ctx mdtest_ctx_t;
+
+void mdtest_init_options(mdtest_options_t * o);
+/* set the options given as command line arguments, argv[0] is the program name */
+void mdtest_parse_options(mdtest_options_t * o, int argc, char **argv, MPI_Comm com, FILE * out);
+
+/*
+ * Run the benchmark with the options o on the processes of com, the
+ * context keeps the state of the run until it is freed. The strings of o
+ * are not copied, they must remain valid until the run returns.
+ */
+mdtest_ctx_t * mdtest_init(const mdtest_options_t * o, MPI_Comm com, FILE * out);
+mdtest_results_t * mdtest_run_ctx(mdtest_ctx_t * ctx);
+/* the results returned by the run remain valid */
+void mdtest_free(mdtest_ctx_t * ctx);
+
+/* run the benchmark given by command line arguments */
 mdtest_results_t * mdtest_run(int argc, char **argv, MPI_Comm world_com, FILE * out_logfile);
 
+/* non-empty buckets of the latency histogram of the run, see mdtest.c */
+int mdtest_latency_histogram(mdtest_ctx_t * ctx, int num, double *limit, uint64_t *count, int max);
+
 #endif
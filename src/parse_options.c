@@ -107,7 +107,7 @@ static void RecalculateExpectedFileSize(IOR_param_t *params)
 /*
  * Check and correct all settings of each test in queue for correctness.
  */
-static void CheckRunSettings(IOR_test_t *tests)
+void CheckRunSettings(IOR_test_t *tests)
 {
         IOR_test_t *ptr;
         IOR_param_t *params;
@@ -387,10 +387,10 @@ int contains_only(char *haystack, char *needle)
 }
 
 /*
- * Read the configuration script, allocating and filling in the structure of
- * global parameters.
+ * Read the configuration script, allocating and filling in the tests, the
+ * first one is a copy of params.
  */
-IOR_test_t *ReadConfigScript(char *scriptName)
+IOR_test_t *ReadConfigScript(char *scriptName, IOR_param_t *params)
 {
         int test_num = 0;
         int runflag = 0;
@@ -400,8 +400,8 @@ IOR_test_t *ReadConfigScript(char *scriptName)
         IOR_test_t *head = NULL;
         IOR_test_t *tail = NULL;
 
-        /* Initialize the first test */
-        head = CreateTest(&initialTestParams, test_num++);
+        /* Initialize the first test with the options given so far */
+        head = CreateTest(params, test_num++);
         tail = head;
 
         /* open the script */
@@ -456,9 +456,11 @@ IOR_test_t *ReadConfigScript(char *scriptName)
 }
 
 /*
- * Parse Commandline.
+ * Set the parameters given as command line options in params, returns the
+ * tests of a script given with -f, NULL otherwise. The tests of the script
+ * start from params as set by the options before -f.
  */
-IOR_test_t *ParseCommandLine(int argc, char **argv)
+IOR_test_t *ParseOptions(int argc, char **argv, IOR_param_t *params)
 {
         char * const opts =
           "a:A:b:BcCd:D:eEf:FgG:hHi:Ij:J:kKl:mM:nN:o:O:pPqQ:rRs:St:T:uU:vVwWxX:YzZ";
@@ -466,11 +468,6 @@ IOR_test_t *ParseCommandLine(int argc, char **argv)
         IOR_test_t *tests = NULL;
         char * optarg;
 
-        init_IOR_Param_t(&initialTestParams);
-        GetPlatformName(initialTestParams.platform);
-        initialTestParams.writeFile = initialTestParams.readFile = FALSE;
-        initialTestParams.checkWrite = initialTestParams.checkRead = FALSE;
-
         option_t *optList, *thisOpt;
         optList = GetOptList(argc, argv, opts);
 
@@ -480,89 +477,89 @@ IOR_test_t *ParseCommandLine(int argc, char **argv)
                 optList = optList->next;
                 switch (thisOpt->option) {
                 case 'a':
-                        strcpy(initialTestParams.api, optarg);
+                        strcpy(params->api, optarg);
                         break;
                 case 'A':
-                        initialTestParams.referenceNumber = atoi(optarg);
+                        params->referenceNumber = atoi(optarg);
                         break;
                 case 'b':
-                        initialTestParams.blockSize = StringToBytes(optarg);
-                        RecalculateExpectedFileSize(&initialTestParams);
+                        params->blockSize = StringToBytes(optarg);
+                        RecalculateExpectedFileSize(params);
                         break;
                 case 'B':
-                        initialTestParams.useO_DIRECT = TRUE;
+                        params->useO_DIRECT = TRUE;
                         break;
                 case 'c':
-                        initialTestParams.collective = TRUE;
+                        params->collective = TRUE;
                         break;
                 case 'C':
-                        initialTestParams.reorderTasks = TRUE;
+                        params->reorderTasks = TRUE;
                         break;
                 case 'd':
-                        initialTestParams.interTestDelay = atoi(optarg);
+                        params->interTestDelay = atoi(optarg);
                         break;
                 case 'D':
-                        initialTestParams.deadlineForStonewalling =
+                        params->deadlineForStonewalling =
                             atoi(optarg);
                         break;
                 case 'e':
-                        initialTestParams.fsync = TRUE;
+                        params->fsync = TRUE;
                         break;
                 case 'E':
-                        initialTestParams.useExistingTestFile = TRUE;
+                        params->useExistingTestFile = TRUE;
                         break;
                 case 'f':
-                        tests = ReadConfigScript(optarg);
+                        tests = ReadConfigScript(optarg, params);
                         break;
                 case 'F':
-                        initialTestParams.filePerProc = TRUE;
+                        params->filePerProc = TRUE;
                         break;
                 case 'g':
-                        initialTestParams.intraTestBarriers = TRUE;
+                        params->intraTestBarriers = TRUE;
                         break;
                 case 'G':
                         /* This option toggles between Incompressible Seed and Time stamp sig based on -l,
                          * so we'll toss the value in both for now, and sort it out in initialization
                          * after all the arguments are in and we know which it keep.
                          */
-                        initialTestParams.setTimeStampSignature = atoi(optarg);
-                        initialTestParams.incompressibleSeed = atoi(optarg);
+                        params->setTimeStampSignature = atoi(optarg);
+                        params->incompressibleSeed = atoi(optarg);
                         break;
                 case 'h':
-                        initialTestParams.showHelp = TRUE;
+                        params->showHelp = TRUE;
                         break;
                 case 'H':
-                        initialTestParams.showHints = TRUE;
+                        params->showHints = TRUE;
                         break;
                 case 'i':
-                        initialTestParams.repetitions = atoi(optarg);
+                        params->repetitions = atoi(optarg);
                         break;
                 case 'I':
-                        initialTestParams.individualDataSets = TRUE;
+                        params->individualDataSets = TRUE;
                         break;
                 case 'j':
-                        initialTestParams.outlierThreshold = atoi(optarg);
+                        params->outlierThreshold = atoi(optarg);
                         break;
                 case 'J':
-                        initialTestParams.setAlignment = StringToBytes(optarg);
+                        params->setAlignment = StringToBytes(optarg);
                         break;
                 case 'k':
-                        initialTestParams.keepFile = TRUE;
+                        params->keepFile = TRUE;
                         break;
                 case 'K':
-                        initialTestParams.keepFileWithError = TRUE;
+                        params->keepFileWithError = TRUE;
                         break;
                 case 'l':
                         switch(*optarg) {
                         case 'i': /* Incompressible */
-                                initialTestParams.dataPacketType = incompressible;
+                                params->dataPacketType = incompressible;
                                 break;
                         case 't': /* timestamp */
-                                initialTestParams.dataPacketType = timestamp;
+                                params->dataPacketType = timestamp;
                                 break;
                         case 'o': /* offset packet */
-                                initialTestParams.storeFileOffset = TRUE;
-                                initialTestParams.dataPacketType = offset;
+                                params->storeFileOffset = TRUE;
+                                params->dataPacketType = offset;
                                 break;
                         default:
                                 fprintf(out_logfile,
@@ -571,96 +568,115 @@ IOR_test_t *ParseCommandLine(int argc, char **argv)
                         }
                         break;
                 case 'm':
-                        initialTestParams.multiFile = TRUE;
+                        params->multiFile = TRUE;
                         break;
                 case 'M':
-                        initialTestParams.memoryPerNode =
+                        params->memoryPerNode =
                                 NodeMemoryStringToBytes(optarg);
                         break;
                 case 'n':
-                        initialTestParams.noFill = TRUE;
+                        params->noFill = TRUE;
                         break;
                 case 'N':
-                        initialTestParams.numTasks = atoi(optarg);
-                        RecalculateExpectedFileSize(&initialTestParams);
+                        params->numTasks = atoi(optarg);
+                        RecalculateExpectedFileSize(params);
                         break;
                 case 'o':
-                        strcpy(initialTestParams.testFileName, optarg);
+                        strcpy(params->testFileName, optarg);
                         break;
                 case 'O':
-                        ParseLine(optarg, &initialTestParams);
+                        ParseLine(optarg, params);
                         break;
                 case 'p':
-                        initialTestParams.preallocate = TRUE;
+                        params->preallocate = TRUE;
                         break;
                 case 'P':
-                        initialTestParams.useSharedFilePointer = TRUE;
+                        params->useSharedFilePointer = TRUE;
                         break;
                 case 'q':
-                        initialTestParams.quitOnError = TRUE;
+                        params->quitOnError = TRUE;
                         break;
                 case 'Q':
-                        initialTestParams.taskPerNodeOffset = atoi(optarg);
+                        params->taskPerNodeOffset = atoi(optarg);
                         break;
                 case 'r':
-                        initialTestParams.readFile = TRUE;
+                        params->readFile = TRUE;
                         break;
                 case 'R':
-                        initialTestParams.checkRead = TRUE;
+                        params->checkRead = TRUE;
                         break;
                 case 's':
-                        initialTestParams.segmentCount = atoi(optarg);
-                        RecalculateExpectedFileSize(&initialTestParams);
+                        params->segmentCount = atoi(optarg);
+                        RecalculateExpectedFileSize(params);
                         break;
                 case 'S':
-                        initialTestParams.useStridedDatatype = TRUE;
+                        params->useStridedDatatype = TRUE;
                         break;
                 case 't':
-                        initialTestParams.transferSize = StringToBytes(optarg);
+                        params->transferSize = StringToBytes(optarg);
                         break;
                 case 'T':
-                        initialTestParams.maxTimeDuration = atoi(optarg);
+                        params->maxTimeDuration = atoi(optarg);
                         break;
                 case 'u':
-                        initialTestParams.uniqueDir = TRUE;
+                        params->uniqueDir = TRUE;
                         break;
                 case 'U':
-                        strcpy(initialTestParams.hintsFileName, optarg);
+                        strcpy(params->hintsFileName, optarg);
                         break;
                 case 'v':
-                        initialTestParams.verbose++;
+                        params->verbose++;
                         break;
                 case 'V':
-                        initialTestParams.useFileView = TRUE;
+                        params->useFileView = TRUE;
                         break;
                 case 'w':
-                        initialTestParams.writeFile = TRUE;
+                        params->writeFile = TRUE;
                         break;
                 case 'W':
-                        initialTestParams.checkWrite = TRUE;
+                        params->checkWrite = TRUE;
                         break;
                 case 'x':
-                        initialTestParams.singleXferAttempt = TRUE;
+                        params->singleXferAttempt = TRUE;
                         break;
                 case 'X':
-                        initialTestParams.reorderTasksRandomSeed = atoi(optarg);
+                        params->reorderTasksRandomSeed = atoi(optarg);
                         break;
                 case 'Y':
-                        initialTestParams.fsyncPerWrite = TRUE;
+                        params->fsyncPerWrite = TRUE;
                         break;
                 case 'z':
-                        initialTestParams.randomOffset = TRUE;
+                        params->randomOffset = TRUE;
                         break;
                 case 'Z':
-                        initialTestParams.reorderTasksRandom = TRUE;
+                        params->reorderTasksRandom = TRUE;
                         break;
                 default:
                         fprintf(out_logfile, "ParseCommandLine: unknown option\n");
                 }
         }
 
-        tests = CreateTest(&initialTestParams, 0);
-        AllocResults(tests);
+        return (tests);
+}
+
+/*
+ * Parse Commandline.
+ */
+IOR_test_t *ParseCommandLine(int argc, char **argv)
+{
+        IOR_test_t *tests = NULL;
+
+        init_IOR_Param_t(&initialTestParams);
+        GetPlatformName(initialTestParams.platform);
+        initialTestParams.writeFile = initialTestParams.readFile = FALSE;
+        initialTestParams.checkWrite = initialTestParams.checkRead = FALSE;
+
+        tests = ParseOptions(argc, argv, &initialTestParams);
+        /* the tests of a script given with -f replace the command line test */
+        if (tests == NULL) {
+                tests = CreateTest(&initialTestParams, 0);
+                AllocResults(tests);
+        }
 
         CheckRunSettings(tests);
 
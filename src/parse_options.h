@@ -16,5 +16,7 @@
 extern IOR_param_t initialTestParams;
 
 IOR_test_t *ParseCommandLine(int argc, char **argv);
+IOR_test_t *ParseOptions(int argc, char **argv, IOR_param_t *params);
+void CheckRunSettings(IOR_test_t *tests);
 
 #endif  /* !_PARSE_OPTIONS_H */
@@ -25,6 +25,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <time.h>
+#include <pthread.h>
 
 #ifndef _WIN32
 #  include <regex.h>
@@ -507,6 +508,163 @@ double GetTimeStamp(void)
         return (timeVal);
 }
 
+/*
+ * Stonewall deadline.  A timer thread sets deadline_flag once the deadline
+ * has passed, so the hot loops of IOR, mdtest and the io500 walkers only
+ * read a flag instead of querying the clock for every item.
+ */
+int deadline_flag = 0;
+
+static pthread_t deadline_thread;
+static pthread_mutex_t deadline_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t deadline_cond;
+static struct timespec deadline_end;
+static int deadline_running = 0;
+static int deadline_cancel = 0;
+
+static void AddTimespec(struct timespec *ts, double seconds)
+{
+        ts->tv_sec += (time_t) seconds;
+        ts->tv_nsec += (long) ((seconds - (time_t) seconds) * 1e9);
+        if (ts->tv_nsec >= 1000000000) {
+                ts->tv_sec++;
+                ts->tv_nsec -= 1000000000;
+        }
+}
+
+static void *DeadlineTimer(void *arg)
+{
+        (void) arg;
+        pthread_mutex_lock(&deadline_lock);
+        while (!deadline_cancel) {
+                if (pthread_cond_timedwait(&deadline_cond, &deadline_lock,
+                                           &deadline_end) == ETIMEDOUT) {
+                        __atomic_store_n(&deadline_flag, 1, __ATOMIC_RELAXED);
+                        break;
+                }
+        }
+        pthread_mutex_unlock(&deadline_lock);
+        return NULL;
+}
+
+/*
+ * Arm the deadline to expire after the given number of seconds, 0 disarms
+ * it.  The flag is cleared and keeps its value after StopDeadline().
+ */
+void StartDeadline(double seconds)
+{
+        pthread_condattr_t attr;
+
+        StopDeadline();
+        __atomic_store_n(&deadline_flag, 0, __ATOMIC_RELAXED);
+        if (seconds <= 0) {
+                return;
+        }
+
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&deadline_cond, &attr);
+        pthread_condattr_destroy(&attr);
+
+        clock_gettime(CLOCK_MONOTONIC, &deadline_end);
+        AddTimespec(&deadline_end, seconds);
+        deadline_cancel = 0;
+        if (pthread_create(&deadline_thread, NULL, DeadlineTimer, NULL) != 0)
+                ERR("cannot start the stonewall timer thread");
+        deadline_running = 1;
+}
+
+/*
+ * Disarm the deadline and wait for the timer thread.
+ */
+void StopDeadline(void)
+{
+        if (!deadline_running) {
+                return;
+        }
+        pthread_mutex_lock(&deadline_lock);
+        deadline_cancel = 1;
+        pthread_cond_signal(&deadline_cond);
+        pthread_mutex_unlock(&deadline_lock);
+        pthread_join(deadline_thread, NULL);
+        pthread_cond_destroy(&deadline_cond);
+        deadline_running = 0;
+}
+
+/*
+ * Interval ticker.  A timer thread counts the intervals passed since
+ * StartTicker() in ticker_count, so sampling loops compare a counter
+ * instead of querying the clock for every item.
+ */
+int ticker_count = 0;
+
+static pthread_t ticker_thread;
+static pthread_mutex_t ticker_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ticker_cond;
+static struct timespec ticker_next;
+static double ticker_interval;
+static int ticker_running = 0;
+static int ticker_cancel = 0;
+
+static void *IntervalTimer(void *arg)
+{
+        (void) arg;
+        pthread_mutex_lock(&ticker_lock);
+        while (!ticker_cancel) {
+                if (pthread_cond_timedwait(&ticker_cond, &ticker_lock,
+                                           &ticker_next) == ETIMEDOUT) {
+                        __atomic_add_fetch(&ticker_count, 1, __ATOMIC_RELAXED);
+                        AddTimespec(&ticker_next, ticker_interval);
+                }
+        }
+        pthread_mutex_unlock(&ticker_lock);
+        return NULL;
+}
+
+/*
+ * Start counting intervals of the given length, the count restarts at 0.
+ */
+void StartTicker(double interval)
+{
+        pthread_condattr_t attr;
+
+        StopTicker();
+        __atomic_store_n(&ticker_count, 0, __ATOMIC_RELAXED);
+        if (interval <= 0) {
+                return;
+        }
+
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&ticker_cond, &attr);
+        pthread_condattr_destroy(&attr);
+
+        ticker_interval = interval;
+        clock_gettime(CLOCK_MONOTONIC, &ticker_next);
+        AddTimespec(&ticker_next, interval);
+        ticker_cancel = 0;
+        if (pthread_create(&ticker_thread, NULL, IntervalTimer, NULL) != 0)
+                ERR("cannot start the interval timer thread");
+        ticker_running = 1;
+}
+
+/*
+ * Stop the ticker and wait for the timer thread, the count keeps its value.
+ */
+void StopTicker(void)
+{
+        if (!ticker_running) {
+                return;
+        }
+        pthread_mutex_lock(&ticker_lock);
+        ticker_cancel = 1;
+        pthread_cond_signal(&ticker_cond);
+        pthread_mutex_unlock(&ticker_lock);
+        pthread_join(ticker_thread, NULL);
+        pthread_cond_destroy(&ticker_cond);
+        ticker_running = 0;
+}
+
 /*
  * Determine any spread (range) between node times.
  */
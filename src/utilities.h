@@ -41,6 +41,26 @@ void ShowHints (MPI_Info *);
 void init_clock(void);
 double GetTimeStamp(void);
 
+/* stonewall deadline, checked with DeadlineReached() in the hot loops */
+extern int deadline_flag;
+void StartDeadline(double seconds);
+void StopDeadline(void);
+
+static inline int DeadlineReached(void)
+{
+        return __atomic_load_n(&deadline_flag, __ATOMIC_RELAXED);
+}
+
+/* intervals passed since StartTicker(), read with TickerCount() */
+extern int ticker_count;
+void StartTicker(double interval);
+void StopTicker(void);
+
+static inline int TickerCount(void)
+{
+        return __atomic_load_n(&ticker_count, __ATOMIC_RELAXED);
+}
+
 extern double wall_clock_deviation;
 extern double wall_clock_delta;
 #endif  /* !_UTILITIES_H */